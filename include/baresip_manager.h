@@ -8,6 +8,8 @@
 #include <re.h>
 #include <baresip.h>
 #include "config_manager.h"
+#include "video_mailbox.h"
+#include "video_timing.h"
 
 #define MAX_CALLS 8
 
@@ -43,7 +45,10 @@ int baresip_manager_hangup(void);
 int baresip_manager_send_dtmf(char key);
 int baresip_manager_transfer(const char *target);
 enum call_state baresip_manager_get_state(void);
-const char *baresip_manager_get_peer(void);
+// Copy of the current peer URI; empty when there is none
+void baresip_manager_get_peer(char *out_buf, size_t size);
+// Direction of a call passed to a listener (false once it is gone)
+bool baresip_manager_call_is_outgoing(void *call_id);
 void baresip_manager_mute(bool mute);
 bool baresip_manager_is_muted(void);
 int baresip_manager_add_account(const voip_account_t *account);
@@ -56,10 +61,36 @@ void baresip_manager_destroy(void);
 
 /**
  * Run the Baresip main loop (re_main)
- * @param ui_loop_cb Callback to run periodically (e.g. for LVGL)
- * @param interval_ms Interval in milliseconds for the callback
+ * @param ui_loop_cb Callback for the UI (e.g. LVGL); returns the ms until it
+ *                   next has something due, or UINT32_MAX to park until
+ *                   woken. It also runs when a watched fd is readable or on
+ *                   baresip_manager_wakeup().
+ * @param max_wait_ms Longest time the callback is left idle, unless parked
  */
-void baresip_manager_loop(void (*ui_loop_cb)(void), int interval_ms);
+void baresip_manager_loop(uint32_t (*ui_loop_cb)(void), int max_wait_ms);
+/**
+ * Run the UI loop callback on its own thread instead of inside re_main (call
+ * before baresip_manager_loop). LVGL is then only touched there: call,
+ * registration and message callbacks are queued to it, and the calls below
+ * that reach into baresip hold the SIP thread while they run.
+ */
+void baresip_manager_set_ui_thread(bool enable);
+// Run the UI loop callback as soon as possible (any thread)
+void baresip_manager_wakeup(void);
+// Make baresip_manager_loop return (re_main or the UI thread)
+void baresip_manager_quit(void);
+/**
+ * Run the UI loop callback whenever fd is readable. ready_h (optional) is
+ * called first on the UI thread with arg and should consume the data
+ * (otherwise the callback has to); it returns whether the callback needs to
+ * run now.
+ */
+int baresip_manager_watch_fd(int fd, bool (*ready_h)(void *arg), void *arg);
+/**
+ * Stop watching fd (before closing it). Call from the UI thread, e.g. from
+ * a ready_h, or before baresip_manager_loop.
+ */
+void baresip_manager_unwatch_fd(int fd);
 
 typedef struct {
   void *id; // opaque pointer to struct call
@@ -77,6 +108,43 @@ int baresip_manager_resume_call(void *call_id);
 #include "logger.h"
 void baresip_manager_set_video_rect(int x, int y, int w, int h);
 void baresip_manager_set_local_video_rect(int x, int y, int w, int h);
+// 0=Bilinear, 1=Nearest, 2=Off (convert at decoded size, no resampling)
+void baresip_manager_set_video_scale(int mode);
+// Ordered dithering when video is converted to RGB565
+void baresip_manager_set_video_dither(bool enable);
+// Copy remote video straight to the framebuffer where no UI covers it
+// (fbdev builds only; otherwise stays off)
+void baresip_manager_set_video_overlay(bool enable);
+// Selfview composited into the remote video.
+// corner: 0=Top right, 1=Top left, 2=Bottom left, 3=Bottom right;
+// size_pct: selfview width in percent of the remote video width;
+// mirror: flip the selfview, shown alone or composited
+void baresip_manager_set_video_pip(bool enable, int corner, int size_pct,
+                                   bool mirror);
+// Colour matrix 0=Auto (BT.709 from 720 lines), 1=BT.601, 2=BT.709
+void baresip_manager_set_video_colorspace(int matrix, bool full_range);
+// Clockwise rotation of all video in degrees (0, 90, 180, 270), on top of
+// the orientation each stream asks for
+void baresip_manager_set_video_rotation(int degrees);
+// Memory kept for reuse by video frame buffers across resizes and calls
+// (0 = free buffers right away)
+void baresip_manager_set_video_pool(int megabytes);
+// Hand the newest decoded frames to LVGL (UI thread); returns the ms until
+// the next queued frame is due (UINT32_MAX if none)
+uint32_t baresip_manager_process_video(void);
+// Frame counters of the active local/remote video streams (ENOENT if none)
+int baresip_manager_get_video_stats(bool local,
+                                    struct video_mailbox_stats *stats);
+// Latency/pacing histograms of the active local/remote stream (ENOENT if
+// none)
+int baresip_manager_get_video_timing(bool local,
+                                     struct video_timing_report *report);
+// On-screen latency/pacing figures during video calls
+void baresip_manager_set_video_stats_overlay(bool enable);
+bool baresip_manager_get_video_stats_overlay(void);
+// Step the outgoing video below the frame size setting when the CPU or the
+// UI falls behind (off: always the configured size at 30 fps)
+void baresip_manager_set_video_adapt(bool enable);
 void baresip_manager_set_log_level(log_level_t level);
 
 #endif // BARESIP_MANAGER_H
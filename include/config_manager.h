@@ -74,9 +74,26 @@ typedef struct {
 
   // Media
   int video_frame_size; // 0=1280x720 (Default)
+  int video_threads;    // Video conversion threads, 0=Auto
+  int video_scale;      // 0=Bilinear, 1=Nearest, 2=Off (decoded size)
+  bool video_dither;    // Ordered dither for 16bpp video output
+  int video_matrix;     // 0=Auto, 1=BT.601, 2=BT.709
+  bool video_full_range; // Full-range (0-255) YUV levels
+  int video_rotation;   // Clockwise degrees: 0, 90, 180 or 270
+  int video_pool_mb;    // Video buffer pool cap in MiB, 0=Off
+  bool video_stats_overlay; // Latency/pacing figures over call video
+  bool video_adapt;         // Scale outgoing video to the CPU budget
+  bool video_overlay;   // Remote video straight to the framebuffer
+  bool video_pip;       // Composite the selfview into the remote video
+  int video_pip_corner; // 0=Top right, 1=Top left, 2=Bottom left, 3=Bottom right
+  int video_pip_size;   // Selfview width, percent of the remote width
+  bool video_pip_mirror; // Mirror the selfview
   audio_codec_t preferred_codec;
   int log_level;
   bool show_favorites;
+  bool display_page_flip; // Double-buffered framebuffer (fbdev, on restart)
+  bool ui_stats_overlay;  // UI loop timing figures on screen
+  int screen_off_sec;     // Idle time before the screen blanks, 0=Never
 
   // Account
   int default_account_index;
@@ -0,0 +1,60 @@
+#ifndef VIDEO_ADAPT_H
+#define VIDEO_ADAPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * CPU-budget control of the outgoing video.
+ *
+ * The configured frame size and rate are a ceiling. Once a second the
+ * controller looks at the share of CPU time the process used and at how
+ * long work waited for the UI loop, and moves along a ladder of smaller
+ * sizes and lower rates: down after sustained overload, back up after
+ * sustained headroom, holding still for a while after each change. Every
+ * decision is logged. A video source ("adapt") wraps the configured camera
+ * source and applies the current step to each captured frame before the
+ * encoder sees it (frame skipping, downscale to YUV420P), so changes take
+ * effect in a running call without restarting the camera or the encoder.
+ */
+
+struct video_adapt_state {
+  bool enabled;
+  unsigned level;  // 0 is the ceiling
+  unsigned levels; // Steps on the ladder
+  unsigned width;  // Current target size and rate
+  unsigned height;
+  unsigned fps;
+  unsigned cpu_pct;   // Process CPU share of all cores, last window
+  uint32_t ui_p95_us; // 95th percentile UI response time, last window
+};
+
+/**
+ * Set the ceiling and turn adaptation on or off (off: always the ceiling)
+ * Restarts from the ceiling. UI thread.
+ */
+void video_adapt_configure(bool enable, unsigned width, unsigned height,
+                           unsigned fps);
+
+/**
+ * Call on every UI loop iteration while a call sends video; the ladder is
+ * re-evaluated once a second.
+ * @param now Current time (usec, video_timing_now() clock)
+ * @param active false while no video is sent; windows restart when it resumes
+ */
+void video_adapt_tick(uint64_t now, bool active);
+
+/**
+ * Feed the response time of one UI run: how long after it was wanted it
+ * started, plus how long it took (usec). Ignored while inactive.
+ */
+void video_adapt_ui_sample(uint32_t usec);
+
+void video_adapt_get_state(struct video_adapt_state *s);
+
+// Register the "adapt" video source with baresip (before calls start); the
+// camera is opened through it as "adapt" with device "<module>,<device>"
+int video_adapt_register(void);
+void video_adapt_unregister(void);
+
+#endif // VIDEO_ADAPT_H
@@ -0,0 +1,213 @@
+#ifndef VIDEO_CONVERT_H
+#define VIDEO_CONVERT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <re.h>
+#include <rem_vid.h>
+
+// Widest destination row supported by the scaler
+#define VIDEO_SCALE_MAX_W 4096
+
+// Resampling used when converting to the on-screen rectangle
+typedef enum {
+  VIDEO_SCALE_BILINEAR = 0,
+  VIDEO_SCALE_NEAREST,
+  VIDEO_SCALE_NONE // Convert at decoded resolution
+} video_scale_t;
+
+// Clockwise rotation applied while converting
+typedef enum {
+  VIDEO_ROTATE_0 = 0,
+  VIDEO_ROTATE_90,
+  VIDEO_ROTATE_180,
+  VIDEO_ROTATE_270
+} video_rotate_t;
+
+// Output pixel formats (must match LVGL's lv_color_t layout)
+typedef enum {
+  VIDEO_PIX_ARGB8888 = 0, // LV_COLOR_DEPTH 32
+  VIDEO_PIX_RGB565,       // LV_COLOR_DEPTH 16
+  VIDEO_PIX_RGB565_SWAP   // LV_COLOR_DEPTH 16 with LV_COLOR_16_SWAP
+} video_pix_t;
+
+// Conversion kernels, in order of preference (best last)
+typedef enum {
+  VIDEO_KERNEL_SCALAR = 0,
+  VIDEO_KERNEL_LUT, // Table lookups instead of multiplies
+  VIDEO_KERNEL_SSE2,
+  VIDEO_KERNEL_AVX2,
+  VIDEO_KERNEL_NEON,
+  VIDEO_KERNEL_COUNT
+} video_kernel_t;
+
+// YUV->RGB colour matrix and range
+typedef enum {
+  VIDEO_CSC_BT601_LIMITED = 0,
+  VIDEO_CSC_BT601_FULL,
+  VIDEO_CSC_BT709_LIMITED,
+  VIDEO_CSC_BT709_FULL,
+  VIDEO_CSC_COUNT
+} video_csc_t;
+
+// Coefficients and lookup tables of one video_csc_t (opaque)
+struct video_csc;
+
+/**
+ * Convert one row of YUV420P to ARGB8888
+ * @param dst   Destination row (width pixels)
+ * @param y     Luma row
+ * @param u     Chroma U row (width / 2 samples, rounded up)
+ * @param v     Chroma V row (width / 2 samples, rounded up)
+ * @param width Row width in pixels
+ * @param k     Colour matrix
+ */
+typedef void (*video_row_fn)(uint32_t *dst, const uint8_t *y,
+                             const uint8_t *u, const uint8_t *v,
+                             unsigned width, const struct video_csc *k);
+
+/**
+ * Convert one row of YUV420P to RGB565
+ * @param bayer 4-entry ordered dither row (0..15), NULL for no dithering
+ * @param swap  Byte-swap each pixel (LV_COLOR_16_SWAP)
+ */
+typedef void (*video_row565_fn)(uint16_t *dst, const uint8_t *y,
+                                const uint8_t *u, const uint8_t *v,
+                                unsigned width, const uint8_t *bayer,
+                                bool swap, const struct video_csc *k);
+
+// Detect CPU features, self-test SIMD kernels and select the fastest one
+void video_convert_init(void);
+
+video_kernel_t video_convert_get_kernel(void);
+const char *video_convert_kernel_name(video_kernel_t kernel);
+bool video_convert_kernel_supported(video_kernel_t kernel);
+// Force a kernel (returns ENOTSUP if the CPU/build cannot run it)
+int video_convert_set_kernel(video_kernel_t kernel);
+
+const char *video_csc_name(video_csc_t csc);
+
+/**
+ * Pick the colour matrix for a stream
+ * @param height     Decoded height (Auto: >= 720 lines is BT.709)
+ * @param matrix     0 = Auto, 1 = BT.601, 2 = BT.709
+ * @param full_range Full-range (0-255) instead of limited (16-235) levels
+ */
+video_csc_t video_csc_select(unsigned height, int matrix, bool full_range);
+
+size_t video_pix_bytes(video_pix_t pix);
+const char *video_pix_name(video_pix_t pix);
+// Ordered dithering for 16-bit output (default on)
+void video_convert_set_dither(bool enable);
+
+// Source formats with a direct converter: YUV420P, YUV422P, YUV444P (at
+// full chroma resolution), NV12, NV21, YUYV422, UYVY422, RGB32 and ARGB
+bool video_convert_format_supported(enum vidfmt fmt);
+
+/**
+ * Convert a frame of any supported format to a native pixel format at
+ * decoded size
+ * @param dst_stride Destination stride in bytes
+ * @return 0 on success, ENOTSUP for unsupported formats, EINVAL on bad
+ *         arguments
+ */
+int video_convert_frame(void *dst, size_t dst_stride, video_pix_t pix,
+                        video_csc_t csc, const struct vidframe *vf);
+
+/**
+ * Resample and convert a frame of any supported format in a single pass.
+ * Arguments as for video_convert_yuv420p_scale().
+ */
+int video_convert_frame_scale(void *dst, size_t dst_stride, video_pix_t pix,
+                              video_csc_t csc, unsigned dw, unsigned dh,
+                              const struct vidframe *vf, video_scale_t mode);
+
+/**
+ * Resample, rotate and mirror a frame while converting it. Upright rows are
+ * converted in small bands and written out rotated tile by tile, so the
+ * frame is never stored unrotated.
+ * @param dw       Destination width, after rotation
+ * @param dh       Destination height, after rotation
+ * @param mode     As for video_convert_frame_scale(); NONE requires the
+ *                 rotated source size
+ * @param rotate   Clockwise rotation
+ * @param mirror   Flip the result horizontally
+ * @return 0 on success, ENOTSUP for unsupported formats, EINVAL on bad
+ *         arguments, ENOMEM if the bands cannot be allocated (nothing is
+ *         written then)
+ */
+int video_convert_frame_transform(void *dst, size_t dst_stride,
+                                  video_pix_t pix, video_csc_t csc,
+                                  unsigned dw, unsigned dh,
+                                  const struct vidframe *vf,
+                                  video_scale_t mode, video_rotate_t rotate,
+                                  bool mirror);
+
+// The YUV420P entry points below use BT.601 limited range
+
+// YUV420P -> native pixel format at decoded size
+// @param dst_stride Destination stride in bytes
+int video_convert_yuv420p(void *dst, size_t dst_stride, video_pix_t pix,
+                          const struct vidframe *vf);
+
+// YUV420P -> ARGB8888 using the selected kernel (dst stride = w * 4).
+// Large frames are split into stripes across the video worker pool.
+void video_convert_yuv420p_to_argb8888(uint8_t *dst,
+                                       const struct vidframe *vf);
+
+// Convert rows [y0, y1) only, on the calling thread
+void video_convert_yuv420p_to_argb8888_rows(uint8_t *dst,
+                                            const struct vidframe *vf,
+                                            unsigned y0, unsigned y1);
+
+/**
+ * Resample and convert YUV420P to a native pixel format in a single pass
+ * @param dst        Top-left destination pixel
+ * @param dst_stride Destination stride in bytes
+ * @param pix        Destination pixel format
+ * @param dw         Destination width (max VIDEO_SCALE_MAX_W)
+ * @param dh         Destination height
+ * @param vf         Source frame (YUV420P)
+ * @param mode       Bilinear or nearest; NONE requires dw/dh == source size
+ * @return 0 on success, EINVAL on bad arguments
+ */
+int video_convert_yuv420p_scale(void *dst, size_t dst_stride, video_pix_t pix,
+                                unsigned dw, unsigned dh,
+                                const struct vidframe *vf,
+                                video_scale_t mode);
+
+/**
+ * Resample and convert YUV420P to ARGB8888 in a single pass
+ * @param dst        Top-left destination pixel
+ * @param dst_stride Destination stride in pixels
+ * @param dw         Destination width (max VIDEO_SCALE_MAX_W)
+ * @param dh         Destination height
+ * @param vf         Source frame (YUV420P)
+ * @param mode       Bilinear or nearest; NONE requires dw/dh == source size
+ * @return 0 on success, EINVAL on bad arguments
+ */
+int video_convert_yuv420p_scale_argb8888(uint32_t *dst, unsigned dst_stride,
+                                         unsigned dw, unsigned dh,
+                                         const struct vidframe *vf,
+                                         video_scale_t mode);
+
+// Largest rect with the source aspect ratio, centred inside a box
+void video_convert_fit_rect(unsigned src_w, unsigned src_h, unsigned box_w,
+                            unsigned box_h, struct vidrect *out);
+
+// Scalar per-pixel reference implementation (bit-exact baseline)
+void video_convert_yuv420p_to_argb8888_ref(uint8_t *dst,
+                                           const struct vidframe *vf);
+
+/**
+ * Compare a kernel against the scalar reference on a synthetic frame
+ * @return 0 if the output is bit-exact, EINVAL on mismatch,
+ *         ENOTSUP if the kernel is not available
+ */
+int video_convert_selftest(video_kernel_t kernel);
+
+// Time every available kernel on a synthetic frame and log ms/frame
+// (also run by video_convert_init() when VIDEO_CONVERT_BENCH is set)
+void video_convert_benchmark(unsigned w, unsigned h, unsigned frames);
+
+#endif // VIDEO_CONVERT_H
@@ -0,0 +1,72 @@
+#ifndef VIDEO_MAILBOX_H
+#define VIDEO_MAILBOX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// One being written, one on screen, the rest queued for presentation
+#define VIDEO_MAILBOX_SLOTS 5
+#define VIDEO_MAILBOX_QUEUE (VIDEO_MAILBOX_SLOTS - 2)
+
+/**
+ * Small presentation queue between one producer (decoder thread) and one
+ * consumer (UI thread). Every published frame carries the time it is due
+ * on screen; the consumer takes the newest frame that is due and drops the
+ * older ones it skipped. A frame due at 0 is due immediately, which makes
+ * the queue behave as a latest-frame-wins buffer. When the queue is full
+ * the producer reuses the oldest queued slot. Slot states change with
+ * atomics, so neither side ever blocks. The slot payloads themselves live
+ * with the caller.
+ */
+struct video_mailbox {
+  uint32_t state[VIDEO_MAILBOX_SLOTS]; // Slot states (atomic)
+  uint64_t due[VIDEO_MAILBOX_SLOTS];   // usec, set before a slot is queued
+  uint64_t seq[VIDEO_MAILBOX_SLOTS];   // Publish order of queued slots
+  uint64_t next_seq; // Producer only
+  unsigned back;     // Producer only
+  unsigned front;    // Consumer only
+
+  uint64_t produced;    // Frames published
+  uint64_t presented;   // Frames picked up by the consumer
+  uint64_t overwritten; // Frames reused by the producer, queue full
+  uint64_t late;        // Frames dropped for being late
+};
+
+struct video_mailbox_stats {
+  uint64_t produced;
+  uint64_t presented;
+  uint64_t overwritten;
+  uint64_t late;
+};
+
+void video_mailbox_init(struct video_mailbox *mb);
+
+// Slot the producer should fill next
+unsigned video_mailbox_back(const struct video_mailbox *mb);
+
+/**
+ * Queue the back slot and return the next back slot
+ * @param due Time the frame should be shown (usec, video_timing_now()
+ *            clock), 0 for as soon as possible
+ */
+unsigned video_mailbox_publish(struct video_mailbox *mb, uint64_t due);
+
+// Count a frame the producer dropped for being late instead of queueing it
+void video_mailbox_drop_late(struct video_mailbox *mb);
+
+/**
+ * Take the newest frame that is due, dropping older queued ones
+ * @param now   Current time (usec)
+ * @param front Set to the consumer's slot (unchanged when no new frame)
+ * @return true if a new frame was taken
+ */
+bool video_mailbox_acquire(struct video_mailbox *mb, uint64_t now,
+                           unsigned *front);
+
+// Time the next queued frame is due, 0 if none is queued
+uint64_t video_mailbox_next_due(const struct video_mailbox *mb);
+
+void video_mailbox_get_stats(const struct video_mailbox *mb,
+                             struct video_mailbox_stats *stats);
+
+#endif // VIDEO_MAILBOX_H
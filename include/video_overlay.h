@@ -0,0 +1,72 @@
+#ifndef VIDEO_OVERLAY_H
+#define VIDEO_OVERLAY_H
+
+#include "video_convert.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Most UI rectangles the overlay can leave to LVGL; more means fallback
+#define VIDEO_OVERLAY_MAX_HOLES 8
+
+/**
+ * Direct framebuffer video overlay.
+ *
+ * The decoder thread copies converted frames straight into the mmapped
+ * framebuffer inside a screen region, skipping the rectangles where UI is
+ * drawn on top of the video ("holes"). LVGL keeps rendering the holes and
+ * everything outside the region. The UI thread owns the region and holes;
+ * changing them waits for a copy in progress, so a hole is never written
+ * once video_overlay_set_region() has returned.
+ */
+
+struct video_overlay_stats {
+  uint64_t frames;     // Frames copied to the framebuffer
+  uint64_t bytes;      // Bytes written
+  uint64_t fallbacks;  // Times the region was dropped back to LVGL
+};
+
+// Framebuffer device of the display (set by the fbdev front end only)
+void video_overlay_set_device(const char *dev);
+
+// Screen pages the display flips between (each one gets every frame);
+// 0 or 1 writes only the page shown when the overlay was opened
+void video_overlay_set_pages(unsigned pages);
+
+/**
+ * Map the framebuffer for direct writes
+ * @param pix Pixel format of the converted frames; must match the
+ *            framebuffer
+ * @return 0 on success, ENODEV if no device was set, ENOTSUP on a format
+ *         mismatch, otherwise errno
+ */
+int video_overlay_open(video_pix_t pix);
+void video_overlay_close(void);
+bool video_overlay_is_open(void);
+
+/**
+ * Give a screen region to the overlay (UI thread)
+ * @param rect  Region in screen coordinates, NULL to hand it back to LVGL
+ * @param holes Screen rectangles inside the region that LVGL draws
+ * @param n     Number of holes (max VIDEO_OVERLAY_MAX_HOLES)
+ * @return 0 on success, EINVAL if the region is off screen or n too large
+ */
+int video_overlay_set_region(const struct vidrect *rect,
+                             const struct vidrect *holes, unsigned n);
+bool video_overlay_active(void);
+
+/**
+ * Copy a converted frame to the framebuffer (decoder thread)
+ * @param src    Frame laid out for the whole region (w x h of the region)
+ * @param stride Source stride in bytes
+ * @param w      Source width, must equal the region width
+ * @param h      Source height, must equal the region height
+ * @param damage Part of the frame that changed since the previous one
+ * @return 0 if copied, ENOENT if no region is active or its size differs
+ */
+int video_overlay_blit(const uint8_t *src, size_t stride, unsigned w,
+                       unsigned h, const struct vidrect *damage);
+
+void video_overlay_get_stats(struct video_overlay_stats *stats);
+
+#endif // VIDEO_OVERLAY_H
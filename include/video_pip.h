@@ -0,0 +1,77 @@
+#ifndef VIDEO_PIP_H
+#define VIDEO_PIP_H
+
+#include "video_convert.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Selfview compositor.
+ *
+ * While a remote stream is being displayed, the local camera is converted
+ * straight to picture-in-picture size (video_pip_update(), local decoder
+ * thread) and the remote decoder thread copies the newest selfview into
+ * each remote output buffer (video_pip_compose()). The display then shows
+ * one composited image instead of two independent ones.
+ */
+
+typedef enum {
+  VIDEO_PIP_TOP_RIGHT = 0,
+  VIDEO_PIP_TOP_LEFT,
+  VIDEO_PIP_BOTTOM_LEFT,
+  VIDEO_PIP_BOTTOM_RIGHT
+} video_pip_corner_t;
+
+struct video_pip_stats {
+  uint64_t updates;  // Selfview frames converted at PiP size
+  uint64_t composed; // Remote frames the selfview was copied into
+  uint64_t decimated; // Camera frames averaged down before converting
+};
+
+/**
+ * @param enable   Composite the selfview into the remote video
+ * @param corner   Corner of the remote picture it sits in
+ * @param size_pct Width of the selfview box, percent of the remote width
+ */
+void video_pip_configure(bool enable, video_pip_corner_t corner,
+                         unsigned size_pct);
+
+/**
+ * True while a remote stream composites the selfview, i.e. the local
+ * stream should only feed video_pip_update() and not be shown on its own
+ */
+bool video_pip_active(void);
+
+/**
+ * Convert a local camera frame to selfview size (local decoder thread)
+ * @param rotate Clockwise rotation of the camera picture
+ * @param mirror Flip it horizontally, as the standalone selfview is
+ * @return 0 on success, ENOENT if no remote stream composites, otherwise
+ *         errno from the conversion
+ */
+int video_pip_update(const struct vidframe *vf, video_pix_t pix,
+                     video_csc_t csc, video_scale_t mode,
+                     video_rotate_t rotate, bool mirror);
+
+/**
+ * Copy the newest selfview into a remote output buffer (remote decoder
+ * thread). Also marks compositing as active.
+ * @param dst    Output buffer (w x h pixels)
+ * @param stride Output stride in bytes
+ * @param rect   Set to the area written
+ * @return 0 if written, ENOENT if there is no current selfview
+ */
+int video_pip_compose(uint8_t *dst, size_t stride, video_pix_t pix,
+                      unsigned w, unsigned h, struct vidrect *rect);
+
+// Forget the selfview (local stream closed)
+void video_pip_clear(void);
+
+// Paint a rectangle of an output buffer opaque black
+void video_pip_fill_black(uint8_t *dst, size_t stride, video_pix_t pix,
+                          const struct vidrect *rect);
+
+void video_pip_get_stats(struct video_pip_stats *stats);
+
+#endif // VIDEO_PIP_H
@@ -0,0 +1,52 @@
+#ifndef VIDEO_POOL_H
+#define VIDEO_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Size-class pool for converted video frame buffers.
+ *
+ * Buffers are libre mem objects, so the display may hold extra references
+ * while a stream drops them. Requests are rounded up to a size class
+ * (quarter steps between powers of two, at most 25% slack) and released
+ * buffers are parked per class, so a stream that changes resolution, or the
+ * next call at the same resolution, reuses memory instead of going back to
+ * the heap. The memory parked is bounded by a cap; the least recently
+ * released buffers are freed first. Thread safe.
+ */
+
+struct video_pool_stats {
+  uint64_t hits;      // Requests served from parked buffers
+  uint64_t misses;    // Requests that allocated
+  uint64_t evictions; // Parked buffers freed to stay under the cap
+  size_t held;        // Bytes parked now
+  size_t cap;         // Byte cap of parked buffers
+};
+
+/**
+ * Set the most memory kept parked, freeing buffers over it
+ * @param bytes Cap in bytes, 0 disables pooling
+ */
+void video_pool_set_cap(size_t bytes);
+
+/**
+ * Get a buffer of at least `size` bytes
+ * @return mem object (release with video_pool_put()), NULL if out of memory
+ */
+void *video_pool_get(size_t size);
+
+/**
+ * Drop one reference to a pool buffer. The last reference parks it for
+ * reuse; earlier ones only dereference it.
+ * @return NULL, for `buf = video_pool_put(buf)`
+ */
+void *video_pool_put(void *buf);
+
+// Free every parked buffer
+void video_pool_flush(void);
+
+void video_pool_get_stats(struct video_pool_stats *stats);
+
+#endif // VIDEO_POOL_H
@@ -0,0 +1,51 @@
+#ifndef VIDEO_PREVIEW_H
+#define VIDEO_PREVIEW_H
+
+#include "video_convert.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Preview tap for the selfview.
+ *
+ * The camera delivers frames at capture resolution, but the selfview is
+ * drawn at thumbnail size. Before any RGB conversion, the tap averages the
+ * Y and chroma samples in 2x2 or 4x4 blocks into a small YUV420P frame,
+ * picking the largest factor that still leaves the picture at least as big
+ * as the target, and the converter only scales the remainder. Down to 1/8
+ * of the source that is less than 2:1, so it no longer skips source rows;
+ * smaller targets still take the 4x4 blocks and leave the rest to the
+ * converter. Handles YUV420P, NV12/NV21, YUYV/UYVY 4:2:2 and planar
+ * 4:2:2/4:4:4; other formats pass through. One tap per stream, used by its
+ * decoder thread.
+ */
+struct video_preview {
+  uint8_t *buf;
+  size_t size;
+  uint16_t *acc; // Vertical sums of one row
+  size_t acc_len;
+  struct vidframe frame; // Decimated frame, planes in buf
+  unsigned factor;       // Of the last frame, 1 when passed through
+  uint64_t frames;       // Frames decimated
+};
+
+/**
+ * Decimation factor (1, 2 or 4) for a frame shown in a w x h target
+ * @param swap The picture is rotated by 90/270 degrees on screen
+ */
+unsigned video_preview_factor(const struct vidsz *size, unsigned w, unsigned h,
+                              bool swap);
+
+/**
+ * Frame to convert for a w x h target: `src` itself, or a decimated copy
+ * valid until the next call
+ * @param w,h Target size on screen, 0 when unknown (no decimation)
+ */
+const struct vidframe *video_preview_tap(struct video_preview *p,
+                                         const struct vidframe *src,
+                                         unsigned w, unsigned h, bool swap);
+
+void video_preview_close(struct video_preview *p);
+
+#endif // VIDEO_PREVIEW_H
@@ -0,0 +1,54 @@
+#ifndef VIDEO_SCHED_H
+#define VIDEO_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Presentation times for one video stream.
+ *
+ * Media timestamps are mapped to the local clock through the smallest
+ * transit offset (arrival - timestamp) seen recently, i.e. the frame that
+ * got through the network fastest. A frame is due at its mapped time plus
+ * the audio playout delay, so it appears with the audio captured with it.
+ * The delay is capped by what the presentation queue can hold at the
+ * current frame rate. A frame only counts as late once it is past due by
+ * more than the network jitter (and at least a frame interval), so ordinary
+ * jitter is absorbed when the audio delay is small. Used by the decoder
+ * thread only.
+ */
+struct video_sched {
+  bool valid;
+  int64_t offset;      // Local clock - media time (usec)
+  int64_t window_min;  // Smallest offset in the current window
+  uint64_t window_start;
+  uint64_t last_ts;    // Media timestamp of the previous frame (usec)
+  uint32_t interval;   // Smoothed frame interval (usec)
+  int64_t last_transit;
+  uint32_t jitter;     // Smoothed transit variation, RFC 3550 style (usec)
+  uint64_t last_shown; // When a frame was last queued (usec)
+};
+
+void video_sched_init(struct video_sched *s);
+
+/**
+ * Presentation time of a frame that arrived now
+ * @param now   Arrival time (usec, video_timing_now() clock)
+ * @param ts    Media timestamp (usec)
+ * @param delay Audio playout delay to match (usec)
+ * @param depth Frames the presentation queue holds
+ * @return Time the frame is due on screen
+ */
+uint64_t video_sched_due(struct video_sched *s, uint64_t now, uint64_t ts,
+                         uint64_t delay, unsigned depth);
+
+/**
+ * Should a frame that arrived at `now` be dropped rather than queued?
+ * Late frames are dropped, but never for so long that the picture freezes.
+ * Queued frames must be reported with video_sched_queued().
+ */
+bool video_sched_late(const struct video_sched *s, uint64_t now,
+                      uint64_t due);
+void video_sched_queued(struct video_sched *s, uint64_t now);
+
+#endif // VIDEO_SCHED_H
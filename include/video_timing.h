@@ -0,0 +1,96 @@
+#ifndef VIDEO_TIMING_H
+#define VIDEO_TIMING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Histogram bins: 4 per power of two from 1 us, up to ~16 s
+#define VIDEO_HIST_BINS 96
+
+/**
+ * Log-spaced latency histogram in microseconds. Each histogram has a
+ * single writer thread; a reader on another thread may see the sample
+ * being added half applied, which is fine for statistics.
+ */
+struct video_hist {
+  uint32_t bins[VIDEO_HIST_BINS];
+  uint64_t count;
+  uint64_t sum; // usec
+  uint32_t max; // usec
+};
+
+struct video_hist_summary {
+  uint64_t count;
+  uint32_t mean; // usec
+  uint32_t p50;  // usec, middle of the bin (within 12.5%)
+  uint32_t p95;
+  uint32_t p99;
+  uint32_t max;
+};
+
+void video_hist_add(struct video_hist *h, uint64_t usec);
+void video_hist_summarize(const struct video_hist *h,
+                          struct video_hist_summary *out);
+// A summary figure as milliseconds with one decimal ("1.2"), into buf
+const char *video_hist_fmt_ms(char *buf, size_t size, uint32_t usec);
+
+// Frame rate over a window of about a second (single writer)
+struct video_rate {
+  uint64_t start_usec;
+  uint32_t count;
+  float fps; // Rate of the last complete window
+};
+
+void video_rate_tick(struct video_rate *r, uint64_t now_usec);
+
+/**
+ * Timing of one video stream.
+ *
+ * Decoder thread: video_timing_frame() when the decoder hands over a frame,
+ * with its media timestamp, and video_timing_converted() once it has been
+ * converted. UI thread: video_timing_presented() when the frame is given to
+ * LVGL, with the arrival time recorded for it.
+ */
+struct video_timing {
+  struct video_hist convert;  // Conversion time
+  struct video_hist delay;    // Decoder callback to present
+  struct video_hist interval; // Time between decoded frames
+  struct video_hist jitter;   // |arrival spacing - timestamp spacing|
+  struct video_rate decoded;
+  struct video_rate presented;
+
+  // Decoder thread
+  uint64_t last_arrival; // usec, 0 before the first frame
+  uint64_t last_ts;      // Media timestamp, usec
+  uint32_t jitter_avg;   // RFC 3550 style smoothed jitter, usec
+};
+
+struct video_timing_report {
+  struct video_hist_summary convert;
+  struct video_hist_summary delay;
+  struct video_hist_summary interval;
+  struct video_hist_summary jitter;
+  uint32_t jitter_avg; // usec
+  float fps_decoded;
+  float fps_presented;
+  uint64_t produced;    // From the stream's mailbox
+  uint64_t presented;
+  uint64_t overwritten; // Dropped before they were shown, queue full
+  uint64_t late;        // Dropped for missing their presentation time
+};
+
+void video_timing_init(struct video_timing *t);
+void video_timing_frame(struct video_timing *t, uint64_t now_usec,
+                        uint64_t ts_usec);
+void video_timing_converted(struct video_timing *t, uint64_t usec);
+void video_timing_presented(struct video_timing *t, uint64_t now_usec,
+                            uint64_t arrival_usec);
+// Fill everything except the mailbox counters
+void video_timing_report(const struct video_timing *t,
+                         struct video_timing_report *r);
+
+// Monotonic clock in microseconds
+uint64_t video_timing_now(void);
+
+#endif // VIDEO_TIMING_H
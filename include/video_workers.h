@@ -0,0 +1,41 @@
+#ifndef VIDEO_WORKERS_H
+#define VIDEO_WORKERS_H
+
+#include <stdbool.h>
+
+#define VIDEO_WORKERS_MAX 8
+// Frames smaller than this are converted on the calling thread
+#define VIDEO_WORKERS_DEFAULT_MIN_PIXELS (640 * 360)
+
+/**
+ * Convert rows [y0, y1) of a frame
+ * @param arg Job argument passed to video_workers_run()
+ */
+typedef void (*video_stripe_fn)(void *arg, unsigned y0, unsigned y1);
+
+/**
+ * Start the stripe worker pool
+ * @param threads Total threads taking part in a conversion, including the
+ *                caller. 0 = auto (online CPUs, capped), 1 = single thread
+ * @return 0 on success, otherwise errno (pool stays single-threaded)
+ */
+int video_workers_init(int threads);
+void video_workers_close(void);
+
+// Frames below this many pixels skip the pool
+void video_workers_set_min_pixels(unsigned pixels);
+int video_workers_get_threads(void);
+
+/**
+ * Split rows into horizontal stripes and run them in parallel. Returns
+ * once every stripe is done. Falls back to running inline if the frame is
+ * below the threshold or the pool is busy with another stream.
+ * @param fn     Stripe callback
+ * @param arg    Callback argument
+ * @param rows   Number of rows in the frame
+ * @param pixels Frame size in pixels, compared against the threshold
+ */
+void video_workers_run(video_stripe_fn fn, void *arg, unsigned rows,
+                       unsigned pixels);
+
+#endif // VIDEO_WORKERS_H
@@ -17,6 +17,7 @@
 #include "baresip_manager.h"
 #include "call_applet.h"
 #include "../ui/ui_helpers.h"
+#include "../ui/video_widget.h"
 #include "config_manager.h"
 
 // Audio codec definitions if not in config_manager.h
@@ -84,6 +85,7 @@ typedef struct {
   lv_obj_t *video_cont;
   lv_obj_t *video_remote;
   lv_obj_t *video_local;
+  lv_obj_t *video_stats_label; // Latency/pacing overlay
 
   // Call State
   bool is_muted;
@@ -1328,12 +1330,44 @@ void hold_btn_clicked(lv_event_t *e) {
   log_info("CallApplet", "Hold: %d", data->is_hold);
 }
 
+// Latency/pacing figures of the remote stream over the video
+static void update_video_stats_label(call_data_t *data) {
+  struct video_timing_report r;
+
+  if (!data->video_stats_label) return;
+
+  if (!baresip_manager_get_video_stats_overlay() || !data->is_video_call ||
+      baresip_manager_get_video_timing(false, &r) != 0) {
+    lv_obj_add_flag(data->video_stats_label, LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+
+  // Tenths of ms / fps: LVGL's printf has no floating point by default
+#define TENTHS(x) (unsigned)((x) / 10), (unsigned)((x) % 10)
+  unsigned fps_in = (unsigned)(r.fps_decoded * 10);
+  unsigned fps_out = (unsigned)(r.fps_presented * 10);
+  lv_label_set_text_fmt(data->video_stats_label,
+                        "%u.%u fps in, %u.%u shown, %lu dropped\n"
+                        "convert %u.%u/%u.%u ms (p50/p99)\n"
+                        "to screen %u.%u/%u.%u ms\n"
+                        "jitter %u.%u ms (p95 %u.%u)",
+                        TENTHS(fps_in), TENTHS(fps_out),
+                        (unsigned long)(r.overwritten + r.late),
+                        TENTHS(r.convert.p50 / 100), TENTHS(r.convert.p99 / 100),
+                        TENTHS(r.delay.p50 / 100), TENTHS(r.delay.p99 / 100),
+                        TENTHS(r.jitter_avg / 100), TENTHS(r.jitter.p95 / 100));
+#undef TENTHS
+  lv_obj_clear_flag(data->video_stats_label, LV_OBJ_FLAG_HIDDEN);
+}
+
 void update_call_duration(lv_timer_t *timer) {
   call_data_t *data = (call_data_t *)timer->user_data;
   if (!data || !data->active_call_screen ||
       lv_obj_has_flag(data->active_call_screen, LV_OBJ_FLAG_HIDDEN))
     return;
 
+  update_video_stats_label(data);
+
   // Poll active calls to detect silent
   // termination
   call_info_t calls[MAX_CALLS];
@@ -2003,6 +2037,19 @@ void check_ui_updates(lv_timer_t *t) {
       data->video_timer = NULL;
     }
 
+    if (data->video_remote) {
+      struct video_widget_stats vs;
+      video_widget_get_stats(data->video_remote, &vs);
+      if (vs.frames) {
+        log_info("CallApplet",
+                 "Video redraw: %u frames (%u full), %llu px/frame dirty, "
+                 "%llu px/frame drawn",
+                 vs.frames, vs.full,
+                 (unsigned long long)(vs.damage_px / vs.frames),
+                 (unsigned long long)(vs.blit_px / vs.frames));
+      }
+    }
+
     // Reset video geometry
     baresip_manager_set_video_rect(0, 0, 0, 0);
     baresip_manager_set_local_video_rect(0, 0, 0, 0);
@@ -2078,7 +2125,7 @@ void on_call_state_change(enum call_state state, const char *peer_uri, void *cal
   } else if (call) {
     // If not explicitly INCOMING state, check if it's an incoming call that
     // isn't established yet (e.g. Early Media or Ringing on incoming)
-    bool is_outgoing = call_is_outgoing((struct call *)call);
+    bool is_outgoing = baresip_manager_call_is_outgoing(call);
     if (!is_outgoing && state != CALL_STATE_ESTABLISHED &&
         state != CALL_STATE_TERMINATED) {
       g_call_data->pending_incoming = true;
@@ -2131,13 +2178,10 @@ int call_init(applet_t *applet) {
   data->current_state = baresip_manager_get_state();
   log_debug("CallApplet", "CallInit: Fetched State=%d", data->current_state);
 
-  const char *current_peer = baresip_manager_get_peer();
-  if (current_peer) {
-    strncpy(data->current_peer_uri, current_peer,
-            sizeof(data->current_peer_uri) - 1);
-  } else {
+  baresip_manager_get_peer(data->current_peer_uri,
+                           sizeof(data->current_peer_uri));
+  if (!data->current_peer_uri[0])
     strcpy(data->current_peer_uri, "Unknown");
-  }
 
   // Update global pointer - removed
   static int baresip_initialized = 0;
@@ -2398,7 +2442,7 @@ int call_init(applet_t *applet) {
   lv_obj_add_event_cb(data->video_cont, call_gesture_handler, LV_EVENT_PRESSED, NULL);
 
   // Remote Video (Full container)
-  data->video_remote = lv_img_create(data->video_cont);
+  data->video_remote = video_widget_create(data->video_cont);
   lv_obj_remove_style_all(data->video_remote);
   lv_obj_set_size(data->video_remote, 800, 480);
   lv_obj_set_pos(data->video_remote, 0, 0);
@@ -2411,10 +2455,8 @@ int call_init(applet_t *applet) {
 
 
   // Local Video (PiP)
-  data->video_local = lv_img_create(data->active_call_screen); // PiP on top
-  lv_obj_remove_style_all(data->video_local);
-  lv_obj_set_style_bg_color(data->video_local, lv_color_black(), 0);
-  lv_obj_set_style_bg_opa(data->video_local, LV_OPA_COVER, 0); // Opaque black background
+  data->video_local = video_widget_create(data->active_call_screen); // PiP on top
+  lv_obj_remove_style_all(data->video_local); // Black until the first frame
   lv_obj_set_size(data->video_local, 160, 120);
   lv_obj_align(data->video_local, LV_ALIGN_TOP_RIGHT, -20, 20);
   // Debug Border
@@ -2422,6 +2464,18 @@ int call_init(applet_t *applet) {
   lv_obj_set_style_border_color(data->video_local, lv_color_hex(0xFF0000), 0);
   lv_obj_move_foreground(data->video_local);
 
+  // Video stats overlay (Settings > Video Stats Overlay)
+  data->video_stats_label = lv_label_create(data->active_call_screen);
+  lv_obj_set_style_text_font(data->video_stats_label, &lv_font_montserrat_16,
+                             0);
+  lv_obj_set_style_text_color(data->video_stats_label, lv_color_white(), 0);
+  lv_obj_set_style_bg_color(data->video_stats_label, lv_color_black(), 0);
+  lv_obj_set_style_bg_opa(data->video_stats_label, LV_OPA_60, 0);
+  lv_obj_set_style_pad_all(data->video_stats_label, 6, 0);
+  lv_obj_align(data->video_stats_label, LV_ALIGN_TOP_LEFT, 10, 10);
+  lv_obj_add_flag(data->video_stats_label, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_move_foreground(data->video_stats_label);
+
   // Register Video Objects with Baresip Manager
   baresip_manager_set_video_objects(data->video_remote, data->video_local);
 
@@ -2876,12 +2930,8 @@ static void call_start(applet_t *applet) {
 
   // Sync state from Baresip Manager
   data->current_state = baresip_manager_get_state();
-  const char *peer = baresip_manager_get_peer();
-  if (peer) {
-    strncpy(data->current_peer_uri, peer, sizeof(data->current_peer_uri) - 1);
-  } else {
-    data->current_peer_uri[0] = '\0';
-  }
+  baresip_manager_get_peer(data->current_peer_uri,
+                           sizeof(data->current_peer_uri));
 
   // Refresh Account Status
   log_info("CallApplet", "Start: Refreshing %d accounts", data->account_count);
@@ -2997,12 +3047,8 @@ static void call_resume(applet_t *applet) {
 
   // Sync state from Baresip Manager
   data->current_state = baresip_manager_get_state();
-  const char *peer = baresip_manager_get_peer();
-  if (peer) {
-    strncpy(data->current_peer_uri, peer, sizeof(data->current_peer_uri) - 1);
-  } else {
-    data->current_peer_uri[0] = '\0';
-  }
+  baresip_manager_get_peer(data->current_peer_uri,
+                           sizeof(data->current_peer_uri));
 
   // Refresh Account Status on Resume
   log_info("CallApplet", "Resume: Refreshing %d accounts", data->account_count);
@@ -229,8 +229,7 @@ static void home_on_call_state(enum call_state state, const char *peer, void *ca
        if (applets[i] && strcmp(applets[i]->name, "Home") == 0) {
            home_data_t *d = (home_data_t*)applets[i]->user_data;
            if (d) {
-               // Must run on UI thread? LBGL is not thread safe?
-               // Assuming callback is from main thread (baresip_manager_loop runs in main).
+               // Listeners run on the UI thread; the manager queues them
                home_applet_update_notifications(d);
                
                // FIX: Auto-navigate to Call Applet on Incoming Call
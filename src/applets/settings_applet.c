@@ -3,12 +3,15 @@
 #include "baresip_manager.h"
 #include "config_manager.h"
 #include "logger.h"
+#include "video_workers.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <ctype.h>
 #include "../ui/ui_helpers.h"
+#include "../ui/ui_power.h"
+#include "../ui/ui_stats.h"
 
 // Settings applet data
 typedef struct {
@@ -42,6 +45,23 @@ typedef struct {
   lv_obj_t *call_dns_ta;
 
   lv_obj_t *call_video_size_dd;
+  lv_obj_t *call_video_adapt_sw;
+  lv_obj_t *call_video_threads_dd;
+  lv_obj_t *call_video_scale_dd;
+  lv_obj_t *call_video_dither_sw;
+  lv_obj_t *call_video_matrix_dd;
+  lv_obj_t *call_video_range_sw;
+  lv_obj_t *call_video_rotation_dd;
+  lv_obj_t *call_video_pool_dd;
+  lv_obj_t *call_video_stats_sw;
+  lv_obj_t *call_video_overlay_sw;
+  lv_obj_t *call_video_pip_sw;
+  lv_obj_t *call_video_pip_corner_dd;
+  lv_obj_t *call_video_pip_size_dd;
+  lv_obj_t *call_video_pip_mirror_sw;
+  lv_obj_t *call_page_flip_sw;
+  lv_obj_t *call_ui_stats_sw;
+  lv_obj_t *call_screen_off_dd;
   // Account form widgets
   lv_obj_t *form_name_ta;
   lv_obj_t *form_user_ta;
@@ -99,6 +119,9 @@ static const char *STANDARD_AUDIO_CODECS[] = {
 static const char *STANDARD_VIDEO_CODECS[] = {"H264", "VP8", "VP9", "AV1",
                                               NULL};
 
+// "Screen Off" choices in seconds, 0 = Never
+static const int k_screen_off_sec[] = {0, 30, 60, 120, 300, 600};
+
 static enum {
   SETTINGS_SCREEN_MAIN,
   SETTINGS_SCREEN_ACCOUNTS,
@@ -814,6 +837,98 @@ static void show_call_settings(settings_data_t *data) {
       content, "Video Frame Size", "1920x1080\n1280x720\n640x480\n320x240",
       data->config.video_frame_size);
 
+  // Step below the frame size when the CPU falls behind
+  data->call_video_adapt_sw = create_switch_row(
+      content, "Adaptive Video Quality", data->config.video_adapt);
+
+  // Video conversion threads (index == thread count, 0 = Auto)
+  char threads_opts[8 + VIDEO_WORKERS_MAX * 4] = "Auto";
+  for (int i = 1; i <= VIDEO_WORKERS_MAX; i++) {
+    size_t len = strlen(threads_opts);
+    snprintf(threads_opts + len, sizeof(threads_opts) - len, "\n%d", i);
+  }
+  data->call_video_threads_dd = create_dropdown_row(
+      content, "Video Threads", threads_opts,
+      data->config.video_threads >= 0 &&
+              data->config.video_threads <= VIDEO_WORKERS_MAX
+          ? data->config.video_threads
+          : 0);
+
+  data->call_video_scale_dd = create_dropdown_row(
+      content, "Video Scaling", "Bilinear\nNearest\nOff",
+      data->config.video_scale >= 0 && data->config.video_scale <= 2
+          ? data->config.video_scale
+          : 0);
+
+  data->call_video_dither_sw = create_switch_row(
+      content, "Video Dithering (16-bit)", data->config.video_dither);
+
+  data->call_video_matrix_dd = create_dropdown_row(
+      content, "Video Colour Matrix", "Auto\nBT.601\nBT.709",
+      data->config.video_matrix >= 0 && data->config.video_matrix <= 2
+          ? data->config.video_matrix
+          : 0);
+
+  data->call_video_range_sw = create_switch_row(
+      content, "Video Full Range", data->config.video_full_range);
+
+  data->call_video_rotation_dd = create_dropdown_row(
+      content, "Video Rotation", "0\n90\n180\n270",
+      (data->config.video_rotation / 90) & 3);
+
+  // Off / 8 / 16 / 32 MiB of frame buffers kept for reuse
+  data->call_video_pool_dd = create_dropdown_row(
+      content, "Video Buffer Cache", "Off\n8 MB\n16 MB\n32 MB",
+      data->config.video_pool_mb <= 0    ? 0
+      : data->config.video_pool_mb <= 8  ? 1
+      : data->config.video_pool_mb <= 16 ? 2
+                                         : 3);
+
+  data->call_video_stats_sw = create_switch_row(
+      content, "Video Stats Overlay", data->config.video_stats_overlay);
+
+  data->call_video_overlay_sw = create_switch_row(
+      content, "Video Overlay (fbdev)", data->config.video_overlay);
+
+  // Selfview composited into the remote video
+  data->call_video_pip_sw = create_switch_row(
+      content, "Selfview in Video", data->config.video_pip);
+
+  data->call_video_pip_corner_dd = create_dropdown_row(
+      content, "Selfview Corner",
+      "Top Right\nTop Left\nBottom Left\nBottom Right",
+      data->config.video_pip_corner >= 0 && data->config.video_pip_corner <= 3
+          ? data->config.video_pip_corner
+          : 0);
+
+  // Small / Medium / Large = 20 / 25 / 33 percent of the remote width
+  data->call_video_pip_size_dd = create_dropdown_row(
+      content, "Selfview Size", "Small\nMedium\nLarge",
+      data->config.video_pip_size <= 20   ? 0
+      : data->config.video_pip_size <= 25 ? 1
+                                          : 2);
+
+  data->call_video_pip_mirror_sw = create_switch_row(
+      content, "Mirror Selfview", data->config.video_pip_mirror);
+
+  // Double-buffered framebuffer; the log shows flush times of either mode
+  data->call_page_flip_sw = create_switch_row(
+      content, "Page Flipping (restart)", data->config.display_page_flip);
+
+  // Blank the screen and park the UI after this much idle time
+  int screen_off_idx = 0;
+  for (int i = 1; i < 6; i++) {
+    if (data->config.screen_off_sec >= k_screen_off_sec[i])
+      screen_off_idx = i;
+  }
+  data->call_screen_off_dd = create_dropdown_row(
+      content, "Screen Off", "Never\n30 s\n1 min\n2 min\n5 min\n10 min",
+      screen_off_idx);
+
+  // Per-stage UI loop timing in the top right corner
+  data->call_ui_stats_sw = create_switch_row(
+      content, "UI Timing Overlay", data->config.ui_stats_overlay);
+
   // Log Level
   data->call_log_level_dd = create_dropdown_row(
       content, "Log Level", "TRACE\nDEBUG\nINFO\nWARN\nERROR\nFATAL",
@@ -859,6 +974,70 @@ static void save_call_settings(settings_data_t *data) {
   data->config.video_frame_size =
       lv_dropdown_get_selected(data->call_video_size_dd);
 
+  data->config.video_adapt =
+      lv_obj_has_state(data->call_video_adapt_sw, LV_STATE_CHECKED);
+  baresip_manager_set_video_adapt(data->config.video_adapt);
+
+  data->config.video_threads =
+      lv_dropdown_get_selected(data->call_video_threads_dd);
+
+  data->config.video_scale =
+      lv_dropdown_get_selected(data->call_video_scale_dd);
+  baresip_manager_set_video_scale(data->config.video_scale);
+
+  data->config.video_dither =
+      lv_obj_has_state(data->call_video_dither_sw, LV_STATE_CHECKED);
+  baresip_manager_set_video_dither(data->config.video_dither);
+
+  data->config.video_matrix =
+      lv_dropdown_get_selected(data->call_video_matrix_dd);
+  data->config.video_full_range =
+      lv_obj_has_state(data->call_video_range_sw, LV_STATE_CHECKED);
+  baresip_manager_set_video_colorspace(data->config.video_matrix,
+                                       data->config.video_full_range);
+
+  data->config.video_rotation =
+      (int)lv_dropdown_get_selected(data->call_video_rotation_dd) * 90;
+  baresip_manager_set_video_rotation(data->config.video_rotation);
+
+  static const int pool_sizes[] = {0, 8, 16, 32};
+  data->config.video_pool_mb =
+      pool_sizes[lv_dropdown_get_selected(data->call_video_pool_dd) % 4];
+  baresip_manager_set_video_pool(data->config.video_pool_mb);
+
+  data->config.video_stats_overlay =
+      lv_obj_has_state(data->call_video_stats_sw, LV_STATE_CHECKED);
+  baresip_manager_set_video_stats_overlay(data->config.video_stats_overlay);
+
+  data->config.video_overlay =
+      lv_obj_has_state(data->call_video_overlay_sw, LV_STATE_CHECKED);
+  baresip_manager_set_video_overlay(data->config.video_overlay);
+
+  static const int pip_sizes[] = {20, 25, 33};
+  data->config.video_pip =
+      lv_obj_has_state(data->call_video_pip_sw, LV_STATE_CHECKED);
+  data->config.video_pip_corner =
+      lv_dropdown_get_selected(data->call_video_pip_corner_dd);
+  data->config.video_pip_size =
+      pip_sizes[lv_dropdown_get_selected(data->call_video_pip_size_dd) % 3];
+  data->config.video_pip_mirror =
+      lv_obj_has_state(data->call_video_pip_mirror_sw, LV_STATE_CHECKED);
+  baresip_manager_set_video_pip(
+      data->config.video_pip, data->config.video_pip_corner,
+      data->config.video_pip_size, data->config.video_pip_mirror);
+
+  // Takes effect on the next start
+  data->config.display_page_flip =
+      lv_obj_has_state(data->call_page_flip_sw, LV_STATE_CHECKED);
+
+  data->config.ui_stats_overlay =
+      lv_obj_has_state(data->call_ui_stats_sw, LV_STATE_CHECKED);
+  ui_stats_set_overlay(data->config.ui_stats_overlay);
+
+  data->config.screen_off_sec =
+      k_screen_off_sec[lv_dropdown_get_selected(data->call_screen_off_dd) % 6];
+  ui_power_set_timeout((unsigned)data->config.screen_off_sec);
+
   // Save Default Account
   if (data->default_account_dropdown) {
     int sel_idx = lv_dropdown_get_selected(data->default_account_dropdown);
@@ -3,6 +3,7 @@
 #include "config_manager.h" // Added for config_manager_init and config_load_app_settings
 #include "history_manager.h"
 #include "logger.h"
+#include "ui/ui_stats.h"
 #include "lv_drivers/sdl/sdl.h"
 #include "lvgl.h"
 #include <SDL.h>
@@ -40,11 +41,11 @@ static uint32_t last_tick = 0;
 extern volatile bool sdl_quit_qry;
 #endif
 
-static void ui_loop_cb(void) {
+static uint32_t ui_loop_cb(void) {
 #ifndef USE_FBDEV
   if (sdl_quit_qry) {
     re_cancel();
-    return;
+    return 0;
   }
 #endif
 
@@ -59,8 +60,13 @@ static void ui_loop_cb(void) {
     last_tick = current_tick;
   }
 
-  // Handle LVGL tasks
-  lv_timer_handler();
+  // Handle LVGL tasks; SDL events are polled by an LVGL timer, so its
+  // deadline covers input as well
+  ui_stats_begin();
+  uint32_t wait = lv_timer_handler();
+  ui_stats_stage(UI_STAGE_TIMERS);
+  ui_stats_end();
+  return wait;
 }
 
 // Initialize LVGL display
@@ -208,6 +214,7 @@ int main(void) {
     logger_init(LOG_LEVEL_INFO);
     baresip_manager_set_log_level(LOG_LEVEL_INFO);
   }
+  ui_stats_set_overlay(config.ui_stats_overlay);
 
   // Initialize Baresip Manager EARLY (to load modules before applets use them)
   if (baresip_manager_init() != 0) {
@@ -279,7 +286,7 @@ int main(void) {
 
   // Start Baresip main loop with UI callback
   last_tick = get_tick_ms();
-  baresip_manager_loop(ui_loop_cb, 5); // 5ms interval for UI updates
+  baresip_manager_loop(ui_loop_cb, 1000); // Runs when LVGL has work due
 
 cleanup:
   log_info("Main", "=== Shutting down ===");
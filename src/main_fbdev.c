@@ -3,9 +3,13 @@
 #include "config_manager.h"
 #include "history_manager.h"
 #include "logger.h"
+#include "ui/fb_display.h"
+#include "ui/input_hotplug.h"
+#include "ui/ui_bench.h"
+#include "ui/ui_power.h"
+#include "ui/ui_stats.h"
+#include "video_overlay.h"
 #include "lv_drivers/display/fbdev.h"
-#include "lv_drivers/indev/evdev.h"
-#include "lv_drivers/indev/evdev.h"
 #include "lvgl.h"
 #include <re.h>
 #include <stdio.h>
@@ -14,9 +18,6 @@
 #include <sys/time.h>
 #include <sys/time.h>
 #include <unistd.h>
-#include <linux/input.h>
-#include <fcntl.h>
-#include <errno.h>
 
 extern void home_applet_register(void);
 extern void settings_applet_register(void);
@@ -35,198 +36,133 @@ static uint32_t get_tick_ms(void) {
 
 static uint32_t last_tick = 0;
 
-static void ui_loop_cb(void) {
+static uint32_t ui_loop_cb(void) {
   uint32_t current_tick = get_tick_ms();
   if (last_tick == 0)
     last_tick = current_tick;
 
   uint32_t elapsed = current_tick - last_tick;
-  if (elapsed > 0) {
+  last_tick = current_tick;
+
+  // Screen off: LVGL time stands still and no timer runs until a wake
+  if (ui_power_parked())
+    return UINT32_MAX;
+
+  if (elapsed > 0)
     lv_tick_inc(elapsed);
-    last_tick = current_tick;
-  }
-  
+
+  // Latency benchmark setup steps, between its measurements
+  ui_bench_update();
+
+  ui_stats_begin();
+
   // Process Video Frames
-  baresip_manager_process_video();
-  
-  lv_timer_handler();
-}
+  uint32_t video_wait = baresip_manager_process_video();
+  ui_stats_stage(UI_STAGE_VIDEO);
 
-static int kbd_fd = -1;
-static uint32_t last_key = 0;
-static uint32_t last_key_state = LV_INDEV_STATE_REL;
+  uint32_t lv_wait = lv_timer_handler();
+  ui_stats_stage(UI_STAGE_TIMERS);
+  ui_stats_end();
 
-static void keyboard_init(void) {
-    const char * dev_name = "/dev/input/event0";
-    kbd_fd = open(dev_name, O_RDWR | O_NOCTTY | O_NDELAY);
-    if(kbd_fd == -1) {
-        log_error("Main", "unable to open keyboard interface: %s", dev_name);
-        return;
-    }
-    fcntl(kbd_fd, F_SETFL, O_ASYNC | O_NONBLOCK);
+  uint32_t power_wait = ui_power_update();
+
+  // Next run when LVGL, a queued frame or the screen timeout is due
+  uint32_t wait = video_wait < lv_wait ? video_wait : lv_wait;
+  return power_wait < wait ? power_wait : wait;
 }
 
-static bool shift_pressed = false;
+// Devices are attached and detached as they come and go here
+#define INPUT_DIR "/dev/input"
+
+// Input is decoded as soon as its fd has data, and the read timer is made
+// due so LVGL reads it in the same loop run. The read timers only keep
+// polling while something is held down and for a while after release
+// (long press, key repeat, scroll throw), then pause until a device wakes
+// them.
+#define INPUT_IDLE_MS 1000
+
+static lv_indev_t *pointer_indev = NULL;
+static lv_indev_t *kbd_indev = NULL;
+static bool input_followed = false;
+static uint32_t pointer_active = 0;
+static uint32_t kbd_active = 0;
+
+static void input_poll(lv_indev_t *indev) {
+  if (!indev || !indev->driver->read_timer) return;
+  lv_timer_resume(indev->driver->read_timer);
+  lv_timer_ready(indev->driver->read_timer);
+}
 
-// Helper to map keycode to ASCII
-static char evdev_key_to_ascii(uint16_t code, bool shift) {
-    if (code >= KEY_1 && code <= KEY_9) {
-        char base = '1' + (code - KEY_1);
-        char shifted[] = {'!', '@', '#', '$', '%', '^', '&', '*', '('};
-        return shift ? shifted[code - KEY_1] : base;
-    }
-    if (code == KEY_0) return shift ? ')' : '0';
+// New samples, or a device was plugged in or out; the UI loop runs right
+// after
+static bool input_ready(enum evdev_input_type type) {
+  // The touch or key that wakes the screen does nothing else: the touch
+  // does not press what is under it, the key press is dropped before LVGL
+  // reads it (its release then finds nothing pressed)
+  if (ui_power_wake()) {
+    if (pointer_indev) lv_indev_wait_release(pointer_indev);
+    if (type == EVDEV_INPUT_KEYPAD) input_hotplug_flush(EVDEV_INPUT_KEYPAD);
+  }
 
-    // Alphabet Mapping - Explicit Switch Case
-    // Linux Input Event Codes are NOT alphabetical.
-    if (code >= KEY_Q && code <= KEY_M) { // Broad range check optimization optional, but switch is safest
-         // Proceed to switch
-    }
+  input_poll(type == EVDEV_INPUT_POINTER ? pointer_indev : kbd_indev);
+  return true;
+}
 
-    char ch = 0;
-    switch(code) {
-        case KEY_A: ch = 'a'; break;
-        case KEY_B: ch = 'b'; break;
-        case KEY_C: ch = 'c'; break;
-        case KEY_D: ch = 'd'; break;
-        case KEY_E: ch = 'e'; break;
-        case KEY_F: ch = 'f'; break;
-        case KEY_G: ch = 'g'; break;
-        case KEY_H: ch = 'h'; break;
-        case KEY_I: ch = 'i'; break;
-        case KEY_J: ch = 'j'; break;
-        case KEY_K: ch = 'k'; break;
-        case KEY_L: ch = 'l'; break;
-        case KEY_M: ch = 'm'; break;
-        case KEY_N: ch = 'n'; break;
-        case KEY_O: ch = 'o'; break;
-        case KEY_P: ch = 'p'; break;
-        case KEY_Q: ch = 'q'; break;
-        case KEY_R: ch = 'r'; break;
-        case KEY_S: ch = 's'; break;
-        case KEY_T: ch = 't'; break;
-        case KEY_U: ch = 'u'; break;
-        case KEY_V: ch = 'v'; break;
-        case KEY_W: ch = 'w'; break;
-        case KEY_X: ch = 'x'; break;
-        case KEY_Y: ch = 'y'; break;
-        case KEY_Z: ch = 'z'; break;
-        
-        case KEY_GRAVE:      ch = shift ? '~' : '`'; break;
-        case KEY_MINUS:      ch = shift ? '_' : '-'; break;
-        case KEY_EQUAL:      ch = shift ? '+' : '='; break;
-        case KEY_LEFTBRACE:  ch = shift ? '{' : '['; break;
-        case KEY_RIGHTBRACE: ch = shift ? '}' : ']'; break;
-        case KEY_BACKSLASH:  ch = shift ? '|' : '\\'; break;
-        case KEY_SEMICOLON:  ch = shift ? ':' : ';'; break;
-        case KEY_APOSTROPHE: ch = shift ? '"' : '\''; break;
-        case KEY_COMMA:      ch = shift ? '<' : ','; break;
-        case KEY_DOT:        ch = shift ? '>' : '.'; break;
-        case KEY_SLASH:      ch = shift ? '?' : '/'; break;
-        case KEY_SPACE:      ch = ' '; break;
-        case KEY_KPASTERISK: ch = '*'; break;
-        case KEY_KPDOT:      ch = '.'; break;
-        case KEY_KPMINUS:    ch = '-'; break;
-        case KEY_KPPLUS:     ch = '+'; break;
-        case KEY_KPEQUAL:    ch = '='; break;
-        default: return 0;
-    }
-    
-    // Handle shift for letters
-    if (ch >= 'a' && ch <= 'z' && shift) {
-        return ch - 32;
-    }
-    
-    // For non-letters already handled by switch
-    return ch;
+static void input_idle_check(lv_indev_drv_t *drv, lv_indev_state_t state,
+                             uint32_t *active) {
+  if (state == LV_INDEV_STATE_PR) {
+    *active = lv_tick_get();
+    return;
+  }
+  if (drv->read_timer && lv_tick_elaps(*active) >= INPUT_IDLE_MS)
+    lv_timer_pause(drv->read_timer);
+}
+
+static void pointer_read(lv_indev_drv_t *drv, lv_indev_data_t *data) {
+  input_hotplug_read(EVDEV_INPUT_POINTER, drv, data);
+  input_idle_check(drv, data->state, &pointer_active);
 }
 
 static void keyboard_read(lv_indev_drv_t * drv, lv_indev_data_t * data) {
-    (void)drv;
-    if (kbd_fd == -1) return;
-
-    struct input_event in;
-    while(read(kbd_fd, &in, sizeof(struct input_event)) > 0) {
-        if(in.type == EV_KEY) {
-            // Track Shift State
-            if (in.code == KEY_LEFTSHIFT || in.code == KEY_RIGHTSHIFT) {
-                shift_pressed = (in.value != 0);
-            }
-            
-            uint32_t key = 0;
-            // Handle Control Keys
-            switch(in.code) {
-                case KEY_BACKSPACE: key = LV_KEY_BACKSPACE; break;
-                case KEY_ENTER:     key = LV_KEY_ENTER; break;
-                case KEY_UP:        key = LV_KEY_UP; break;
-                case KEY_DOWN:      key = LV_KEY_DOWN; break;
-                case KEY_LEFT:      key = LV_KEY_LEFT; break;
-                case KEY_RIGHT:     key = LV_KEY_RIGHT; break;
-                case KEY_TAB:       
-                    key = shift_pressed ? LV_KEY_PREV : LV_KEY_NEXT; 
-                    break;
-                case KEY_ESC:       key = LV_KEY_ESC; break; // Useful for cancelling
-                case KEY_DELETE:    key = LV_KEY_DEL; break;
-                default: 
-                    // ASCII Mapping
-                    key = (uint32_t)evdev_key_to_ascii(in.code, shift_pressed);
-                    break;
-            }
-            
-            if(key != 0) {
-                 last_key = key;
-                 if (in.value) { // Log on press only
-                    printf("KBD: Code=%d Shift=%d Char='%c' (%d)\n", in.code, shift_pressed, (char)key, key);
-                 }
-            }
-            // Update state
-            last_key_state = (in.value) ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
-        }
-    }
-    
-    data->key = last_key;
-    data->state = last_key_state;
+  input_hotplug_read(EVDEV_INPUT_KEYPAD, drv, data);
+  input_idle_check(drv, data->state, &kbd_active);
 }
 
-static int init_display(void) {
+static int init_display(bool page_flip, bool headless) {
   lv_init();
 
-  // Initialize Framebuffer
-  // system("fbset"); // DEBUG: Print actual resolution
-  fbdev_init();
-
-  // Initialize Input (Event Device)
-  evdev_init();
-
-  // Create display buffer
-  // Use 800x600 as verified by fbset
+  // Use 800x600 as verified by fbset (partial buffers; page flipping
+  // takes the framebuffer's own size)
   #define DISPLAY_WIDTH 800
   #define DISPLAY_HEIGHT 600
-  
-  static lv_disp_draw_buf_t disp_buf;
-  static lv_color_t buf1[DISPLAY_WIDTH * 100];
-  static lv_color_t buf2[DISPLAY_WIDTH * 100];
-  lv_disp_draw_buf_init(&disp_buf, buf1, buf2, DISPLAY_WIDTH * 100);
 
   static lv_disp_drv_t disp_drv;
   lv_disp_drv_init(&disp_drv);
-  disp_drv.draw_buf = &disp_buf;
-  disp_drv.flush_cb = fbdev_flush;
-  disp_drv.hor_res = DISPLAY_WIDTH;
-  disp_drv.ver_res = DISPLAY_HEIGHT;
-  
+  if (fb_display_init(&disp_drv, FBDEV_PATH, page_flip, DISPLAY_WIDTH,
+                      DISPLAY_HEIGHT, headless) != 0) {
+    log_error("Main", "Failed to initialize framebuffer");
+    return -1;
+  }
+  // Lets the video overlay write to the same framebuffer
+  video_overlay_set_device(FBDEV_PATH);
+  video_overlay_set_pages(fb_display_pages());
+
+  // Attach the input devices present and follow the rest
+  input_followed = input_hotplug_init(INPUT_DIR, input_ready) == 0;
+
   lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
   if (!disp) {
     log_error("Main", "Failed to register display driver");
     return -1;
   }
 
-  // Initialize Mouse/Touch (first event device configured in lv_drv_conf.h - event1)
+  // Initialize Mouse/Touch (every pointer device feeds this indev)
   static lv_indev_drv_t indev_drv;
   lv_indev_drv_init(&indev_drv);
   indev_drv.type = LV_INDEV_TYPE_POINTER;
-  indev_drv.read_cb = evdev_read;
+  indev_drv.read_cb = pointer_read;
   lv_indev_t *mouse_indev = lv_indev_drv_register(&indev_drv);
+  pointer_indev = mouse_indev;
 
   // Create a cursor object on the system layer so it's always on top
   // Create a cursor object
@@ -242,13 +178,12 @@ static int init_display(void) {
 
   lv_indev_set_cursor(mouse_indev, cursor_obj);
 
-  // Initialize Keyboard (manually handling event0)
-  keyboard_init();
+  // Initialize Keyboard (every keypad device feeds this indev)
   static lv_indev_drv_t kbd_drv;
   lv_indev_drv_init(&kbd_drv);
   kbd_drv.type = LV_INDEV_TYPE_KEYPAD;
   kbd_drv.read_cb = keyboard_read;
-  lv_indev_t * kbd_indev = lv_indev_drv_register(&kbd_drv);
+  kbd_indev = lv_indev_drv_register(&kbd_drv);
 
   // Create a default group for keyboard focus
   lv_group_t * g = lv_group_create();
@@ -274,12 +209,6 @@ int main(void) {
 
   // printf("Main: === LVGL Applet Manager with FBDEV (KBD Fix v1) ===\n");
 
-  if (init_display() != 0) {
-    log_error("Main", "Failed to initialize display");
-    return 1;
-  }
-  printf("Main: Step 2 - init_display success\n");
-
   config_manager_init();
 
   app_config_t config;
@@ -291,7 +220,18 @@ int main(void) {
     logger_init(LOG_LEVEL_INFO);
     baresip_manager_set_log_level(LOG_LEVEL_INFO);
   }
-  printf("Main: Step 3 - Config and Logger initialized\n");
+  printf("Main: Step 2 - Config and Logger initialized\n");
+
+  // UI_LATENCY_BENCH=<iterations>: measure touch-to-photon latency with
+  // synthetic input, log it and exit. It may run without a framebuffer.
+  const char *bench = getenv("UI_LATENCY_BENCH");
+
+  if (init_display(config.display_page_flip, bench != NULL) != 0) {
+    log_error("Main", "Failed to initialize display");
+    return 1;
+  }
+  printf("Main: Step 3 - init_display success\n");
+  ui_stats_set_overlay(config.ui_stats_overlay);
 
   if (baresip_manager_init() != 0) {
     printf("Main: Baresip Manager Init FAILED via printf\n");
@@ -354,12 +294,32 @@ int main(void) {
   fflush(stdout);
 
   last_tick = get_tick_ms();
+  // Only input that wakes the loop can turn the screen back on: a device
+  // attached now, or one plugged in later
+  ui_power_init(fb_display_blank);
+  bool wakeable = input_followed ||
+                  input_hotplug_count(EVDEV_INPUT_POINTER) ||
+                  input_hotplug_count(EVDEV_INPUT_KEYPAD);
+  ui_power_set_timeout(wakeable ? config.screen_off_sec : 0);
+
+  if (bench) {
+    int iterations = atoi(bench);
+    ui_power_set_timeout(0);
+    err = ui_bench_start(iterations > 0 ? (unsigned)iterations
+                                        : UI_BENCH_ITERATIONS);
+    if (err) log_error("Main", "Latency benchmark failed to start: %d", err);
+  }
+
+  // Rendering runs beside SIP, so neither holds the other up
+  baresip_manager_set_ui_thread(true);
+
   printf("Main: Entering Baresip Manager Loop...\n");
   fflush(stdout);
-  baresip_manager_loop(ui_loop_cb, 5);
+  baresip_manager_loop(ui_loop_cb, 1000);
 
 cleanup:
   log_info("Main", "=== Shutting down ===");
+  input_hotplug_close();
   applet_manager_destroy();
   log_info("Main", "Applet Manager exited successfully!");
   return 0;
@@ -3,7 +3,8 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <rem_vid.h>
+// rem_vid.h has no include guard; video_convert.h brings it in before baresip.h
+#include "video_convert.h"
 
 
 
@@ -17,6 +18,15 @@
 #include "database_manager.h"
 #include "applet_manager.h"
 #include "logger.h"
+#include "video_workers.h"
+#include "video_mailbox.h"
+#include "video_overlay.h"
+#include "video_pip.h"
+#include "video_pool.h"
+#include "video_sched.h"
+#include "video_adapt.h"
+#include "video_preview.h"
+#include "../ui/video_widget.h"
 // Includes cleaned
 
 struct message *uag_message(void);
@@ -33,6 +43,12 @@ struct ua *uag_current(void);
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <pthread.h>
+#include <poll.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/fb.h>
 // Helper to check if string is empty
 // str_isset is provided by re_fmt.h from re.h
 
@@ -110,6 +126,212 @@ void baresip_manager_add_listener(call_event_cb cb) {
     }
 }
 
+// ============================================================================
+// UI/SIP thread boundary
+//
+// With a UI thread (baresip_manager_set_ui_thread) LVGL runs there and
+// baresip stays on the re_main (SIP) thread:
+// - SIP -> UI: call, registration and message callbacks, and other work on
+//   LVGL objects, are queued as events and run by the UI loop
+// - UI -> SIP: entry points that touch baresip objects hold the SIP thread
+//   at its poll point for the duration of the call (SIP_THREAD)
+// Without a UI thread both sides share re_main; events are still queued,
+// so callbacks run at the same point either way.
+// ============================================================================
+static bool g_ui_threaded = false;
+static int g_ui_thread_running;      // UI thread started, not joined (atomic)
+static pthread_t g_sip_thread;
+static __thread unsigned g_sip_depth;
+
+static bool sip_enter(void) {
+    if (!__atomic_load_n(&g_ui_thread_running, __ATOMIC_ACQUIRE) ||
+        pthread_equal(pthread_self(), g_sip_thread))
+        return false;
+
+    if (g_sip_depth++ == 0) re_thread_enter();
+    return true;
+}
+
+static void sip_leave(bool *entered) {
+    if (*entered && --g_sip_depth == 0) re_thread_leave();
+}
+
+// Runs the rest of the enclosing block with the SIP thread held, when
+// called from another thread
+#define SIP_THREAD()                                                           \
+    __attribute__((cleanup(sip_leave))) bool sip_entered_ = sip_enter();      \
+    (void)sip_entered_
+
+enum ui_event_type {
+    UI_EVENT_CALL,        // Listeners
+    UI_EVENT_CALL_COMPAT, // Deprecated single callback
+    UI_EVENT_REG,
+    UI_EVENT_MESSAGE,
+    UI_EVENT_FUNC,
+    UI_EVENT_HISTORY, // history_add(); the call log is read by the UI only
+};
+
+struct ui_event {
+    struct le le;
+    enum ui_event_type type;
+    enum call_state state;
+    reg_status_t reg;
+    struct call *call;
+    char *peer; // Peer URI or AOR
+    char *text;
+    void (*func)(void);
+    call_type_t history;
+};
+
+static struct list g_ui_events = LIST_INIT;
+static pthread_mutex_t g_ui_event_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void ui_event_destructor(void *arg) {
+    struct ui_event *e = arg;
+    mem_deref(e->peer);
+    mem_deref(e->text);
+}
+
+static struct ui_event *ui_event_alloc(enum ui_event_type type,
+                                       const char *peer, const char *text) {
+    struct ui_event *e = mem_zalloc(sizeof(*e), ui_event_destructor);
+    if (!e) return NULL;
+
+    e->type = type;
+    if ((peer && str_dup(&e->peer, peer)) || (text && str_dup(&e->text, text))) {
+        log_warn("BaresipManager", "UI event %d dropped (no memory)", type);
+        return mem_deref(e);
+    }
+    return e;
+}
+
+static void ui_queue(struct ui_event *e) {
+    pthread_mutex_lock(&g_ui_event_mutex);
+    list_append(&g_ui_events, &e->le, e);
+    pthread_mutex_unlock(&g_ui_event_mutex);
+
+    baresip_manager_wakeup();
+}
+
+static void ui_post(enum ui_event_type type, enum call_state state,
+                    reg_status_t reg, struct call *call, const char *peer,
+                    const char *text, void (*func)(void)) {
+    struct ui_event *e = ui_event_alloc(type, peer, text);
+    if (!e) return;
+
+    e->state = state;
+    e->reg = reg;
+    e->call = call;
+    e->func = func;
+    ui_queue(e);
+}
+
+static void notify_listeners(enum call_state state, const char *peer,
+                             struct call *call) {
+    ui_post(UI_EVENT_CALL, state, REG_STATUS_NONE, call, peer, NULL, NULL);
+}
+
+static void notify_callback(enum call_state state, const char *peer,
+                            struct call *call) {
+    ui_post(UI_EVENT_CALL_COMPAT, state, REG_STATUS_NONE, call, peer, NULL,
+            NULL);
+}
+
+static void notify_reg(const char *aor, reg_status_t status) {
+    ui_post(UI_EVENT_REG, CALL_STATE_UNKNOWN, status, NULL, aor, NULL, NULL);
+}
+
+static void notify_message(const char *peer, const char *text) {
+    ui_post(UI_EVENT_MESSAGE, CALL_STATE_UNKNOWN, REG_STATUS_NONE, NULL, peer,
+            text, NULL);
+}
+
+// Run func on the UI thread
+static void ui_run_later(void (*func)(void)) {
+    ui_post(UI_EVENT_FUNC, CALL_STATE_UNKNOWN, REG_STATUS_NONE, NULL, NULL,
+            NULL, func);
+}
+
+// Log a finished call. The call log is only touched on the UI thread while
+// there is one; before it starts and after it is joined this is that thread.
+static void history_post(const char *number, call_type_t type,
+                         const char *acc_aor) {
+    if (!__atomic_load_n(&g_ui_thread_running, __ATOMIC_ACQUIRE)) {
+        if (history_add(number, number, type, acc_aor) != 0)
+            log_error("BaresipManager", "HistoryAdd FAILED");
+        return;
+    }
+
+    struct ui_event *e = ui_event_alloc(UI_EVENT_HISTORY, number, acc_aor);
+    if (!e) return;
+
+    e->history = type;
+    ui_queue(e);
+}
+
+static bool call_exists(const struct call *call);
+
+// UI thread: run the queued events in order
+static void ui_dispatch_events(void) {
+    for (;;) {
+        pthread_mutex_lock(&g_ui_event_mutex);
+        struct le *le = list_head(&g_ui_events);
+        if (le) list_unlink(le);
+        pthread_mutex_unlock(&g_ui_event_mutex);
+        if (!le) break;
+
+        struct ui_event *e = le->data;
+        const char *peer = e->peer;
+        void *call = NULL;
+
+        // The call may be gone by now; callbacks get NULL then
+        if (e->call) {
+            SIP_THREAD();
+            if (call_exists(e->call)) call = e->call;
+        }
+
+        switch (e->type) {
+        case UI_EVENT_CALL:
+            for (int i = 0; i < g_listener_mgr.count; i++) {
+                if (g_listener_mgr.listeners[i])
+                    g_listener_mgr.listeners[i](e->state, peer, call);
+            }
+            break;
+        case UI_EVENT_CALL_COMPAT:
+            if (g_call_state.callback) g_call_state.callback(e->state, peer, call);
+            break;
+        case UI_EVENT_REG:
+            if (g_call_state.reg_callback)
+                g_call_state.reg_callback(peer ? peer : "", e->reg);
+            break;
+        case UI_EVENT_MESSAGE:
+            if (g_message_callback)
+                g_message_callback(peer ? peer : "", e->text ? e->text : "");
+            break;
+        case UI_EVENT_FUNC:
+            if (e->func) e->func();
+            break;
+        case UI_EVENT_HISTORY:
+            if (history_add(peer, peer, e->history, e->text) != 0)
+                log_error("BaresipManager", "HistoryAdd FAILED");
+            break;
+        }
+        mem_deref(e);
+    }
+}
+
+// UI thread joined: drop what is left, but keep the calls it had to log
+static void ui_events_flush(void) {
+    pthread_mutex_lock(&g_ui_event_mutex);
+    for (struct le *le = list_head(&g_ui_events); le; le = le->next) {
+        struct ui_event *e = le->data;
+        if (e->type == UI_EVENT_HISTORY)
+            history_add(e->peer, e->peer, e->history, e->text);
+    }
+    list_flush(&g_ui_events);
+    pthread_mutex_unlock(&g_ui_event_mutex);
+}
+
 // Command Queue for Thread Safety
 typedef enum {
     CMD_NONE = 0,
@@ -138,6 +360,8 @@ static struct {
 
 static pthread_mutex_t g_cmd_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+static void cmd_wakeup(void);
+
 // Queue Helper
 static bool cmd_enqueue(const cmd_t *cmd) {
     bool ret = false;
@@ -149,6 +373,7 @@ static bool cmd_enqueue(const cmd_t *cmd) {
         ret = true;
     }
     pthread_mutex_unlock(&g_cmd_mutex);
+    if (ret) cmd_wakeup();
     return ret;
 }
 
@@ -156,6 +381,9 @@ static bool cmd_enqueue(const cmd_t *cmd) {
 static struct tmr watchdog_tmr;
 static void check_call_watchdog(void *arg);
 
+static struct tmr g_media_tmr;
+static void media_sample_cb(void *arg);
+
 // Messaging Subsystem
 static struct message *g_message = NULL;
 
@@ -321,9 +549,7 @@ static void update_account_status(const char *aor, reg_status_t status) {
     acc->status = status;
     log_info("BaresipManager", "Account %s status: %d", aor, status);
 
-    if (g_call_state.reg_callback) {
-      g_call_state.reg_callback(aor, status);
-    }
+    notify_reg(aor, status);
   }
 }
 
@@ -361,9 +587,7 @@ static void message_handler(struct ua *ua, const struct pl *peer, const struct p
     // Save to DB (Incoming = 0)
     db_chat_add(from_uri, 0, text);
 
-    if (g_message_callback) {
-        g_message_callback(from_uri, text);
-    }
+    notify_message(from_uri, text);
 
     mem_deref(text);
     
@@ -376,6 +600,9 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
   struct ua *ua = bevent_get_ua(event);
   struct call *call = bevent_get_call(event);
   const char *prm = bevent_get_text(event);
+
+  // The current call may have changed
+  tmr_start(&g_media_tmr, 0, media_sample_cb, NULL);
   
   // Define peer early
   const char *peer = call ? call_peeruri(call) : "unknown";
@@ -422,17 +649,13 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
         log_warn("BaresipManager", ">>> REGISTER_FAIL: Auth Error %d", code);
         account_status_t *acc = find_account(aor);
         if (acc) acc->status = REG_STATUS_AUTH_FAILED;
-        if (g_call_state.reg_callback) {
-          g_call_state.reg_callback(aor, REG_STATUS_AUTH_FAILED);
-        }
+        notify_reg(aor, REG_STATUS_AUTH_FAILED);
       } else {
         log_warn("BaresipManager", ">>> REGISTER_FAIL: %s (reason: %s) ✗", aor,
                  error_text ? error_text : "unknown");
         account_status_t *acc = find_account(aor);
         if (acc) acc->status = REG_STATUS_FAILED;
-        if (g_call_state.reg_callback) {
-          g_call_state.reg_callback(aor, REG_STATUS_FAILED);
-        }
+        notify_reg(aor, REG_STATUS_FAILED);
       }
     } else {
       log_warn("BaresipManager", ">>> REGISTER_FAIL: ua is NULL!");
@@ -515,9 +738,8 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
              // Keep "unknown" or existing peer_uri
         }
 
-        if (g_call_state.callback)
-          g_call_state.callback(CALL_STATE_INCOMING, call ? call_peeruri(call) : "unknown",
-                                (void *)call);
+        notify_callback(CALL_STATE_INCOMING,
+                        call ? call_peeruri(call) : "unknown", call);
       }
     break;
 
@@ -569,10 +791,7 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
     // NOTIFY LISTENERS (INCOMING)
     if (g_listener_mgr.count > 0) {
       log_debug("BaresipManager", "Notifying %d listeners (INCOMING)", g_listener_mgr.count);
-      for(int i=0; i<g_listener_mgr.count; i++) {
-          if(g_listener_mgr.listeners[i]) 
-             g_listener_mgr.listeners[i](CALL_STATE_INCOMING, peer, (void *)call);
-      }
+      notify_listeners(CALL_STATE_INCOMING, peer, call);
     } else {
         log_warn("BaresipManager", "No listeners registered for INCOMING event!");
     }
@@ -582,20 +801,14 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
     if (call) {
         struct account *acc = call_account(call);
     }
-    if (g_listener_mgr.count > 0) {
-        for(int i=0; i<g_listener_mgr.count; i++) 
-            if(g_listener_mgr.listeners[i]) g_listener_mgr.listeners[i](CALL_STATE_OUTGOING, peer, (void *)call);
-    }
+    notify_listeners(CALL_STATE_OUTGOING, peer, call);
     break;
   case BEVENT_CALL_RINGING:
     log_info("BaresipManager", ">>> CALL RINGING");
     g_call_state.state = CALL_STATE_RINGING; // was OUTGOING, better RINGING
     if (call)
       add_or_update_call(call, CALL_STATE_RINGING, peer);
-    if (g_listener_mgr.count > 0) {
-        for(int i=0; i<g_listener_mgr.count; i++) 
-            if(g_listener_mgr.listeners[i]) g_listener_mgr.listeners[i](CALL_STATE_RINGING, peer, (void *)call);
-    }
+    notify_listeners(CALL_STATE_RINGING, peer, call);
     break;
 
   case BEVENT_CALL_PROGRESS:
@@ -603,10 +816,7 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
     g_call_state.state = CALL_STATE_EARLY;
     if (call)
       add_or_update_call(call, CALL_STATE_EARLY, peer);
-    if (g_listener_mgr.count > 0) {
-        for(int i=0; i<g_listener_mgr.count; i++) 
-            if(g_listener_mgr.listeners[i]) g_listener_mgr.listeners[i](CALL_STATE_EARLY, peer, (void *)call);
-    }
+    notify_listeners(CALL_STATE_EARLY, peer, call);
     break;
 
   case BEVENT_CALL_ESTABLISHED:
@@ -615,10 +825,7 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
     g_call_state.current_call = call;
     if (call)
       add_or_update_call(call, CALL_STATE_ESTABLISHED, peer);
-    if (g_listener_mgr.count > 0) {
-        for(int i=0; i<g_listener_mgr.count; i++) 
-            if(g_listener_mgr.listeners[i]) g_listener_mgr.listeners[i](CALL_STATE_ESTABLISHED, peer, (void *)call);
-    }
+    notify_listeners(CALL_STATE_ESTABLISHED, peer, call);
     break;
 
   case BEVENT_CALL_LOCAL_SDP:
@@ -653,12 +860,7 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
     
     log_warn("BaresipManager", "EVENT_CLOSED: Peer='%s', Incoming=%d, Type=%d", number, incoming, type);
     fflush(stdout); 
-    if (history_add(number, number, type, acc_aor) != 0) {
-        log_error("BaresipManager", "HistoryAdd FAILED");
-    } else {
-        log_warn("BaresipManager", "HistoryAdd SUCCESS");
-    }
-    fflush(stdout);
+    history_post(number, type, acc_aor);
 
 
 
@@ -701,31 +903,16 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
 
     // LISTENER NOTIFICATION
     if (g_call_state.state == CALL_STATE_TERMINATED) {
-         if (g_listener_mgr.count > 0) {
-              log_info("BaresipManager", ">>> Notifying listeners (TERMINATED)");
-              for(int i=0; i<g_listener_mgr.count; i++) {
-                  if(g_listener_mgr.listeners[i])
-                      g_listener_mgr.listeners[i](CALL_STATE_TERMINATED, peer, (void *)call);
-              }
-         }
+         log_info("BaresipManager", ">>> Notifying listeners (TERMINATED)");
+         notify_listeners(CALL_STATE_TERMINATED, peer, call);
          
          // FIX: Auto-reset to IDLE after notifying TERMINATED
          g_call_state.state = CALL_STATE_IDLE;
-         if (g_listener_mgr.count > 0) {
-              for(int i=0; i<g_listener_mgr.count; i++) {
-                  if(g_listener_mgr.listeners[i])
-                      g_listener_mgr.listeners[i](CALL_STATE_IDLE, peer, (void *)call);
-              }
-         }
-    } else if (g_listener_mgr.count > 0) {
+         notify_listeners(CALL_STATE_IDLE, peer, call);
+    } else if (g_call_state.current_call) {
          // Notify update (e.g. switched to other call)
-         if (g_call_state.current_call) {
-               for(int i=0; i<g_listener_mgr.count; i++) {
-                   if(g_listener_mgr.listeners[i])
-                       g_listener_mgr.listeners[i](g_call_state.state, g_call_state.peer_uri, 
-                                                   (void *)g_call_state.current_call);
-               }
-         }
+         notify_listeners(g_call_state.state, g_call_state.peer_uri,
+                          g_call_state.current_call);
     }
   
   default:
@@ -741,65 +928,163 @@ static void call_event_handler(enum bevent_ev ev, struct bevent *event, void *ar
 // Global video objects (Set by Applet)
 static lv_obj_t *g_remote_video_obj = NULL;
 static lv_obj_t *g_local_video_obj = NULL;
+// Buffer each video widget currently draws from (UI thread). The reference
+// keeps it alive when its stream is closed or the slot is reallocated; it
+// goes back to the buffer pool once the widget lets go of it.
+static void *g_remote_video_buf = NULL;
+static void *g_local_video_buf = NULL;
+// Remote video straight to the framebuffer (fbdev only)
+static bool g_video_overlay = false;
+// Holes of the active overlay region, in screen coordinates (UI thread)
+static lv_area_t g_overlay_holes[VIDEO_OVERLAY_MAX_HOLES];
+static int g_overlay_nholes = 0;
+// Local video object hidden because the selfview is composited (UI thread)
+static bool g_local_hidden_by_pip = false;
+
+// On-screen rectangles of the video objects (Set by Applet)
+struct video_rect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+static struct video_rect g_video_rect = {0, 0, 0, 0};
+static struct video_rect g_local_video_rect = {0, 0, 0, 0};
+
+// Resampling used to convert straight to the on-screen rectangle
+static video_scale_t g_video_scale = VIDEO_SCALE_BILINEAR;
+// Pixel format of the converted frames (LVGL's native colour format)
+static video_pix_t g_video_pix = VIDEO_PIX_ARGB8888;
+// Colour matrix: 0=Auto (by resolution), 1=BT.601, 2=BT.709
+static int g_video_matrix = 0;
+static bool g_video_full_range = false;
+// Extra clockwise rotation of every stream (display mounted rotated)
+static video_rotate_t g_video_rotate = VIDEO_ROTATE_0;
+// Show the camera mirrored, like a mirror rather than as the peer sees it
+static bool g_selfview_mirror = true;
+// Draw latency/pacing figures over the video during calls
+static bool g_video_stats_overlay = false;
+// Audio playout delay of the current call (usec), sampled on the SIP thread
+// and read by the decoder threads to hold video back for lip sync
+static uint64_t g_audio_delay_usec = 0;
+// The current call sends video (atomic, sampled with the audio delay)
+static bool g_call_sends_video = false;
+// Step outgoing video size/rate down when the CPU runs short
+static bool g_video_adapt = true;
+
+// One converted frame. Slots rotate through the mailbox, so each keeps the
+// geometry it was laid out with; the UI thread only ever reads its front slot.
+struct video_slot {
+  uint8_t *buf;
+  size_t size;
+  unsigned layout; // st->layout this buffer was painted for
+  bool changed;    // Buffer/geometry changed, LVGL must drop cached data
+  struct vidrect damage; // Area written by the last conversion
+  bool overlaid;         // Already copied to the framebuffer by the overlay
+  struct vidrect pip;    // Selfview composited into this buffer (w = 0: none)
+  uint64_t arrival;      // When the decoder handed the frame over (usec)
+  lv_img_dsc_t dsc;
+};
 
 struct vidisp_st {
   struct le le;
-  struct vidframe *frame;
+  // Frames are converted straight from the decoder's buffer; only the
+  // geometry/format of the last frame is kept to detect changes.
+  // Everything up to `mb` is owned by the decoder thread.
   struct vidsz size;
-  mtx_t *lock;
-  bool new_frame;
+  enum vidfmt fmt;
+  bool configured;
+
+  // Output geometry: slot buffers are out_size, the picture is scaled into
+  // out_rect (aspect preserved, letterboxed in black)
+  struct vidsz out_size;
+  struct vidrect out_rect;
+  video_scale_t scale;
+  video_pix_t pix;
+  video_csc_t csc;
+  video_rotate_t rotation; // Applied rotation (stream + display)
+  bool mirror;
+  unsigned layout; // Bumped on every geometry/format change
   bool is_local;
-  
-  // RGB565 Buffer for LVGL
-  uint8_t *rgb_buf;
-  size_t rgb_buf_size;
-  lv_img_dsc_t img_dsc;
+
+  // Orientation requested by the stream (vidisp update handler)
+  video_rotate_t orient;
+
+  // Latency/pacing histograms; decoder side written in disp, present side
+  // by the UI thread
+  struct video_timing timing;
+  // Presentation times from media timestamps (decoder thread)
+  struct video_sched sched;
+  // Selfview frames averaged down to the target size (decoder thread)
+  struct video_preview preview;
+
+  // Converted frames for LVGL, handed to the UI thread without locking
+  struct video_mailbox mb;
+  struct video_slot slots[VIDEO_MAILBOX_SLOTS];
 };
 
 static struct list vidisp_list;
 static mtx_t *vidisp_list_lock = NULL;
 
-// YUV420P to ARGB8888 Conversion (Fixed Point)
-static void yuv420p_to_argb8888(uint8_t *dst, const struct vidframe *vf) {
-    int w = vf->size.w;
-    int h = vf->size.h;
-    const uint8_t *y_plane = vf->data[0];
-    const uint8_t *u_plane = vf->data[1];
-    const uint8_t *v_plane = vf->data[2];
-    int y_stride = vf->linesize[0];
-    int u_stride = vf->linesize[1];
-    int v_stride = vf->linesize[2];
-    uint32_t *d = (uint32_t *)dst;
-
-    for (int y = 0; y < h; y++) {
-        for (int x = 0; x < w; x++) {
-            int Y = y_plane[y * y_stride + x];
-            int U = u_plane[(y / 2) * u_stride + (x / 2)];
-            int V = v_plane[(y / 2) * v_stride + (x / 2)];
-
-            int C = Y - 16;
-            int D = U - 128;
-            int E = V - 128;
-
-            int R = (298 * C + 409 * E + 128) >> 8;
-            int G = (298 * C - 100 * D - 208 * E + 128) >> 8;
-            int B = (298 * C + 516 * D + 128) >> 8;
-
-            if (R < 0) R = 0; else if (R > 255) R = 255;
-            if (G < 0) G = 0; else if (G > 255) G = 255;
-            if (B < 0) B = 0; else if (B > 255) B = 255;
-
-            // ARGB8888: A (0xFF), R, G, B
-            // SDL/LVGL usually expects 0xAARRGGBB on LE (B, G, R, A in memory)
-            // or 0xAABBGGRR?
-            // LV_COLOR_MAKE(r,g,b) handles it.
-            // But we don't have lv_color_make here easily without full include context setup?
-            // Actually we included lvgl.h.
-            // Let's manually pack: 0xFF << 24 | R << 16 | G << 8 | B
-            // On Little Endian: B, G, R, A. This matches SDL.
-            *d++ = (0xFF000000) | (R << 16) | (G << 8) | B;
-        }
+// lv_img TRUE_COLOR data must be in lv_color_t layout, so LV_COLOR_DEPTH
+// decides the output format. The framebuffer depth is only probed to warn
+// when LVGL has to convert again on flush.
+static video_pix_t video_display_pix(void) {
+#if LV_COLOR_DEPTH == 16
+  video_pix_t pix = LV_COLOR_16_SWAP ? VIDEO_PIX_RGB565_SWAP : VIDEO_PIX_RGB565;
+#else
+  video_pix_t pix = VIDEO_PIX_ARGB8888;
+#endif
+  struct fb_var_screeninfo vinfo;
+  int fd = open("/dev/fb0", O_RDONLY);
+
+  if (fd >= 0) {
+    if (ioctl(fd, FBIOGET_VSCREENINFO, &vinfo) == 0) {
+      log_info("BaresipManager", "Framebuffer: %ubpp, LVGL: %dbpp, video: %s",
+               vinfo.bits_per_pixel, LV_COLOR_DEPTH, video_pix_name(pix));
+      if ((int)vinfo.bits_per_pixel != LV_COLOR_DEPTH) {
+        log_warn("BaresipManager",
+                 "LV_COLOR_DEPTH (%d) does not match the framebuffer (%u), "
+                 "every flush is converted",
+                 LV_COLOR_DEPTH, vinfo.bits_per_pixel);
+      }
     }
+    close(fd);
+  } else {
+    log_info("BaresipManager", "Video output format: %s", video_pix_name(pix));
+  }
+
+  return pix;
+}
+
+// Estimated time of one memcpy of `bytes`, from a one-off bandwidth probe
+static uint64_t video_copy_cost_usec(size_t bytes) {
+  static uint64_t ns_per_mib = 0;
+
+  if (!ns_per_mib) {
+    const size_t probe = 1024 * 1024;
+    uint8_t *src = mem_zalloc(probe, NULL);
+    uint8_t *dst = mem_alloc(probe, NULL);
+    if (!src || !dst) {
+      mem_deref(src);
+      mem_deref(dst);
+      return 0;
+    }
+
+    memcpy(dst, src, probe); // Warm up
+    uint64_t t0 = tmr_jiffies_usec();
+    for (int i = 0; i < 8; i++) {
+      memcpy(dst, src, probe);
+      src[i] = dst[probe - 1 - i]; // Keep the copies observable
+    }
+    uint64_t elapsed = tmr_jiffies_usec() - t0;
+
+    ns_per_mib = elapsed ? elapsed * 1000 / 8 : 1;
+    mem_deref(src);
+    mem_deref(dst);
+  }
+
+  return (uint64_t)bytes * ns_per_mib / (1024 * 1024) / 1000;
 }
 
 static void lvgl_vidisp_destructor(void *arg) {
@@ -811,12 +1096,59 @@ static void lvgl_vidisp_destructor(void *arg) {
     mtx_unlock(vidisp_list_lock);
   }
 
-  if (st->frame)
-    mem_deref(st->frame);
-  if (st->lock)
-    mem_deref(st->lock);
-  if (st->rgb_buf)
-    mem_deref(st->rgb_buf);
+  struct video_mailbox_stats stats;
+  video_mailbox_get_stats(&st->mb, &stats);
+  log_info("BaresipManager",
+           "Video stream closed (Local=%d): produced %" PRIu64
+           ", presented %" PRIu64 ", overwritten %" PRIu64 ", late %" PRIu64,
+           st->is_local, stats.produced, stats.presented, stats.overwritten,
+           stats.late);
+
+  struct video_timing_report rep;
+  video_timing_report(&st->timing, &rep);
+  if (rep.convert.count) {
+    log_info("BaresipManager",
+             "Video timing (Local=%d): convert p50/p95/p99 %u/%u/%u us, "
+             "to screen %u/%u/%u us, jitter p95 %u us (avg %u)",
+             st->is_local, rep.convert.p50, rep.convert.p95, rep.convert.p99,
+             rep.delay.p50, rep.delay.p95, rep.delay.p99, rep.jitter.p95,
+             rep.jitter_avg);
+  }
+
+  if (!st->is_local && video_overlay_is_open()) {
+    struct video_overlay_stats ostats;
+    video_overlay_get_stats(&ostats);
+    log_info("BaresipManager",
+             "Video overlay: %" PRIu64 " frames, %" PRIu64
+             " KiB written, %" PRIu64 " fallbacks to LVGL",
+             ostats.frames, ostats.bytes / 1024, ostats.fallbacks);
+  }
+
+  if (st->is_local) {
+    struct video_pip_stats pstats;
+    video_pip_get_stats(&pstats);
+    log_info("BaresipManager",
+             "Selfview: %" PRIu64 " PiP conversions (%" PRIu64
+             " decimated), %" PRIu64 " remote frames composited, %" PRIu64
+             " shown alone decimated",
+             pstats.updates, pstats.decimated, pstats.composed,
+             st->preview.frames);
+    video_pip_clear();
+    video_preview_close(&st->preview);
+  }
+
+  // Parked for the next stream, unless the display still shows one
+  for (int i = 0; i < VIDEO_MAILBOX_SLOTS; i++) {
+    video_pool_put(st->slots[i].buf);
+  }
+
+  struct video_pool_stats pool;
+  video_pool_get_stats(&pool);
+  log_info("BaresipManager",
+           "Video buffer pool: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+           " evictions, %zu KiB held (cap %zu KiB)",
+           pool.hits, pool.misses, pool.evictions, pool.held / 1024,
+           pool.cap / 1024);
 }
 
 static int lvgl_vidisp_alloc(struct vidisp_st **stp, const struct vidisp *vd,
@@ -828,7 +1160,6 @@ static int lvgl_vidisp_alloc(struct vidisp_st **stp, const struct vidisp *vd,
   (void)arg;
 
   struct vidisp_st *st;
-  int err;
 
   // Determine if local based on vid pointer comparison
   bool is_local = (vd == vid2);
@@ -836,13 +1167,10 @@ static int lvgl_vidisp_alloc(struct vidisp_st **stp, const struct vidisp *vd,
   st = mem_zalloc(sizeof(*st), lvgl_vidisp_destructor);
   if (!st) return ENOMEM;
 
-  err = mutex_alloc(&st->lock);
-  if (err) {
-    mem_deref(st);
-    return err;
-  }
-
   st->is_local = is_local;
+  video_mailbox_init(&st->mb);
+  video_timing_init(&st->timing);
+  video_sched_init(&st->sched);
 
   mtx_lock(vidisp_list_lock);
   list_append(&vidisp_list, &st->le, st);
@@ -855,71 +1183,271 @@ static int lvgl_vidisp_alloc(struct vidisp_st **stp, const struct vidisp *vd,
   return 0;
 }
 
+// Fullscreen and window placement are decided by the call screen layout;
+// only the orientation is honoured
 static int lvgl_vidisp_update(struct vidisp_st *st, bool fullscreen, int orient,
                              const struct vidrect *window) {
   (void)fullscreen;
   (void)window;
-  (void)orient;
   if (!st) return EINVAL;
+
+  switch (orient) {
+  case VIDORIENT_LANDSCAPE_RIGHT:
+    st->orient = VIDEO_ROTATE_90;
+    break;
+  case VIDORIENT_PORTRAIT_UPSIDEDOWN:
+    st->orient = VIDEO_ROTATE_180;
+    break;
+  case VIDORIENT_LANDSCAPE_LEFT:
+    st->orient = VIDEO_ROTATE_270;
+    break;
+  default:
+    st->orient = VIDEO_ROTATE_0;
+    break;
+  }
   return 0;
 }
 
+// Grow r to the bounding box of r and a (a->w == 0: empty)
+static void vidrect_union(struct vidrect *r, const struct vidrect *a) {
+  if (!a->w || !a->h) return;
+  if (!r->w || !r->h) {
+    *r = *a;
+    return;
+  }
+
+  unsigned x1 = MAX(r->x + r->w, a->x + a->w);
+  unsigned y1 = MAX(r->y + r->h, a->y + a->h);
+  r->x = MIN(r->x, a->x);
+  r->y = MIN(r->y, a->y);
+  r->w = x1 - r->x;
+  r->h = y1 - r->y;
+}
+
 static int lvgl_vidisp_disp(struct vidisp_st *st, const char *title,
                            const struct vidframe *frame, uint64_t timestamp) {
   (void)title;
-  (void)timestamp;
   if (!st || !frame) return EINVAL;
 
-  mtx_lock(st->lock);
+  uint64_t arrival = video_timing_now();
+  uint64_t ts_usec = timestamp * 1000000u / VIDEO_TIMEBASE;
+  video_timing_frame(&st->timing, arrival, ts_usec);
+
+  // Remote frames wait for the audio played with them; the selfview is
+  // shown as soon as it is ready
+  uint64_t due = 0;
+  if (!st->is_local) {
+      due = video_sched_due(&st->sched, arrival, ts_usec,
+                            __atomic_load_n(&g_audio_delay_usec,
+                                            __ATOMIC_RELAXED),
+                            VIDEO_MAILBOX_QUEUE);
+      if (video_sched_late(&st->sched, arrival, due)) {
+          // Already behind its audio: not worth converting
+          video_mailbox_drop_late(&st->mb);
+          return 0;
+      }
+      video_sched_queued(&st->sched, arrival);
+  }
+
+  // Target size: the object's on-screen rectangle, or the decoded size
+  const struct video_rect *rect = st->is_local ? &g_local_video_rect : &g_video_rect;
+  struct vidsz out = frame->size;
+  video_scale_t scale = VIDEO_SCALE_NONE;
+  bool supported = video_convert_format_supported(frame->fmt);
+  video_csc_t csc = video_csc_select(frame->size.h, g_video_matrix,
+                                     g_video_full_range);
+  video_rotate_t rotation = (video_rotate_t)((st->orient + g_video_rotate) & 3);
+  bool mirror = st->is_local && g_selfview_mirror;
+  bool swap = rotation == VIDEO_ROTATE_90 || rotation == VIDEO_ROTATE_270;
+
+  // While the remote stream composites the selfview, the camera is only
+  // converted at PiP size and never shown on its own
+  if (st->is_local && supported &&
+      video_pip_update(frame, g_video_pix, csc, g_video_scale, rotation,
+                       mirror) == 0) {
+      return 0;
+  }
+  // Shown on its own at thumbnail size: average the camera frame down
+  // before converting it. The colour matrix stays the one of the source.
+  if (st->is_local && supported && g_video_scale != VIDEO_SCALE_NONE &&
+      rect->w <= VIDEO_SCALE_MAX_W) {
+      frame = video_preview_tap(&st->preview, frame, rect->w, rect->h, swap);
+  }
+  if (swap) {
+      out.w = frame->size.h;
+      out.h = frame->size.w;
+  }
+  if (g_video_scale != VIDEO_SCALE_NONE && supported &&
+      rect->w > 0 && rect->h > 0 && rect->w <= VIDEO_SCALE_MAX_W) {
+      out.w = rect->w;
+      out.h = rect->h;
+      scale = g_video_scale;
+  }
+
+  // Check size/format/target change
+  if (!st->configured || !vidsz_cmp(&st->size, &frame->size) ||
+      st->fmt != frame->fmt || !vidsz_cmp(&st->out_size, &out) ||
+      st->scale != scale || st->pix != g_video_pix || st->csc != csc ||
+      st->rotation != rotation || st->mirror != mirror) {
+      bool source_changed = !st->configured ||
+                            !vidsz_cmp(&st->size, &frame->size) ||
+                            st->fmt != frame->fmt;
 
-  // Check size/format change
-  if (!st->frame || !vidsz_cmp(&st->size, &frame->size) ||
-      st->frame->fmt != frame->fmt) {
-      
-      if (st->frame) mem_deref(st->frame);
-      st->frame = NULL;
       st->size = frame->size;
-      
-      int err = vidframe_alloc(&st->frame, frame->fmt, &frame->size);
-      if (err) {
-          mtx_unlock(st->lock);
-          return err;
+      st->fmt = frame->fmt;
+      st->out_size = out;
+      st->scale = scale;
+      st->pix = g_video_pix;
+      st->csc = csc;
+      st->rotation = rotation;
+      st->mirror = mirror;
+      st->layout++;
+      st->configured = true;
+
+      if (scale == VIDEO_SCALE_NONE) {
+          st->out_rect.x = 0;
+          st->out_rect.y = 0;
+          st->out_rect.w = out.w;
+          st->out_rect.h = out.h;
+      } else {
+          video_convert_fit_rect(swap ? frame->size.h : frame->size.w,
+                                 swap ? frame->size.w : frame->size.h,
+                                 out.w, out.h, &st->out_rect);
       }
 
-      // Re-allocate RGB buffer
-      if (st->rgb_buf) mem_deref(st->rgb_buf);
-      
-      // ARGB8888 = 4 bytes per pixel
-      st->rgb_buf_size = st->size.w * st->size.h * 4;
-      st->rgb_buf = mem_alloc(st->rgb_buf_size, NULL);
-      
-      log_info("BaresipManager", "Video Resize: %dx%d (Buf: %zu bytes)", 
-               st->size.w, st->size.h, st->rgb_buf_size);
-               
-      // Initialize Image Descriptor
-      st->img_dsc.header.always_zero = 0;
-      st->img_dsc.header.w = st->size.w;
-      st->img_dsc.header.h = st->size.h;
-      st->img_dsc.data_size = st->rgb_buf_size;
-      st->img_dsc.header.cf = LV_IMG_CF_TRUE_COLOR; // ARGB8888
-      st->img_dsc.data = st->rgb_buf;
+      log_info("BaresipManager", "Video Resize: %dx%d %s (%s) -> %ux%u %s rot %d%s (%s) (Buf: %zu bytes x %d)",
+               st->size.w, st->size.h, vidfmt_name(frame->fmt),
+               video_csc_name(st->csc),
+               st->out_rect.w, st->out_rect.h, video_pix_name(st->pix),
+               (int)st->rotation * 90, st->mirror ? " mirrored" : "",
+               scale == VIDEO_SCALE_NONE ? "native" :
+               scale == VIDEO_SCALE_NEAREST ? "nearest" : "bilinear",
+               (size_t)out.w * out.h * video_pix_bytes(st->pix),
+               VIDEO_MAILBOX_SLOTS);
+
+      if (!supported) {
+          log_warn("BaresipManager", "Video format %s not supported, showing black",
+                   vidfmt_name(frame->fmt));
+      }
+
+      if (source_changed) {
+          // What the old per-frame vidframe_copy() into a private frame cost
+          size_t yuv_size = vidframe_size(frame->fmt, &frame->size);
+          log_info("BaresipManager",
+                   "Video zero-copy: saves %zu bytes/stream, ~%" PRIu64
+                   " us/frame of copying", yuv_size, video_copy_cost_usec(yuv_size));
+      }
   }
 
-  // Copy YUV Data
-  vidframe_copy(st->frame, frame);
-  
-  // Convert to ARGB8888 immediately (Decode Thread)
-  if (st->rgb_buf && MIN(frame->size.w, st->size.w) > 0) {
-      if (frame->fmt == VID_FMT_YUV420P) {
-        yuv420p_to_argb8888(st->rgb_buf, frame);
+  // The back slot is ours alone until it is published, so conversion runs
+  // without holding anything the UI thread could wait on
+  struct video_slot *slot = &st->slots[video_mailbox_back(&st->mb)];
+
+  if (slot->layout != st->layout) {
+      // ARGB8888 = 4 bytes per pixel, RGB565 = 2
+      size_t size = st->out_size.w * st->out_size.h * video_pix_bytes(st->pix);
+
+      if (size != slot->size) {
+          // Sized by class, so a return to an earlier resolution (or the
+          // next call) picks up a parked buffer instead of the heap
+          video_pool_put(slot->buf);
+          slot->size = size;
+          slot->buf = video_pool_get(size);
+          if (!slot->buf) {
+              slot->size = 0;
+              slot->layout = 0;
+              return ENOMEM;
+          }
+      }
+
+      // Letterbox bars never change, paint them once (opaque black)
+      if (st->pix == VIDEO_PIX_ARGB8888) {
+          uint32_t *px = (uint32_t *)slot->buf;
+          for (size_t i = 0; i < slot->size / 4; i++) px[i] = 0xFF000000;
       } else {
-        // Fallback: Black or Copy if format matches (unlikely without swscale)
-        memset(st->rgb_buf, 0, st->rgb_buf_size); 
+          memset(slot->buf, 0, slot->size);
       }
-      st->new_frame = true;
+
+      // Initialize Image Descriptor
+      slot->dsc.header.always_zero = 0;
+      slot->dsc.header.w = st->out_size.w;
+      slot->dsc.header.h = st->out_size.h;
+      slot->dsc.data_size = slot->size;
+      slot->dsc.header.cf = LV_IMG_CF_TRUE_COLOR; // lv_color_t layout
+      slot->dsc.data = slot->buf;
+      slot->layout = st->layout;
+      slot->changed = true;
+      memset(&slot->pip, 0, sizeof(slot->pip));
+  }
+
+  // Convert to the display format immediately (Decode Thread), reading the
+  // decoder's frame in place. It is only valid for the duration of this call.
+  if (MIN(frame->size.w, st->size.w) > 0) {
+      size_t bpp = video_pix_bytes(st->pix);
+      size_t stride = st->out_size.w * bpp;
+      uint64_t t0 = video_timing_now();
+
+      int cerr = ENOTSUP;
+
+      // A selfview left in this buffer from an earlier frame may sit on the
+      // letterbox bars, which the conversion does not repaint
+      struct vidrect old_pip = slot->pip;
+      if (old_pip.w) {
+        video_pip_fill_black(slot->buf, stride, st->pix, &old_pip);
+        memset(&slot->pip, 0, sizeof(slot->pip));
+      }
+
+      if (supported && st->scale != VIDEO_SCALE_NONE) {
+        // Resample straight into the letterboxed area of the target rect
+        uint8_t *dst = slot->buf + st->out_rect.y * stride +
+                       st->out_rect.x * bpp;
+        cerr = video_convert_frame_transform(dst, stride, st->pix, st->csc,
+                                             st->out_rect.w, st->out_rect.h,
+                                             frame, st->scale, st->rotation,
+                                             st->mirror);
+      } else if (supported) {
+        cerr = video_convert_frame_transform(slot->buf, stride, st->pix,
+                                             st->csc, st->out_size.w,
+                                             st->out_size.h, frame,
+                                             VIDEO_SCALE_NONE, st->rotation,
+                                             st->mirror);
+      }
+
+      if (cerr) {
+        // Fallback: Black (no converter for this format)
+        memset(slot->buf, 0, slot->size); 
+      }
+
+      // Only the picture changes between frames, never the letterbox bars
+      if (cerr || st->scale == VIDEO_SCALE_NONE) {
+        slot->damage.x = 0;
+        slot->damage.y = 0;
+        slot->damage.w = st->out_size.w;
+        slot->damage.h = st->out_size.h;
+      } else {
+        slot->damage = st->out_rect;
+      }
+
+      if (!st->is_local &&
+          video_pip_compose(slot->buf, stride, st->pix, st->out_size.w,
+                            st->out_size.h, &slot->pip) != 0) {
+        memset(&slot->pip, 0, sizeof(slot->pip));
+      }
+      vidrect_union(&slot->damage, &old_pip);
+      vidrect_union(&slot->damage, &slot->pip);
+
+      slot->overlaid = g_video_overlay && !st->is_local &&
+                       video_overlay_blit(slot->buf, stride, st->out_size.w,
+                                          st->out_size.h, &slot->damage) == 0;
+
+      slot->arrival = arrival;
+      video_timing_converted(&st->timing, video_timing_now() - t0);
+
+      // Shown by the UI thread once due; a newer due frame replaces it
+      video_mailbox_publish(&st->mb, due);
+      baresip_manager_wakeup();
   }
 
-  mtx_unlock(st->lock);
   return 0;
 }
 
@@ -928,46 +1456,261 @@ static void lvgl_vidisp_hide(struct vidisp_st *st) { (void)st; }
 
 // API to set LVGL Objects
 void baresip_manager_set_video_objects(void *remote, void *local) {
+    if (g_remote_video_obj != remote)
+        g_remote_video_buf = video_pool_put(g_remote_video_buf);
+    if (g_local_video_obj != local)
+        g_local_video_buf = video_pool_put(g_local_video_buf);
+
     g_remote_video_obj = (lv_obj_t *)remote;
     g_local_video_obj = (lv_obj_t *)local;
+    g_local_hidden_by_pip = false;
+}
+
+// The composited selfview replaces the local video object
+static void video_pip_update_local_obj(void) {
+   lv_obj_t *local = g_local_video_obj;
+   if (!local || !lv_obj_is_valid(local)) return;
+
+   if (video_pip_active()) {
+       if (!lv_obj_has_flag(local, LV_OBJ_FLAG_HIDDEN)) {
+           lv_obj_add_flag(local, LV_OBJ_FLAG_HIDDEN);
+           g_local_hidden_by_pip = true;
+       }
+   } else if (g_local_hidden_by_pip) {
+       g_local_hidden_by_pip = false;
+       // Only bring it back if the call is still showing video
+       if (g_remote_video_obj && lv_obj_is_valid(g_remote_video_obj) &&
+           lv_obj_is_visible(g_remote_video_obj)) {
+           lv_obj_clear_flag(local, LV_OBJ_FLAG_HIDDEN);
+       }
+   }
+}
+
+// Hand the remote video widget's area to the framebuffer overlay, minus
+// whatever LVGL draws over it. Falls back to LVGL when the widget is hidden,
+// clipped or covered by too many objects.
+static void video_overlay_update(void) {
+   lv_obj_t *target = g_remote_video_obj;
+   lv_area_t holes[VIDEO_OVERLAY_MAX_HOLES];
+   int n = -1;
+
+   if (g_video_overlay && target && lv_obj_is_valid(target))
+       n = video_widget_get_occluders(target, holes, VIDEO_OVERLAY_MAX_HOLES);
+
+   if (n >= 0) {
+       struct vidrect rect = {
+           .x = target->coords.x1,
+           .y = target->coords.y1,
+           .w = lv_area_get_width(&target->coords),
+           .h = lv_area_get_height(&target->coords),
+       };
+       struct vidrect vholes[VIDEO_OVERLAY_MAX_HOLES];
+       for (int i = 0; i < n; i++) {
+           vholes[i].x = holes[i].x1;
+           vholes[i].y = holes[i].y1;
+           vholes[i].w = lv_area_get_width(&holes[i]);
+           vholes[i].h = lv_area_get_height(&holes[i]);
+       }
+
+       bool changed = n != g_overlay_nholes ||
+                      memcmp(holes, g_overlay_holes, n * sizeof(holes[0]));
+       if (target->coords.x1 >= 0 && target->coords.y1 >= 0 &&
+           video_overlay_set_region(&rect, vholes, (unsigned)n) == 0) {
+           if (changed) {
+               // The decoder may have painted over a new hole before this;
+               // it no longer does, so let LVGL draw it again
+               for (int i = 0; i < n; i++)
+                   lv_obj_invalidate_area(target, &holes[i]);
+               memcpy(g_overlay_holes, holes, n * sizeof(holes[0]));
+               g_overlay_nholes = n;
+           }
+           return;
+       }
+   }
+
+   if (video_overlay_active()) {
+       video_overlay_set_region(NULL, NULL, 0);
+       g_overlay_nholes = 0;
+       log_info("BaresipManager", "Video overlay: region back to LVGL");
+       if (target && lv_obj_is_valid(target))
+           lv_obj_invalidate(target);
+   }
+}
+
+// SIP thread: media state of the current call for the UI and decoder
+// threads, refreshed while there is one
+static void media_sample_cb(void *arg) {
+   (void)arg;
+   struct call *call = g_call_state.current_call;
+   struct audio *au = call ? call_audio(call) : NULL;
+
+   // Audio playout delay (jitter buffer), in ms
+   __atomic_store_n(&g_audio_delay_usec,
+                    au ? audio_jb_current_value(au) * 1000 : 0,
+                    __ATOMIC_RELAXED);
+   __atomic_store_n(&g_call_sends_video, call && call_video(call),
+                    __ATOMIC_RELAXED);
+
+   if (call) tmr_start(&g_media_tmr, 100, media_sample_cb, NULL);
 }
 
-// Process Video - Called from Main Thread (LVGL Loop)
-void baresip_manager_process_video(void) {
-   if (!vidisp_list_lock) return;
+// Process Video - Called from the UI thread (LVGL Loop)
+// The list lock only guards against streams being created/destroyed; the
+// decoder thread never takes it while converting.
+uint32_t baresip_manager_process_video(void) {
+   uint64_t next_due = 0;
+
+   if (!vidisp_list_lock) return UINT32_MAX;
+
+   video_pip_update_local_obj();
+   if (g_video_overlay || video_overlay_active())
+       video_overlay_update();
+
+   uint64_t now = video_timing_now();
+
+   // Outgoing video follows the CPU budget while a call sends it
+   video_adapt_tick(now, __atomic_load_n(&g_call_sends_video,
+                                         __ATOMIC_RELAXED));
 
    mtx_lock(vidisp_list_lock);
    
    struct le *le;
    for (le = vidisp_list.head; le; le = le->next) {
        struct vidisp_st *st = le->data;
-       
-       mtx_lock(st->lock);
-       if (st->new_frame && st->rgb_buf) {
-           lv_obj_t *target = st->is_local ? g_local_video_obj : g_remote_video_obj;
-           
-           if (target && lv_obj_is_valid(target)) {
-               // Update Image Source
-               lv_img_set_src(target, &st->img_dsc);
-               lv_obj_invalidate(target);
+       unsigned front;
+
+       bool ready = video_mailbox_acquire(&st->mb, now, &front);
+
+       // Frames still waiting for their time decide the next run
+       uint64_t due = video_mailbox_next_due(&st->mb);
+       if (due && (!next_due || due < next_due)) next_due = due;
+
+       if (!ready)
+           continue;
+
+       struct video_slot *slot = &st->slots[front];
+       if (!slot->buf)
+           continue;
+
+       video_timing_presented(&st->timing, now, slot->arrival);
+
+       lv_obj_t *target = st->is_local ? g_local_video_obj : g_remote_video_obj;
+       void **shown = st->is_local ? &g_local_video_buf : &g_remote_video_buf;
+       bool changed = slot->changed;
+
+       if (changed) {
+           // The buffer may have been reallocated behind the same descriptor
+           lv_img_cache_invalidate_src(&slot->dsc);
+           slot->changed = false;
+       }
+
+       if (!target || !lv_obj_is_valid(target))
+           continue;
+
+       if (video_widget_check(target)) {
+           // Only the picture area is redrawn, and only when a frame arrived
+           lv_area_t damage[VIDEO_OVERLAY_MAX_HOLES];
+           unsigned n = 1;
+
+           damage[0].x1 = slot->damage.x;
+           damage[0].y1 = slot->damage.y;
+           damage[0].x2 = slot->damage.x + (lv_coord_t)slot->damage.w - 1;
+           damage[0].y2 = slot->damage.y + (lv_coord_t)slot->damage.h - 1;
+
+           if (slot->overlaid && video_overlay_active() && !changed) {
+               // The overlay already put the picture on screen; LVGL only
+               // redraws the parts under its own objects
+               lv_area_t pic = damage[0];
+               n = 0;
+               for (int i = 0; i < g_overlay_nholes; i++) {
+                   lv_area_t hole = g_overlay_holes[i];
+                   lv_area_move(&hole, -target->coords.x1, -target->coords.y1);
+                   if (_lv_area_intersect(&damage[n], &hole, &pic)) n++;
+               }
            }
-           st->new_frame = false;
+
+           video_widget_set_frame(target, &slot->dsc,
+                                  changed ? NULL : damage, n);
+
+           video_pool_put(*shown);
+           *shown = mem_ref(slot->buf);
+       } else {
+           lv_img_set_src(target, &slot->dsc);
+           lv_obj_invalidate(target);
        }
-       mtx_unlock(st->lock);
    }
    
    mtx_unlock(vidisp_list_lock);
+
+   if (!next_due) return UINT32_MAX;
+   return next_due > now ? (uint32_t)((next_due - now + 999) / 1000) : 0;
+}
+
+int baresip_manager_get_video_stats(bool local,
+                                    struct video_mailbox_stats *stats) {
+   if (!stats) return EINVAL;
+   memset(stats, 0, sizeof(*stats));
+   if (!vidisp_list_lock) return ENOENT;
+
+   int found = ENOENT;
+   mtx_lock(vidisp_list_lock);
+   struct le *le;
+   for (le = vidisp_list.head; le; le = le->next) {
+       struct vidisp_st *st = le->data;
+       struct video_mailbox_stats s;
+
+       if (st->is_local != local) continue;
+
+       video_mailbox_get_stats(&st->mb, &s);
+       stats->produced += s.produced;
+       stats->presented += s.presented;
+       stats->overwritten += s.overwritten;
+       stats->late += s.late;
+       found = 0;
+   }
+   mtx_unlock(vidisp_list_lock);
+
+   return found;
+}
+
+int baresip_manager_get_video_timing(bool local,
+                                     struct video_timing_report *report) {
+   if (!report) return EINVAL;
+   memset(report, 0, sizeof(*report));
+   if (!vidisp_list_lock) return ENOENT;
+
+   int found = ENOENT;
+   mtx_lock(vidisp_list_lock);
+   struct le *le;
+   for (le = vidisp_list.head; le; le = le->next) {
+       struct vidisp_st *st = le->data;
+       struct video_mailbox_stats s;
+
+       if (st->is_local != local) continue;
+
+       // Newest stream of the kind
+       video_timing_report(&st->timing, report);
+       video_mailbox_get_stats(&st->mb, &s);
+       report->produced = s.produced;
+       report->presented = s.presented;
+       report->overwritten = s.overwritten;
+       report->late = s.late;
+       found = 0;
+   }
+   mtx_unlock(vidisp_list_lock);
+
+   return found;
+}
+
+void baresip_manager_set_video_stats_overlay(bool enable) {
+   g_video_stats_overlay = enable;
+}
+
+bool baresip_manager_get_video_stats_overlay(void) {
+   return g_video_stats_overlay;
 }
 
 // Removed duplicate/obsolete sdl_vidisp code and redefinitions
-struct video_rect {
-    int x;
-    int y;
-    int w;
-    int h;
-};
-static struct video_rect g_video_rect = {0, 0, 0, 0};
-static struct video_rect g_local_video_rect = {0, 0, 0, 0};
 
 
 // Video Display Module Pointers - Moved to Global Scope
@@ -989,6 +1732,84 @@ void baresip_manager_set_local_video_rect(int x, int y, int w, int h) {
   g_local_video_rect.h = h;
 }
 
+void baresip_manager_set_video_scale(int mode) {
+  switch (mode) {
+  case 1:
+    g_video_scale = VIDEO_SCALE_NEAREST;
+    break;
+  case 2:
+    g_video_scale = VIDEO_SCALE_NONE;
+    break;
+  default:
+    g_video_scale = VIDEO_SCALE_BILINEAR;
+    break;
+  }
+}
+
+void baresip_manager_set_video_dither(bool enable) {
+  video_convert_set_dither(enable);
+}
+
+void baresip_manager_set_video_overlay(bool enable) {
+  if (enable && !video_overlay_is_open()) {
+    int err = video_overlay_open(g_video_pix);
+    if (err) {
+      log_warn("BaresipManager", "Video overlay unavailable: %s",
+               strerror(err));
+      enable = false;
+    }
+  }
+
+  g_video_overlay = enable;
+  if (!enable) {
+    video_overlay_set_region(NULL, NULL, 0);
+    g_overlay_nholes = 0;
+    if (g_remote_video_obj && lv_obj_is_valid(g_remote_video_obj))
+      lv_obj_invalidate(g_remote_video_obj);
+  }
+  log_info("BaresipManager", "Video overlay: %s", enable ? "on" : "off");
+}
+
+void baresip_manager_set_video_pip(bool enable, int corner, int size_pct,
+                                   bool mirror) {
+  g_selfview_mirror = mirror;
+  video_pip_configure(enable, (video_pip_corner_t)corner,
+                      size_pct > 0 ? (unsigned)size_pct : 25);
+}
+
+void baresip_manager_set_video_colorspace(int matrix, bool full_range) {
+  g_video_matrix = (matrix == 1 || matrix == 2) ? matrix : 0;
+  g_video_full_range = full_range;
+}
+
+void baresip_manager_set_video_pool(int megabytes) {
+  video_pool_set_cap(megabytes > 0 ? (size_t)megabytes * 1024 * 1024 : 0);
+}
+
+void baresip_manager_set_video_rotation(int degrees) {
+  g_video_rotate = (video_rotate_t)(((degrees / 90) % 4 + 4) % 4);
+}
+
+// Encoder bitrate for a frame size and rate: about 0.11 bit per pixel,
+// which gives the 1 Mbit/s used so far for 640x480@30
+static uint32_t video_bitrate(unsigned width, unsigned height, unsigned fps) {
+  uint64_t bps = (uint64_t)width * height * fps / 9;
+
+  if (bps < 128000) bps = 128000;
+  if (bps > 4000000) bps = 4000000;
+  return (uint32_t)bps;
+}
+
+void baresip_manager_set_video_adapt(bool enable) {
+  SIP_THREAD();
+  struct config *cfg = conf_config();
+
+  g_video_adapt = enable;
+  if (cfg)
+    video_adapt_configure(enable, cfg->video.width, cfg->video.height,
+                          cfg->video.fps);
+}
+
 
 // Removed hanging sdl_vid_render logic
 
@@ -1174,6 +1995,21 @@ int baresip_manager_init(void) {
       log_warn("BaresipManager", "Failed to load app settings (using defaults)");
       // calloc already zeroed it
   }
+
+  // Video conversion worker pool (takes effect on next start)
+  video_workers_init(app_conf->video_threads);
+  baresip_manager_set_video_scale(app_conf->video_scale);
+  video_convert_set_dither(app_conf->video_dither);
+  g_video_overlay = app_conf->video_overlay; // Opened once the format is known
+  baresip_manager_set_video_pip(app_conf->video_pip, app_conf->video_pip_corner,
+                                app_conf->video_pip_size,
+                                app_conf->video_pip_mirror);
+  baresip_manager_set_video_colorspace(app_conf->video_matrix,
+                                       app_conf->video_full_range);
+  baresip_manager_set_video_rotation(app_conf->video_rotation);
+  baresip_manager_set_video_pool(app_conf->video_pool_mb);
+  baresip_manager_set_video_stats_overlay(app_conf->video_stats_overlay);
+  g_video_adapt = app_conf->video_adapt; // Ceiling known once the config is final
   memset(app_conf, 0, sizeof(app_config_t)); // Redundant but safe? No, calloc is safer. Removed memset.
  
   // Create baresip configuration
@@ -1358,11 +2194,30 @@ int baresip_manager_init(void) {
   // Ensure we use our custom display module
   re_snprintf(cfg->video.disp_mod, sizeof(cfg->video.disp_mod), "sdl_vidisp");
 
+  // The frame size setting is the ceiling; the adaptive source scales and
+  // paces below it when the CPU runs short (video_adapt.h)
   cfg->video.enc_fmt = VID_FMT_YUV420P;
-  cfg->video.width = 640;
-  cfg->video.height = 480;
   cfg->video.fps = 30;
-  cfg->video.bitrate = 1000000;
+  cfg->video.bitrate = video_bitrate(cfg->video.width, cfg->video.height,
+                                     cfg->video.fps);
+  if (cfg->video.src_mod[0] && strcmp(cfg->video.src_mod, "adapt") != 0) {
+    char inner[sizeof(cfg->video.src_mod) + sizeof(cfg->video.src_dev)];
+    int n = re_snprintf(inner, sizeof(inner), "%s,%s", cfg->video.src_mod,
+                        cfg->video.src_dev);
+
+    // Cut short, the wrapper would open some other device
+    if (n < 0 || (size_t)n >= sizeof(cfg->video.src_dev)) {
+      log_warn("BaresipManager",
+               "Video source %s,%s too long to wrap, not adapting",
+               cfg->video.src_mod, cfg->video.src_dev);
+    } else {
+      re_snprintf(cfg->video.src_mod, sizeof(cfg->video.src_mod), "adapt");
+      re_snprintf(cfg->video.src_dev, sizeof(cfg->video.src_dev), "%s",
+                  inner);
+    }
+  }
+  video_adapt_configure(g_video_adapt, cfg->video.width, cfg->video.height,
+                        cfg->video.fps);
   
   // FIX: Enable auto-accept (allocation) of incoming calls
   // Without this, SIPSESS_CONN fires but the call object is never created!
@@ -1394,6 +2249,10 @@ int baresip_manager_init(void) {
   err = mod_add(&m, &exports_sdl_vidisp);
   if (err) log_warn("BaresipManager", "Failed to add sdl_vidisp: %d", err);
 
+  // Adaptive wrapper around the camera source
+  err = video_adapt_register();
+  if (err) log_warn("BaresipManager", "Failed to add adaptive video source: %d", err);
+
   // Window pseudo-module (if needed for resize events)
   err = mod_add(&m, &exports_window);
   if (err) log_warn("BaresipManager", "Failed to add window module: %d", err);
@@ -1470,6 +2329,12 @@ int baresip_manager_init(void) {
     mutex_alloc(&vidisp_list_lock);
   }
 
+  // Pick the YUV->RGB kernel for this CPU before the first frame arrives
+  video_convert_init();
+  g_video_pix = video_display_pix();
+  if (g_video_overlay)
+    baresip_manager_set_video_overlay(true);
+
   printf("DEBUG: Post-mutex_alloc\n"); fflush(stdout);
 
   log_info("BaresipManager", "Initialization complete");
@@ -1564,6 +2429,7 @@ void baresip_manager_set_message_callback(message_event_cb cb) {
 }
 
 reg_status_t baresip_manager_get_account_status(const char *aor) {
+  SIP_THREAD();
   if (!aor)
     return REG_STATUS_NONE;
   account_status_t *acc = find_account(aor);
@@ -1571,6 +2437,30 @@ reg_status_t baresip_manager_get_account_status(const char *aor) {
 }
 
 // Watchdog Handler
+// Whether baresip still has the call (any UA, not just the primary
+// 'ua_call()')
+static bool call_exists(const struct call *call) {
+    struct le *le_ua;
+    for (le_ua = ((struct list *)uag_list())->head; le_ua; le_ua = le_ua->next) {
+        struct ua *u = le_ua->data;
+        struct le *le_call;
+        for (le_call = list_head(ua_calls(u)); le_call; le_call = le_call->next) {
+            if (le_call->data == call) return true;
+        }
+    }
+    return false;
+}
+
+// UI thread: leave the call screen once the watchdog closed the last call
+static void watchdog_close_ui(void) {
+    applet_t *current = applet_manager_get_current();
+    if (current && strcmp(current->name, "Call") == 0 &&
+        baresip_manager_get_state() == CALL_STATE_IDLE) {
+        log_warn("BaresipManager", "WATCHDOG: Force closing Call Applet");
+        applet_manager_back();
+    }
+}
+
 static void check_call_watchdog(void *arg) {
     (void)arg;
     tmr_start(&watchdog_tmr, 1000, check_call_watchdog, NULL); // Reschedule
@@ -1580,23 +2470,8 @@ static void check_call_watchdog(void *arg) {
     for (int i = 0; i < MAX_CALLS; i++) {
         if (g_call_state.active_calls[i].call) {
              struct call *c = g_call_state.active_calls[i].call;
-             bool core_found = false;
-             
-             // Scan all UAs
-             struct le *le_ua;
-             for (le_ua = ((struct list *)uag_list())->head; le_ua && !core_found; le_ua = le_ua->next) {
-                 struct ua *u = le_ua->data;
-                 struct list *calls_list = ua_calls(u);
-                 struct le *le_call;
-                 for (le_call = list_head(calls_list); le_call; le_call = le_call->next) {
-                      if (le_call->data == c) {
-                          core_found = true;
-                          break;
-                      }
-                 }
-             }
 
-             if (!core_found) {
+             if (!call_exists(c)) {
                   log_warn("BaresipManager", "GC: Removing Zombie Call %p from slot %d", c, i);
                   remove_call(c);
                   // Check if this was current call? remove_call handles it.
@@ -1607,22 +2482,7 @@ static void check_call_watchdog(void *arg) {
 
     if (!g_call_state.current_call) return;
 
-    bool found = false;
-    struct le *le;
-    // FIX: Iterate ALL calls for each UA, not just the primary 'ua_call()'.
-    struct le *le_ua;
-    for (le_ua = ((struct list *)uag_list())->head; le_ua && !found; le_ua = le_ua->next) {
-        struct ua *u = le_ua->data;
-        struct list *calls_list = ua_calls(u);
-        struct le *le_call;
-        for (le_call = list_head(calls_list); le_call; le_call = le_call->next) {
-             struct call *c = le_call->data;
-             if (c == g_call_state.current_call) {
-                 found = true;
-                 break;
-             }
-        }
-    }
+    bool found = call_exists(g_call_state.current_call);
 
     if (!found) {
         log_warn("BaresipManager", "WATCHDOG: Call %p vanished without EVENT_CLOSED!", (void*)g_call_state.current_call);
@@ -1640,7 +2500,7 @@ static void check_call_watchdog(void *arg) {
 
         log_warn("BaresipManager", "WATCHDOG: Adding History: %s (Type=%d)", peer, type);
         fflush(stdout);
-        history_add(peer, peer, type, ""); 
+        history_post(peer, type, "");
         
         // Update State
         struct call *dead_call = g_call_state.current_call;
@@ -1648,18 +2508,11 @@ static void check_call_watchdog(void *arg) {
         // Use remove_call to properly clean up and switch
         remove_call(dead_call);
         
-        if (g_call_state.callback) {
-             g_call_state.callback(CALL_STATE_TERMINATED, peer, NULL);
-        }
+        notify_callback(CALL_STATE_TERMINATED, peer, NULL);
         
-        // Force UI Back if needed
-         applet_t *current = applet_manager_get_current();
-        if (current && strcmp(current->name, "Call") == 0) {
-            log_warn("BaresipManager", "WATCHDOG: Force closing Call Applet");
-            // Only back if we truly went to IDLE (remove_call might have switched)
-            if (g_call_state.state == CALL_STATE_IDLE)
-               applet_manager_back();
-        }
+        // Force UI Back if needed; only if we truly went to IDLE
+        // (remove_call might have switched)
+        ui_run_later(watchdog_close_ui);
     }
 }
 
@@ -1685,6 +2538,7 @@ static void internal_hold_active_calls(struct call *exclude) {
 }
 
 int baresip_manager_connect(const char *uri, const char *account_aor, bool video) {
+  SIP_THREAD();
   char full_uri[256];
   struct ua *ua = NULL;
   int err;
@@ -1780,6 +2634,7 @@ int baresip_manager_videocall(const char *uri) {
 }
 
 int baresip_manager_answer_call(bool video) {
+  SIP_THREAD();
   struct call *c = g_call_state.current_call;
   
   // FAILSAFE: If no current call, scan core for any incoming call
@@ -1810,10 +2665,11 @@ int baresip_manager_answer_call(bool video) {
 }
 
 int baresip_manager_reject_call(void *call_ptr) {
+  SIP_THREAD();
   struct call *c = (struct call *)call_ptr;
   
-  // Check for Sentinel (Ghost Call) or NULL
-  if (c == (void*)0xDEADBEEF || c == NULL) {
+  // Check for Sentinel (Ghost Call), NULL, or a call gone since the UI saw it
+  if (c == (void*)0xDEADBEEF || c == NULL || !call_exists(c)) {
       log_warn("BaresipManager", "Reject: Received Ghost/Null pointer %p. Scanning...", call_ptr);
       c = NULL; // Reset to NULL to avoid using DEADBEEF
       
@@ -1858,6 +2714,7 @@ int baresip_manager_reject_call(void *call_ptr) {
 }
 
 int baresip_manager_hangup(void) {
+  SIP_THREAD();
   if (!g_call_state.current_call) return -1;
 
   struct call *call = g_call_state.current_call;
@@ -1904,25 +2761,16 @@ int baresip_manager_hangup(void) {
                      sizeof(g_call_state.peer_uri));
        }
 
-       // Notify listeners of the switch immediately to update UI
-       if (g_listener_mgr.count > 0) {
-            for(int i=0; i<g_listener_mgr.count; i++) {
-                if(g_listener_mgr.listeners[i])
-                    g_listener_mgr.listeners[i](g_call_state.state, g_call_state.peer_uri, (void *)g_call_state.current_call);
-            }
-       }
+       // Notify listeners of the switch to update UI
+       notify_listeners(g_call_state.state, g_call_state.peer_uri,
+                        g_call_state.current_call);
   } else {
        log_info("BaresipManager", "Hangup: No other calls, forcing IDLE");
        g_call_state.state = CALL_STATE_IDLE; 
        g_call_state.current_call = NULL;
        
        // Force notify IDLE to ensure UI closes
-       if (g_listener_mgr.count > 0) {
-            for(int i=0; i<g_listener_mgr.count; i++) {
-                if(g_listener_mgr.listeners[i])
-                    g_listener_mgr.listeners[i](CALL_STATE_IDLE, NULL, NULL);
-            }
-       }
+       notify_listeners(CALL_STATE_IDLE, NULL, NULL);
   }
 
   return 0;
@@ -1930,11 +2778,20 @@ int baresip_manager_hangup(void) {
 
 enum call_state baresip_manager_get_state(void) { return g_call_state.state; }
 
-const char *baresip_manager_get_peer(void) {
-  return g_call_state.peer_uri[0] ? g_call_state.peer_uri : NULL;
+bool baresip_manager_call_is_outgoing(void *call_id) {
+  SIP_THREAD();
+  struct call *call = (struct call *)call_id;
+  return call && call_exists(call) && call_is_outgoing(call);
+}
+
+void baresip_manager_get_peer(char *out_buf, size_t size) {
+  SIP_THREAD();
+  if (!out_buf || size == 0) return;
+  safe_strncpy(out_buf, g_call_state.peer_uri, size);
 }
 
 void baresip_manager_mute(bool mute) {
+  SIP_THREAD();
   g_call_state.muted = mute;
 
   if (g_call_state.current_call) {
@@ -1948,6 +2805,7 @@ void baresip_manager_mute(bool mute) {
 }
 
 int baresip_manager_account_register(const char *aor) {
+  SIP_THREAD();
   struct ua *ua = uag_find_aor(aor);
   if (!ua) {
     log_warn("BaresipManager", "Account not found for register: %s", aor ? aor : "NULL");
@@ -1957,6 +2815,7 @@ int baresip_manager_account_register(const char *aor) {
 }
 
 int baresip_manager_account_register_simple(const char *user, const char *domain) {
+    SIP_THREAD();
     if (!user || !domain) return -1;
     
     struct list *l = (struct list *)uag_list();
@@ -1978,9 +2837,9 @@ int baresip_manager_account_register_simple(const char *user, const char *domain
 
 
 
-// Timer callback for command processing
-// Timer callback for command processing
-// Timer callback for command processing
+// Command processing
+// Runs when a command is queued (woken through the UI mqueue) and once at
+// startup for anything queued before the loop existed
 static struct tmr g_loop_tmr;
 static void cmd_check_cb(void *arg) {
     (void)arg;
@@ -2015,31 +2874,262 @@ static void cmd_check_cb(void *arg) {
                 break;
         }
     }
-    
-    // Reschedule
-    tmr_start(&g_loop_tmr, 20, cmd_check_cb, NULL);
 }
 
 // UI Timer
+// The UI callback runs when it said it has something due, when a watched
+// input fd is readable, or when woken (video frames, commands, baresip
+// events); there is no fixed tick while idle. It runs from re_main, or on
+// its own thread (baresip_manager_set_ui_thread).
+#define UI_WATCH_MAX 8
+
+struct ui_watch {
+    int fd;                // -1 when free
+    struct re_fhs *fhs;    // re_main mode
+    bool (*ready_h)(void *arg);
+    void *arg;
+};
+
 static struct tmr g_ui_tmr;
-static void (*g_ui_cb)(void) = NULL;
-static int g_ui_interval = 5;
+static uint32_t (*g_ui_cb)(void) = NULL;
+static uint32_t g_ui_max_wait = 1000;
+static uint64_t g_ui_due;          // When the pending run was wanted (usec)
+static int g_ui_wake[2] = {-1, -1}; // Wakeup pipe
+static struct re_fhs *g_ui_wake_fhs;
+static int g_ui_wake_pending;      // A byte is in the pipe (atomic)
+static struct ui_watch g_ui_watch[UI_WATCH_MAX] = {
+    [0 ... UI_WATCH_MAX - 1] = {.fd = -1}};
+static pthread_t g_ui_thread;
+static int g_ui_stop;              // Ask the UI thread to return (atomic)
+static struct mqueue *g_cmd_mq;    // Command wakeups for the SIP thread
+
+void baresip_manager_set_ui_thread(bool enable) { g_ui_threaded = enable; }
+
+// One UI run; returns the ms until the next one is due
+static uint32_t ui_run(void) {
+    uint64_t start = video_timing_now();
+    uint32_t wait = g_ui_max_wait;
+
+    ui_dispatch_events();
+    if (g_ui_cb) {
+        uint32_t next = g_ui_cb();
+        // UINT32_MAX: parked until a wakeup or watched fd, not capped
+        if (next < wait || next == UINT32_MAX) wait = next;
+    }
+
+    // How long work waited for the UI: the delay before this run plus the
+    // run itself
+    uint64_t end = video_timing_now();
+    uint64_t response = end - MIN(start, g_ui_due);
+    video_adapt_ui_sample(response > UINT32_MAX ? UINT32_MAX
+                                                : (uint32_t)response);
+    return wait;
+}
+
+static void ui_timer_cb(void *arg);
+
+// re_main mode: run the UI callback in `ms`, unless a run is already due
+// earlier
+static void ui_schedule(uint32_t ms) {
+    uint64_t due = video_timing_now() + (uint64_t)ms * 1000;
+
+    if (tmr_isrunning(&g_ui_tmr) && g_ui_due <= due) return;
+    g_ui_due = due;
+    tmr_start(&g_ui_tmr, ms, ui_timer_cb, NULL);
+}
 
 static void ui_timer_cb(void *arg) {
     (void)arg;
-    if (g_ui_cb) {
-        g_ui_cb();
+    ui_schedule(ui_run());
+}
+
+static void ui_wake_drain(void) {
+    char buf[16];
+
+    __atomic_store_n(&g_ui_wake_pending, 0, __ATOMIC_RELEASE);
+    while (read(g_ui_wake[0], buf, sizeof(buf)) > 0) {
     }
-    tmr_start(&g_ui_tmr, g_ui_interval, ui_timer_cb, NULL);
 }
 
-void baresip_manager_loop(void (*ui_cb)(void), int interval_ms) {
+void baresip_manager_wakeup(void) {
+    int fd = __atomic_load_n(&g_ui_wake[1], __ATOMIC_ACQUIRE);
+
+    if (fd < 0) return;
+    // One byte in the pipe covers every wakeup until the UI drains it
+    if (__atomic_exchange_n(&g_ui_wake_pending, 1, __ATOMIC_ACQ_REL)) return;
+    if (write(fd, "w", 1) != 1)
+        __atomic_store_n(&g_ui_wake_pending, 0, __ATOMIC_RELEASE);
+}
+
+void baresip_manager_quit(void) {
+    SIP_THREAD();
+    re_cancel();
+}
+
+static void ui_wake_handler(int flags, void *arg) {
+    (void)flags;
+    (void)arg;
+
+    ui_wake_drain();
+    if (g_ui_cb) ui_schedule(0);
+}
+
+static void cmd_mqueue_handler(int id, void *data, void *arg) {
+    (void)id;
+    (void)data;
+    (void)arg;
+    cmd_check_cb(NULL);
+}
+
+static void cmd_wakeup(void) {
+    struct mqueue *mq = __atomic_load_n(&g_cmd_mq, __ATOMIC_ACQUIRE);
+    if (mq) mqueue_push(mq, 0, NULL);
+}
+
+static void ui_fd_handler(int flags, void *arg) {
+    struct ui_watch *w = arg;
+    (void)flags;
+
+    if (w->ready_h && !w->ready_h(w->arg)) return;
+    if (g_ui_cb) ui_schedule(0);
+}
+
+static int ui_watch_listen(struct ui_watch *w) {
+    int err = fd_listen(&w->fhs, w->fd, FD_READ, ui_fd_handler, w);
+    if (err) {
+        log_warn("BaresipManager", "Watching fd %d failed: %d", w->fd, err);
+        w->fhs = NULL;
+    }
+    return err;
+}
+
+int baresip_manager_watch_fd(int fd, bool (*ready_h)(void *arg), void *arg) {
+    if (fd < 0) return EINVAL;
+
+    for (int i = 0; i < UI_WATCH_MAX; i++) {
+        struct ui_watch *w = &g_ui_watch[i];
+        if (w->fd >= 0) continue;
+
+        w->ready_h = ready_h;
+        w->arg = arg;
+        // The UI thread polls the fd itself; re_main listens once the loop
+        // runs (or right away if it already does)
+        if (g_ui_cb && !g_ui_threaded) {
+            w->fd = fd;
+            int err = ui_watch_listen(w);
+            if (err) w->fd = -1;
+            return err;
+        }
+        __atomic_store_n(&w->fd, fd, __ATOMIC_RELEASE);
+        return 0;
+    }
+    return ENOSPC;
+}
+
+void baresip_manager_unwatch_fd(int fd) {
+    if (fd < 0) return;
+
+    for (int i = 0; i < UI_WATCH_MAX; i++) {
+        struct ui_watch *w = &g_ui_watch[i];
+        if (w->fd != fd) continue;
+
+        w->fhs = fd_close(w->fhs);
+        __atomic_store_n(&w->fd, -1, __ATOMIC_RELEASE);
+    }
+}
+
+static void ui_watch_close(void) {
+    for (int i = 0; i < UI_WATCH_MAX; i++) {
+        g_ui_watch[i].fhs = fd_close(g_ui_watch[i].fhs);
+        g_ui_watch[i].fd = -1;
+        g_ui_watch[i].ready_h = NULL;
+        g_ui_watch[i].arg = NULL;
+    }
+}
+
+static void *ui_thread_main(void *arg) {
+    struct pollfd pfd[1 + UI_WATCH_MAX];
+    struct ui_watch *watch[1 + UI_WATCH_MAX];
+    (void)arg;
+
+    log_info("BaresipManager", "UI thread running");
+    g_ui_due = video_timing_now();
+
+    while (!__atomic_load_n(&g_ui_stop, __ATOMIC_ACQUIRE)) {
+        uint64_t now = video_timing_now();
+        nfds_t n = 0;
+
+        if (now >= g_ui_due) {
+            uint32_t next = ui_run();
+            now = video_timing_now();
+            g_ui_due = now + (uint64_t)next * 1000;
+        }
+        uint64_t wait = (g_ui_due - now + 999) / 1000;
+
+        pfd[n].fd = g_ui_wake[0];
+        pfd[n].events = POLLIN;
+        watch[n++] = NULL;
+        for (int i = 0; i < UI_WATCH_MAX; i++) {
+            int fd = __atomic_load_n(&g_ui_watch[i].fd, __ATOMIC_ACQUIRE);
+            if (fd < 0) continue;
+            pfd[n].fd = fd;
+            pfd[n].events = POLLIN;
+            watch[n++] = &g_ui_watch[i];
+        }
+
+        // Parked (or nothing due for weeks): only a wakeup or an fd
+        if (poll(pfd, n, wait > INT_MAX ? -1 : (int)wait) <= 0) continue;
+
+        bool run = false;
+        for (nfds_t i = 0; i < n; i++) {
+            if (!(pfd[i].revents & (POLLIN | POLLERR | POLLHUP))) continue;
+            if (!watch[i]) {
+                ui_wake_drain();
+                run = true;
+                continue;
+            }
+            // An earlier handler may have unwatched it
+            if (__atomic_load_n(&watch[i]->fd, __ATOMIC_ACQUIRE) != pfd[i].fd)
+                continue;
+            if (!watch[i]->ready_h || watch[i]->ready_h(watch[i]->arg))
+                run = true;
+        }
+
+        // Woken early: the run is wanted now
+        now = video_timing_now();
+        if (run && now < g_ui_due) g_ui_due = now;
+    }
+
+    log_info("BaresipManager", "UI thread stopped");
+    return NULL;
+}
+
+static int ui_wake_open(void) {
+    if (pipe(g_ui_wake) != 0) return errno;
+
+    for (int i = 0; i < 2; i++) {
+        fcntl(g_ui_wake[i], F_SETFL, fcntl(g_ui_wake[i], F_GETFL) | O_NONBLOCK);
+        fcntl(g_ui_wake[i], F_SETFD, FD_CLOEXEC);
+    }
+    return 0;
+}
+
+static void ui_wake_close(void) {
+    int fd = g_ui_wake[1];
+
+    __atomic_store_n(&g_ui_wake[1], -1, __ATOMIC_RELEASE);
+    if (fd >= 0) close(fd);
+    if (g_ui_wake[0] >= 0) close(g_ui_wake[0]);
+    g_ui_wake[0] = -1;
+}
+
+void baresip_manager_loop(uint32_t (*ui_cb)(void), int max_wait_ms) {
   int err;
 
   // Initialize manager
   // Removed redundant init call: err = baresip_manager_init();
   
-  printf("BaresipManager: Loop Starting... Interval=%dms\n", interval_ms);
+  printf("BaresipManager: Loop Starting... Max wait=%dms\n", max_wait_ms);
   fflush(stdout);
 
   // Force load critical codecs with absolute paths to bypass stale config issues
@@ -2060,17 +3150,52 @@ void baresip_manager_loop(void (*ui_cb)(void), int interval_ms) {
   fflush(stdout);
   // log_info("BaresipManager", "Starting Main Loop...");
   tmr_init(&g_loop_tmr);
-  
-  // Start Command Check Timer
-  tmr_start(&g_loop_tmr, 50, cmd_check_cb, NULL);
+
+  // Producers on other threads wake the loop instead of being polled
+  err = mqueue_alloc(&g_cmd_mq, cmd_mqueue_handler, NULL);
+  if (!err) err = ui_wake_open();
+  if (err) {
+      log_error("BaresipManager", "Loop wakeups failed: %d", err);
+      g_cmd_mq = mem_deref(g_cmd_mq);
+      return;
+  }
+
+  // Commands queued before the loop started
+  tmr_start(&g_loop_tmr, 0, cmd_check_cb, NULL);
 
   // Start UI Timer
-  if (ui_cb && interval_ms > 0) {
+  if (ui_cb) {
       g_ui_cb = ui_cb;
-      g_ui_interval = interval_ms;
-      tmr_init(&g_ui_tmr);
-      tmr_start(&g_ui_tmr, interval_ms, ui_timer_cb, NULL);
-      printf("BaresipManager: UI Timer started (Interval: %dms)\n", interval_ms);
+      if (max_wait_ms > 0) g_ui_max_wait = (uint32_t)max_wait_ms;
+      g_sip_thread = pthread_self();
+
+      if (g_ui_threaded) {
+          // Entry points called from the UI thread cross over from its
+          // first run on
+          __atomic_store_n(&g_ui_stop, 0, __ATOMIC_RELEASE);
+          __atomic_store_n(&g_ui_thread_running, 1, __ATOMIC_RELEASE);
+          err = pthread_create(&g_ui_thread, NULL, ui_thread_main, NULL);
+          if (err) {
+              log_warn("BaresipManager",
+                       "UI thread failed (%d), running the UI from re_main",
+                       err);
+              __atomic_store_n(&g_ui_thread_running, 0, __ATOMIC_RELEASE);
+              g_ui_threaded = false;
+          }
+      }
+
+      if (!g_ui_threaded) {
+          fd_listen(&g_ui_wake_fhs, g_ui_wake[0], FD_READ, ui_wake_handler,
+                    NULL);
+          for (int i = 0; i < UI_WATCH_MAX; i++) {
+              if (g_ui_watch[i].fd >= 0 && ui_watch_listen(&g_ui_watch[i]))
+                  g_ui_watch[i].fd = -1;
+          }
+          tmr_init(&g_ui_tmr);
+          ui_schedule(0);
+      }
+      printf("BaresipManager: UI %s started (Max wait: %ums)\n",
+             g_ui_threaded ? "thread" : "timer", g_ui_max_wait);
   }
 
   // Run main loop (Blocks until re_cancel or error)
@@ -2082,10 +3207,29 @@ void baresip_manager_loop(void (*ui_cb)(void), int interval_ms) {
       printf("BaresipManager: re_main exited normally\n");
   }
 
+  if (__atomic_load_n(&g_ui_thread_running, __ATOMIC_ACQUIRE)) {
+      __atomic_store_n(&g_ui_stop, 1, __ATOMIC_RELEASE);
+      baresip_manager_wakeup();
+      pthread_join(g_ui_thread, NULL);
+      __atomic_store_n(&g_ui_thread_running, 0, __ATOMIC_RELEASE);
+  }
+
   tmr_cancel(&g_ui_tmr);
   tmr_cancel(&g_loop_tmr);
+  tmr_cancel(&g_media_tmr);
+  g_ui_wake_fhs = fd_close(g_ui_wake_fhs);
+  ui_watch_close();
+  g_ui_cb = NULL;
+  ui_events_flush();
 
+  video_adapt_unregister();
   baresip_close();
+  // Decoder threads are gone; nothing wakes the loop any more
+  ui_wake_close();
+  g_cmd_mq = mem_deref(g_cmd_mq);
+  video_workers_close();
+  video_overlay_close();
+  video_pool_flush();
   libre_close();
 }
 
@@ -2235,6 +3379,7 @@ static int internal_add_account(const voip_account_t *acc) {
 // --- Active Calls and Call Control ---
 
 int baresip_manager_get_active_calls(call_info_t *calls, int max_count) {
+  SIP_THREAD();
   int count = 0;
   
   // No fallback logic needed: active_calls array is the source of truth.
@@ -2262,6 +3407,7 @@ int baresip_manager_get_active_calls(call_info_t *calls, int max_count) {
 }
 
 int baresip_manager_send_dtmf(char key) {
+  SIP_THREAD();
   if (!g_call_state.current_call)
     return -1;
   return call_send_digit(g_call_state.current_call, key);
@@ -2270,6 +3416,7 @@ int baresip_manager_send_dtmf(char key) {
 
 
 int baresip_manager_transfer(const char *target) {
+    SIP_THREAD();
     if (!g_call_state.current_call) {
         log_warn("BaresipManager", "Transfer: No active call");
         return -1;
@@ -2280,10 +3427,11 @@ int baresip_manager_transfer(const char *target) {
 
 // Ensure correct thread safe call (usually called from main thread)
 int baresip_manager_hold_call(void *call_id) {
+  SIP_THREAD();
   struct call *call = (struct call *)call_id;
   if (!call) call = g_call_state.current_call;
 
-  if (!call) {
+  if (!call || !call_exists(call)) {
     log_warn("BaresipManager", "No call to hold");
     return -1;
   }
@@ -2292,10 +3440,11 @@ int baresip_manager_hold_call(void *call_id) {
 }
 
 int baresip_manager_resume_call(void *call_id) {
+  SIP_THREAD();
   struct call *call = (struct call *)call_id;
   if (!call) call = g_call_state.current_call;
 
-  if (!call) {
+  if (!call || !call_exists(call)) {
     log_warn("BaresipManager", "No call to resume");
     return -1;
   }
@@ -2316,21 +3465,18 @@ int baresip_manager_resume_call(void *call_id) {
 
 // Switch to specific call
 int baresip_manager_switch_to(void *call_id) {
+    SIP_THREAD();
     if (!call_id) return -1;
     struct call *call = (struct call *)call_id;
+    if (!call_exists(call)) return -1;
     
     log_info("BaresipManager", "Switching current call to %p", call);
     g_call_state.current_call = call;
     g_call_state.state = call_state(call);
     safe_strncpy(g_call_state.peer_uri, call_peeruri(call), sizeof(g_call_state.peer_uri));
 
-    // Notify listeners so UI updates immediately
-    if (g_listener_mgr.count > 0) {
-        for(int i=0; i<g_listener_mgr.count; i++) {
-             if(g_listener_mgr.listeners[i])
-                 g_listener_mgr.listeners[i](g_call_state.state, g_call_state.peer_uri, (void *)call);
-        }
-    }
+    // Notify listeners so UI updates on its next run
+    notify_listeners(g_call_state.state, g_call_state.peer_uri, call);
     return 0;
 }
 
@@ -2381,11 +3527,16 @@ void baresip_manager_set_log_level(log_level_t level) {
 void baresip_manager_destroy(void) {
   ua_stop_all(false);
   ua_close();
+  video_adapt_unregister();
   baresip_close();
+  video_workers_close();
+  video_overlay_close();
+  video_pool_flush();
   libre_close();
 }
 
 void baresip_manager_get_peer_display_name(struct call *call, const char *peer_uri, char *out_buf, size_t size) {
+    SIP_THREAD();
     if (!out_buf || size == 0) return;
     out_buf[0] = '\0';
 
@@ -2444,6 +3595,7 @@ void baresip_manager_get_peer_display_name(struct call *call, const char *peer_u
 }
 
 void baresip_manager_get_current_call_display_name(char *out_buf, size_t size) {
+    SIP_THREAD();
     if (g_call_state.current_call) {
         baresip_manager_get_peer_display_name(g_call_state.current_call, g_call_state.peer_uri, out_buf, size);
     } else {
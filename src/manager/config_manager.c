@@ -59,6 +59,9 @@ int config_load_app_settings(app_config_t *config) {
   config->address_family = 0; // IPv4
   config->dns_servers[0] = '\0';
   config->show_favorites = true; // Default to true
+  config->display_page_flip = true;
+  config->ui_stats_overlay = false;
+  config->screen_off_sec = 120;
   config->stun_server[0] = '\0';
   config->use_tls_client_cert = 0;
   config->verify_server_cert = 0;
@@ -67,6 +70,20 @@ int config_load_app_settings(app_config_t *config) {
   strcpy(config->user_agent, "Baresip-LVGL");
   config->contacts_source = 0; // None
   config->video_frame_size = 0; // 0=Disabled. Fixes 488 for audio-only calls.
+  config->video_threads = 0; // Auto
+  config->video_scale = 0; // Bilinear
+  config->video_dither = true;
+  config->video_matrix = 0; // Auto
+  config->video_full_range = false;
+  config->video_rotation = 0;
+  config->video_pool_mb = 16;
+  config->video_stats_overlay = false;
+  config->video_adapt = true;
+  config->video_overlay = false;
+  config->video_pip = true;
+  config->video_pip_corner = 0; // Top right
+  config->video_pip_size = 25;
+  config->video_pip_mirror = true;
 
   config_get_dir_path(path, sizeof(path));
   strcat(path, "/settings.conf");
@@ -95,6 +112,12 @@ int config_load_app_settings(app_config_t *config) {
           strncpy(config->dns_servers, val, sizeof(config->dns_servers)-1);
         else if (strcmp(key, "ShowFavorites") == 0)
           config->show_favorites = atoi(val);
+        else if (strcmp(key, "DisplayPageFlip") == 0)
+          config->display_page_flip = atoi(val);
+        else if (strcmp(key, "UiStatsOverlay") == 0)
+          config->ui_stats_overlay = atoi(val);
+        else if (strcmp(key, "ScreenOffSec") == 0)
+          config->screen_off_sec = atoi(val);
         else if (strcmp(key, "StunServer") == 0)
           strncpy(config->stun_server, val, sizeof(config->stun_server)-1);
         else if (strcmp(key, "UseTLSCert") == 0)
@@ -109,6 +132,34 @@ int config_load_app_settings(app_config_t *config) {
           config->contacts_source = atoi(val);
         else if (strcmp(key, "VideoSize") == 0)
           config->video_frame_size = atoi(val);
+        else if (strcmp(key, "VideoThreads") == 0)
+          config->video_threads = atoi(val);
+        else if (strcmp(key, "VideoScale") == 0)
+          config->video_scale = atoi(val);
+        else if (strcmp(key, "VideoDither") == 0)
+          config->video_dither = atoi(val);
+        else if (strcmp(key, "VideoMatrix") == 0)
+          config->video_matrix = atoi(val);
+        else if (strcmp(key, "VideoFullRange") == 0)
+          config->video_full_range = atoi(val);
+        else if (strcmp(key, "VideoRotation") == 0)
+          config->video_rotation = atoi(val);
+        else if (strcmp(key, "VideoPoolMB") == 0)
+          config->video_pool_mb = atoi(val);
+        else if (strcmp(key, "VideoStatsOverlay") == 0)
+          config->video_stats_overlay = atoi(val);
+        else if (strcmp(key, "VideoAdaptive") == 0)
+          config->video_adapt = atoi(val);
+        else if (strcmp(key, "VideoOverlay") == 0)
+          config->video_overlay = atoi(val);
+        else if (strcmp(key, "VideoPip") == 0)
+          config->video_pip = atoi(val);
+        else if (strcmp(key, "VideoPipCorner") == 0)
+          config->video_pip_corner = atoi(val);
+        else if (strcmp(key, "VideoPipSize") == 0)
+          config->video_pip_size = atoi(val);
+        else if (strcmp(key, "VideoPipMirror") == 0)
+          config->video_pip_mirror = atoi(val);
         else if (strcmp(key, "LogLevel") == 0)
           config->log_level = logger_parse_level(val);
       }
@@ -164,6 +215,9 @@ int config_save_app_settings(const app_config_t *config) {
   fprintf(fp, "AddrFam=%d\n", config->address_family);
   fprintf(fp, "DNS=%s\n", config->dns_servers);
   fprintf(fp, "ShowFavorites=%d\n", config->show_favorites);
+  fprintf(fp, "DisplayPageFlip=%d\n", config->display_page_flip);
+  fprintf(fp, "UiStatsOverlay=%d\n", config->ui_stats_overlay);
+  fprintf(fp, "ScreenOffSec=%d\n", config->screen_off_sec);
   fprintf(fp, "StunServer=%s\n", config->stun_server);
   fprintf(fp, "UseTLSCert=%d\n", config->use_tls_client_cert);
   fprintf(fp, "VerifyServerCert=%d\n", config->verify_server_cert);
@@ -171,6 +225,20 @@ int config_save_app_settings(const app_config_t *config) {
   fprintf(fp, "UserAgent=%s\n", config->user_agent);
   fprintf(fp, "ContactsSrc=%d\n", config->contacts_source);
   fprintf(fp, "VideoSize=%d\n", config->video_frame_size);
+  fprintf(fp, "VideoThreads=%d\n", config->video_threads);
+  fprintf(fp, "VideoScale=%d\n", config->video_scale);
+  fprintf(fp, "VideoDither=%d\n", config->video_dither);
+  fprintf(fp, "VideoMatrix=%d\n", config->video_matrix);
+  fprintf(fp, "VideoFullRange=%d\n", config->video_full_range);
+  fprintf(fp, "VideoRotation=%d\n", config->video_rotation);
+  fprintf(fp, "VideoPoolMB=%d\n", config->video_pool_mb);
+  fprintf(fp, "VideoStatsOverlay=%d\n", config->video_stats_overlay);
+  fprintf(fp, "VideoAdaptive=%d\n", config->video_adapt);
+  fprintf(fp, "VideoOverlay=%d\n", config->video_overlay);
+  fprintf(fp, "VideoPip=%d\n", config->video_pip);
+  fprintf(fp, "VideoPipCorner=%d\n", config->video_pip_corner);
+  fprintf(fp, "VideoPipSize=%d\n", config->video_pip_size);
+  fprintf(fp, "VideoPipMirror=%d\n", config->video_pip_mirror);
   fprintf(fp, "LogLevel=%s\n", logger_level_str(config->log_level));
 
   fclose(fp);
@@ -0,0 +1,83 @@
+#include "disp_hook.h"
+#include "video_timing.h"
+#include <errno.h>
+
+typedef void (*flush_cb_t)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *);
+
+static struct {
+  const struct disp_hook *hooks[DISP_HOOK_MAX];
+  unsigned count;
+
+  // Wrapped display callbacks
+  lv_disp_t *disp;
+  lv_timer_cb_t refr_cb;
+  flush_cb_t flush_cb;
+} g;
+
+static void hooked_flush(lv_disp_drv_t *drv, const lv_area_t *area,
+                         lv_color_t *color_p) {
+  // Read before the driver has the buffer
+  bool last = lv_disp_flush_is_last(drv);
+  uint64_t start = video_timing_now();
+
+  g.flush_cb(drv, area, color_p);
+
+  uint64_t us = video_timing_now() - start;
+  for (unsigned i = 0; i < g.count; i++) {
+    const struct disp_hook *h = g.hooks[i];
+    if (h->flushed) h->flushed(area, us, last, h->arg);
+  }
+}
+
+static void hooked_refresh(lv_timer_t *t) {
+  for (unsigned i = 0; i < g.count; i++) {
+    const struct disp_hook *h = g.hooks[i];
+    if (h->refresh_begin) h->refresh_begin(h->arg);
+  }
+
+  g.refr_cb(t);
+
+  for (unsigned i = 0; i < g.count; i++) {
+    const struct disp_hook *h = g.hooks[i];
+    if (h->refresh_end) h->refresh_end(h->arg);
+  }
+}
+
+int disp_hook_add(const struct disp_hook *hook) {
+  if (!hook) return EINVAL;
+  for (unsigned i = 0; i < g.count; i++) {
+    if (g.hooks[i] == hook) return 0;
+  }
+  if (g.count == DISP_HOOK_MAX) return ENOSPC;
+
+  if (!g.count) {
+    lv_disp_t *disp = lv_disp_get_default();
+    if (!disp || !disp->refr_timer) return EINVAL;
+
+    g.disp = disp;
+    g.refr_cb = disp->refr_timer->timer_cb;
+    g.flush_cb = disp->driver->flush_cb;
+    lv_timer_set_cb(disp->refr_timer, hooked_refresh);
+    disp->driver->flush_cb = hooked_flush;
+  }
+
+  g.hooks[g.count++] = hook;
+  return 0;
+}
+
+void disp_hook_remove(const struct disp_hook *hook) {
+  for (unsigned i = 0; i < g.count; i++) {
+    if (g.hooks[i] != hook) continue;
+
+    for (unsigned j = i + 1; j < g.count; j++) g.hooks[j - 1] = g.hooks[j];
+    g.count--;
+    break;
+  }
+  if (g.count || !g.disp) return;
+
+  if (g.disp->refr_timer->timer_cb == hooked_refresh)
+    lv_timer_set_cb(g.disp->refr_timer, g.refr_cb);
+  if (g.disp->driver->flush_cb == hooked_flush)
+    g.disp->driver->flush_cb = g.flush_cb;
+  g.disp = NULL;
+}
@@ -0,0 +1,38 @@
+#ifndef DISP_HOOK_H
+#define DISP_HOOK_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Observers of one display at a time
+#define DISP_HOOK_MAX 4
+
+/**
+ * Observer of the default display's refreshes. Every callback is optional
+ * and gets `arg`.
+ */
+struct disp_hook {
+  // Around each run of the refresh timer, whether it draws or not
+  void (*refresh_begin)(void *arg);
+  void (*refresh_end)(void *arg);
+  // After flush_cb returned for `area`, which took `usec`; `last` is the
+  // final area of the frame
+  void (*flushed)(const lv_area_t *area, uint64_t usec, bool last, void *arg);
+  void *arg;
+};
+
+/**
+ * @brief Start observing the default display.
+ *        The first hook wraps the refresh timer and flush_cb, the last one
+ *        removed puts them back, so the statistics and the latency
+ *        benchmark can watch the same display without wrapping each other.
+ *        UI thread only, after the display is registered.
+ *
+ * @param hook Kept until removed.
+ * @return 0, EINVAL without a display, ENOSPC when DISP_HOOK_MAX are in use
+ */
+int disp_hook_add(const struct disp_hook *hook);
+void disp_hook_remove(const struct disp_hook *hook);
+
+#endif // DISP_HOOK_H
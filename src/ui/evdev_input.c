@@ -0,0 +1,316 @@
+#include "evdev_input.h"
+#include "logger.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+// Kernel events read per syscall
+#define EVDEV_READ_BATCH 64
+
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define NLONGS(bits) ((bits) / BITS_PER_LONG + 1)
+
+static bool has_bit(const unsigned long *bits, unsigned bit) {
+  return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1;
+}
+
+void evdev_input_init(struct evdev_input *in, int fd,
+                      enum evdev_input_type type) {
+  unsigned long key[NLONGS(KEY_MAX)] = {0};
+  unsigned long absbits[NLONGS(ABS_MAX)] = {0};
+  struct input_absinfo abs;
+
+  memset(in, 0, sizeof(*in));
+  in->fd = fd;
+  in->type = type;
+
+  if (type != EVDEV_INPUT_POINTER || fd < 0) return;
+
+  // Absolute devices are scaled from their own range to the screen
+  if (ioctl(fd, EVIOCGABS(ABS_X), &abs) >= 0 && abs.maximum > abs.minimum) {
+    in->hor_min = abs.minimum;
+    in->hor_max = abs.maximum;
+  }
+  if (ioctl(fd, EVIOCGABS(ABS_Y), &abs) >= 0 && abs.maximum > abs.minimum) {
+    in->ver_min = abs.minimum;
+    in->ver_max = abs.maximum;
+  }
+  if (!in->ver_max) in->hor_max = 0;
+
+  if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key)), key) >= 0)
+    in->btn_touch = has_bit(key, BTN_TOUCH);
+  if (ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absbits)), absbits) >= 0)
+    in->mt = has_bit(absbits, ABS_MT_POSITION_X) &&
+             has_bit(absbits, ABS_MT_POSITION_Y);
+  // The slot selected before we opened it
+  if (in->mt && has_bit(absbits, ABS_MT_SLOT) &&
+      ioctl(fd, EVIOCGABS(ABS_MT_SLOT), &abs) >= 0)
+    in->slot = abs.value;
+
+  log_info("Input", "Pointer fd %d: %s%s X=%d..%d, Y=%d..%d", fd,
+           in->hor_max ? "absolute" : "relative", in->mt ? " multitouch" : "",
+           in->hor_min, in->hor_max, in->ver_min, in->ver_max);
+}
+
+static void queue(struct evdev_input *in, const struct evdev_input_sample *s,
+                  bool merge) {
+  if (merge && in->count) {
+    unsigned tail = in->head + in->count;
+    struct evdev_input_sample *newest = &in->ring[(tail - 1) % EVDEV_INPUT_RING];
+    const struct evdev_input_sample *before =
+        in->count > 1 ? &in->ring[(tail - 2) % EVDEV_INPUT_RING] : &in->last;
+
+    // Where a press or release happened is kept; only the motion after it
+    // is merged
+    if (newest->pressed == s->pressed && before->pressed == s->pressed) {
+      *newest = *s;
+      in->stats.coalesced++;
+      return;
+    }
+  }
+
+  if (in->count == EVDEV_INPUT_RING) {
+    // Keep the newest state; the oldest sample is the least useful
+    in->head = (in->head + 1) % EVDEV_INPUT_RING;
+    in->count--;
+    in->stats.overflows++;
+  }
+
+  in->ring[(in->head + in->count) % EVDEV_INPUT_RING] = *s;
+  in->count++;
+  in->stats.samples++;
+}
+
+static char key_to_ascii(uint16_t code, bool shift) {
+  static const char shifted_digits[] = {'!', '@', '#', '$', '%',
+                                        '^', '&', '*', '('};
+  char ch;
+
+  if (code >= KEY_1 && code <= KEY_9)
+    return shift ? shifted_digits[code - KEY_1] : (char)('1' + code - KEY_1);
+  if (code == KEY_0) return shift ? ')' : '0';
+
+  // Linux key codes are not in alphabetical order
+  switch (code) {
+  case KEY_A: ch = 'a'; break;
+  case KEY_B: ch = 'b'; break;
+  case KEY_C: ch = 'c'; break;
+  case KEY_D: ch = 'd'; break;
+  case KEY_E: ch = 'e'; break;
+  case KEY_F: ch = 'f'; break;
+  case KEY_G: ch = 'g'; break;
+  case KEY_H: ch = 'h'; break;
+  case KEY_I: ch = 'i'; break;
+  case KEY_J: ch = 'j'; break;
+  case KEY_K: ch = 'k'; break;
+  case KEY_L: ch = 'l'; break;
+  case KEY_M: ch = 'm'; break;
+  case KEY_N: ch = 'n'; break;
+  case KEY_O: ch = 'o'; break;
+  case KEY_P: ch = 'p'; break;
+  case KEY_Q: ch = 'q'; break;
+  case KEY_R: ch = 'r'; break;
+  case KEY_S: ch = 's'; break;
+  case KEY_T: ch = 't'; break;
+  case KEY_U: ch = 'u'; break;
+  case KEY_V: ch = 'v'; break;
+  case KEY_W: ch = 'w'; break;
+  case KEY_X: ch = 'x'; break;
+  case KEY_Y: ch = 'y'; break;
+  case KEY_Z: ch = 'z'; break;
+
+  case KEY_GRAVE:      return shift ? '~' : '`';
+  case KEY_MINUS:      return shift ? '_' : '-';
+  case KEY_EQUAL:      return shift ? '+' : '=';
+  case KEY_LEFTBRACE:  return shift ? '{' : '[';
+  case KEY_RIGHTBRACE: return shift ? '}' : ']';
+  case KEY_BACKSLASH:  return shift ? '|' : '\\';
+  case KEY_SEMICOLON:  return shift ? ':' : ';';
+  case KEY_APOSTROPHE: return shift ? '"' : '\'';
+  case KEY_COMMA:      return shift ? '<' : ',';
+  case KEY_DOT:        return shift ? '>' : '.';
+  case KEY_SLASH:      return shift ? '?' : '/';
+  case KEY_SPACE:      return ' ';
+  case KEY_KPASTERISK: return '*';
+  case KEY_KPDOT:      return '.';
+  case KEY_KPMINUS:    return '-';
+  case KEY_KPPLUS:     return '+';
+  case KEY_KPEQUAL:    return '=';
+  default:             return 0;
+  }
+
+  return shift ? (char)(ch - 'a' + 'A') : ch;
+}
+
+static uint32_t key_to_lv(uint16_t code, bool shift) {
+  switch (code) {
+  case KEY_BACKSPACE: return LV_KEY_BACKSPACE;
+  case KEY_ENTER:
+  case KEY_KPENTER:   return LV_KEY_ENTER;
+  case KEY_UP:        return LV_KEY_UP;
+  case KEY_DOWN:      return LV_KEY_DOWN;
+  case KEY_LEFT:      return LV_KEY_LEFT;
+  case KEY_RIGHT:     return LV_KEY_RIGHT;
+  case KEY_TAB:       return shift ? LV_KEY_PREV : LV_KEY_NEXT;
+  case KEY_ESC:       return LV_KEY_ESC;
+  case KEY_DELETE:    return LV_KEY_DEL;
+  default:            return (uint32_t)(uint8_t)key_to_ascii(code, shift);
+  }
+}
+
+static void decode_key(struct evdev_input *in, const struct input_event *ev) {
+  if (ev->code == KEY_LEFTSHIFT || ev->code == KEY_RIGHTSHIFT) {
+    in->shift = ev->value != 0;
+    return;
+  }
+  // Auto-repeat is LVGL's job
+  if (ev->value == 2) return;
+
+  uint32_t key = key_to_lv(ev->code, in->shift);
+  if (!key) return;
+
+  struct evdev_input_sample s = {.key = key, .pressed = ev->value != 0};
+  queue(in, &s, false);
+  log_debug("Input", "Key %u -> %u %s", ev->code, key,
+            s.pressed ? "pressed" : "released");
+}
+
+static void decode_pointer(struct evdev_input *in,
+                           const struct input_event *ev) {
+  switch (ev->type) {
+  case EV_REL:
+    // Relative motion only drives the pointer when there are no absolute
+    // axes, so a combined device does not fight itself
+    if (in->hor_max) break;
+    if (ev->code == REL_X)
+      in->x += ev->value;
+    else if (ev->code == REL_Y)
+      in->y += ev->value;
+    break;
+  case EV_ABS:
+    switch (ev->code) {
+    case ABS_X:
+      if (!in->mt) in->x = ev->value;
+      break;
+    case ABS_Y:
+      if (!in->mt) in->y = ev->value;
+      break;
+    case ABS_MT_SLOT:
+      in->slot = ev->value;
+      break;
+    // A second finger neither moves nor releases the pointer
+    case ABS_MT_POSITION_X:
+      if (in->slot == 0) in->x = ev->value;
+      break;
+    case ABS_MT_POSITION_Y:
+      if (in->slot == 0) in->y = ev->value;
+      break;
+    case ABS_MT_TRACKING_ID:
+      if (in->slot == 0 && !in->btn_touch) in->pressed = ev->value >= 0;
+      break;
+    default:
+      break;
+    }
+    break;
+  case EV_KEY:
+    if (ev->code == BTN_MOUSE || ev->code == BTN_TOUCH)
+      in->pressed = ev->value != 0;
+    break;
+  case EV_SYN:
+    if (ev->code == SYN_REPORT) {
+      struct evdev_input_sample s = {
+          .x = in->x, .y = in->y, .pressed = in->pressed};
+      queue(in, &s, true);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+unsigned evdev_input_ready(struct evdev_input *in) {
+  struct input_event ev[EVDEV_READ_BATCH];
+  uint64_t before = in->stats.samples + in->stats.coalesced;
+  ssize_t n;
+
+  if (in->fd < 0 || in->gone) return 0;
+
+  while ((n = read(in->fd, ev, sizeof(ev))) > 0) {
+    size_t count = (size_t)n / sizeof(ev[0]);
+
+    for (size_t i = 0; i < count; i++) {
+      in->stats.events++;
+
+      // The kernel queue overflowed: the state is only known again at the
+      // next report
+      if (ev[i].type == EV_SYN && ev[i].code == SYN_DROPPED) {
+        in->dropped = true;
+        in->stats.overflows++;
+        continue;
+      }
+      if (in->dropped) {
+        if (ev[i].type == EV_SYN && ev[i].code == SYN_REPORT)
+          in->dropped = false;
+        continue;
+      }
+
+      if (in->type == EVDEV_INPUT_KEYPAD) {
+        if (ev[i].type == EV_KEY) decode_key(in, &ev[i]);
+      } else {
+        decode_pointer(in, &ev[i]);
+      }
+    }
+  }
+  if ((n < 0 && errno == ENODEV) || n == 0) {
+    // Unplugged (or, for a pipe standing in for a device, the writer
+    // closed it): the fd only reports errors from now on
+    in->gone = true;
+  } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+    log_warn("Input", "Read from fd %d failed: %d", in->fd, errno);
+  }
+
+  return (unsigned)(in->stats.samples + in->stats.coalesced - before);
+}
+
+void evdev_input_flush(struct evdev_input *in) {
+  in->head = 0;
+  in->count = 0;
+  in->last.pressed = false;
+}
+
+static lv_coord_t scale(int32_t v, int32_t min, int32_t max, lv_coord_t res) {
+  int64_t out = max ? ((int64_t)v - min) * (res - 1) / (max - min) : v;
+
+  if (out < 0) return 0;
+  if (out >= res) return res - 1;
+  return (lv_coord_t)out;
+}
+
+void evdev_input_read(struct evdev_input *in, lv_indev_drv_t *drv,
+                      lv_indev_data_t *data) {
+  if (in->count) {
+    in->last = in->ring[in->head];
+    in->head = (in->head + 1) % EVDEV_INPUT_RING;
+    in->count--;
+  }
+  data->continue_reading = in->count > 0;
+  data->state = in->last.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+
+  if (in->type == EVDEV_INPUT_KEYPAD) {
+    data->key = in->last.key;
+    return;
+  }
+
+  data->point.x = scale(in->last.x, in->hor_min, in->hor_max,
+                        drv->disp->driver->hor_res);
+  data->point.y = scale(in->last.y, in->ver_min, in->ver_max,
+                        drv->disp->driver->ver_res);
+
+  // A mouse pushed past the edge moves back from the edge
+  if (!in->hor_max && !in->count) {
+    in->x = data->point.x;
+    in->y = data->point.y;
+  }
+}
@@ -0,0 +1,97 @@
+#ifndef EVDEV_INPUT_H
+#define EVDEV_INPUT_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Samples queued per device between two LVGL reads
+#define EVDEV_INPUT_RING 32
+
+enum evdev_input_type {
+  EVDEV_INPUT_POINTER, // Touchscreen, tablet or mouse
+  EVDEV_INPUT_KEYPAD,  // Keyboard
+  EVDEV_INPUT_TYPES
+};
+
+// One decoded input report
+struct evdev_input_sample {
+  int32_t x; // Raw device coordinates (pointer)
+  int32_t y;
+  uint32_t key; // LVGL key or character (keypad)
+  bool pressed;
+};
+
+struct evdev_input_stats {
+  uint64_t events;    // Kernel events decoded
+  uint64_t samples;   // Samples queued
+  uint64_t coalesced; // Motion merged into a queued sample
+  uint64_t overflows; // Samples lost to a full ring or SYN_DROPPED
+};
+
+/**
+ * Event decoder of one evdev device.
+ *
+ * When its fd is readable, evdev_input_ready() drains it and decodes the
+ * kernel events into samples: one per SYN_REPORT for a pointer, one per
+ * key press or release for a keypad. Consecutive pointer samples with the
+ * same button state that LVGL has not read yet are merged into the newest
+ * one, so a burst of motion costs a single read, while presses and
+ * releases are never merged away. The indev read_cb hands the queue to
+ * LVGL with evdev_input_read(). Both run on the UI thread.
+ */
+struct evdev_input {
+  int fd;
+  enum evdev_input_type type;
+  // Axis ranges reported by the device; hor_max 0 means relative motion
+  int32_t hor_min;
+  int32_t hor_max;
+  int32_t ver_min;
+  int32_t ver_max;
+
+  // Multitouch: only the contact in slot 0 moves the pointer, and with
+  // BTN_TOUCH the press follows that instead of the tracking ids
+  bool mt;        // Reports ABS_MT_POSITION_*; ABS_X/ABS_Y are ignored
+  bool btn_touch; // Reports BTN_TOUCH
+  int32_t slot;   // Slot the ABS_MT_* events are for
+
+  // Decoder state
+  int32_t x;
+  int32_t y;
+  bool pressed;
+  bool shift;
+  bool dropped; // Skipping to the next SYN_REPORT after SYN_DROPPED
+  bool gone;    // The device was unplugged (ENODEV or end of file)
+
+  struct evdev_input_sample ring[EVDEV_INPUT_RING];
+  unsigned head; // Oldest sample
+  unsigned count;
+  struct evdev_input_sample last; // Reported while the ring is empty
+
+  struct evdev_input_stats stats;
+};
+
+/**
+ * Start decoding an open, non-blocking evdev fd (not taken over: the
+ * caller closes it)
+ */
+void evdev_input_init(struct evdev_input *in, int fd,
+                      enum evdev_input_type type);
+
+/**
+ * Read everything the fd has and queue the decoded samples
+ * @return Number of samples queued or merged (0: nothing for LVGL)
+ */
+unsigned evdev_input_ready(struct evdev_input *in);
+
+// Drop the queued samples; reads as released until the next one
+void evdev_input_flush(struct evdev_input *in);
+
+/**
+ * read_cb body: the oldest queued sample, or the last state if none. Asks
+ * LVGL to read again while samples remain.
+ */
+void evdev_input_read(struct evdev_input *in, lv_indev_drv_t *drv,
+                      lv_indev_data_t *data);
+
+#endif // EVDEV_INPUT_H
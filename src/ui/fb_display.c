@@ -0,0 +1,371 @@
+#include "fb_display.h"
+#include "logger.h"
+#include "lv_drivers/display/fbdev.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#endif
+
+// Flush times are logged once per this many frames
+#define FB_STATS_FRAMES 300
+// Areas remembered per frame for the page sync; beyond that the whole
+// page is copied
+#define FB_MAX_AREAS 32
+// Height of the partial buffers in the fallback
+#define FB_PARTIAL_LINES 100
+
+static struct {
+  char dev[64];
+  bool flipping;
+  int fd;
+  uint8_t *fbp;
+  size_t fb_size;
+#ifdef __linux__
+  struct fb_var_screeninfo vinfo;
+#endif
+  unsigned xres;
+  unsigned yres;
+  size_t line_length;
+  size_t page_size;
+  unsigned back; // Page LVGL renders into
+  bool vsync;
+  bool pan_failed;
+
+  // Areas LVGL redrew into the back page this frame
+  lv_area_t areas[FB_MAX_AREAS];
+  unsigned n_areas;
+  bool overflow;
+
+  lv_disp_draw_buf_t draw_buf;
+  lv_color_t *partial[2];
+  lv_color_t *mem; // Headless: the screen in memory
+
+  uint64_t frame_us; // Flush time of the frame so far
+  uint64_t win_us;
+  uint32_t win_max;
+  unsigned win_frames;
+  struct fb_display_stats stats;
+} g_fb = {.fd = -1};
+
+static uint64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint32_t area_pixels(const lv_area_t *a) {
+  return (uint32_t)lv_area_get_width(a) * (uint32_t)lv_area_get_height(a);
+}
+
+static void frame_flushed(uint64_t start, bool last) {
+  g_fb.frame_us += now_us() - start;
+  if (!last) return;
+
+  uint32_t us = (uint32_t)g_fb.frame_us;
+  g_fb.frame_us = 0;
+
+  g_fb.stats.frames++;
+  g_fb.stats.flush_us += us;
+  if (us > g_fb.stats.flush_max_us) g_fb.stats.flush_max_us = us;
+
+  g_fb.win_us += us;
+  if (us > g_fb.win_max) g_fb.win_max = us;
+  if (++g_fb.win_frames < FB_STATS_FRAMES) return;
+
+  log_info("Display", "%s: flush avg %u us, max %u us over %u frames",
+           g_fb.flipping ? "page flip" : g_fb.mem ? "memory" : "partial",
+           (unsigned)(g_fb.win_us / g_fb.win_frames), g_fb.win_max,
+           g_fb.win_frames);
+  g_fb.win_us = 0;
+  g_fb.win_max = 0;
+  g_fb.win_frames = 0;
+}
+
+static void partial_flush(lv_disp_drv_t *drv, const lv_area_t *area,
+                          lv_color_t *color_p) {
+  uint64_t start = now_us();
+  bool last = lv_disp_flush_is_last(drv);
+
+  // Reports ready itself
+  fbdev_flush(drv, area, color_p);
+  g_fb.stats.pixels += area_pixels(area);
+  frame_flushed(start, last);
+}
+
+// Headless: the same copy as to a framebuffer, into memory
+static void memory_flush(lv_disp_drv_t *drv, const lv_area_t *area,
+                         lv_color_t *color_p) {
+  uint64_t start = now_us();
+  bool last = lv_disp_flush_is_last(drv);
+  lv_coord_t w = lv_area_get_width(area);
+
+  for (lv_coord_t y = area->y1; y <= area->y2; y++) {
+    memcpy(g_fb.mem + (size_t)y * g_fb.xres + area->x1, color_p,
+           (size_t)w * sizeof(lv_color_t));
+    color_p += w;
+  }
+  g_fb.stats.pixels += area_pixels(area);
+  frame_flushed(start, last);
+  lv_disp_flush_ready(drv);
+}
+
+#ifdef __linux__
+static int show_page(unsigned page) {
+  g_fb.vinfo.xoffset = 0;
+  g_fb.vinfo.yoffset = page * g_fb.yres;
+  if (ioctl(g_fb.fd, FBIOPAN_DISPLAY, &g_fb.vinfo) != 0) return errno;
+
+  // The old page is drawn into next, so it must be off the panel first
+  if (g_fb.vsync) {
+    uint32_t crtc = 0;
+    if (ioctl(g_fb.fd, FBIO_WAITFORVSYNC, &crtc) != 0) g_fb.vsync = false;
+  }
+  return 0;
+}
+
+// Bring the new back page up to date with the one just shown
+static void sync_pages(unsigned from, unsigned to) {
+  const uint8_t *src = g_fb.fbp + from * g_fb.page_size;
+  uint8_t *dst = g_fb.fbp + to * g_fb.page_size;
+  size_t bpp = LV_COLOR_DEPTH / 8;
+
+  if (g_fb.overflow) {
+    memcpy(dst, src, g_fb.page_size);
+    g_fb.stats.pixels += (uint64_t)g_fb.xres * g_fb.yres;
+    return;
+  }
+
+  for (unsigned i = 0; i < g_fb.n_areas; i++) {
+    const lv_area_t *a = &g_fb.areas[i];
+    size_t off = (size_t)a->y1 * g_fb.line_length + (size_t)a->x1 * bpp;
+    size_t len = (size_t)lv_area_get_width(a) * bpp;
+
+    for (lv_coord_t y = a->y1; y <= a->y2; y++) {
+      memcpy(dst + off, src + off, len);
+      off += g_fb.line_length;
+    }
+    g_fb.stats.pixels += area_pixels(a);
+  }
+}
+
+static void flip_flush(lv_disp_drv_t *drv, const lv_area_t *area,
+                       lv_color_t *color_p) {
+  uint64_t start = now_us();
+  bool last = lv_disp_flush_is_last(drv);
+  (void)color_p; // Already in the back page
+
+  if (g_fb.n_areas < FB_MAX_AREAS)
+    g_fb.areas[g_fb.n_areas++] = *area;
+  else
+    g_fb.overflow = true;
+
+  if (last) {
+    unsigned shown = g_fb.back;
+    int err = show_page(shown);
+
+    if (err && !g_fb.pan_failed) {
+      log_warn("Display", "Pan to page %u failed: %d", shown, err);
+      g_fb.pan_failed = true;
+    }
+    // LVGL draws the next frame into the other page
+    g_fb.back ^= 1;
+    sync_pages(shown, g_fb.back);
+    g_fb.n_areas = 0;
+    g_fb.overflow = false;
+  }
+
+  frame_flushed(start, last);
+  lv_disp_flush_ready(drv);
+}
+
+static int flip_open(const char *dev) {
+  struct fb_fix_screeninfo finfo;
+  struct fb_var_screeninfo *vinfo = &g_fb.vinfo;
+  int err = 0;
+
+  int fd = open(dev, O_RDWR);
+  if (fd < 0) return errno;
+
+  if (ioctl(fd, FBIOGET_VSCREENINFO, vinfo) != 0) {
+    err = errno;
+    goto out;
+  }
+
+  // LVGL renders into the pages, so they must be in its pixel format
+  if (vinfo->bits_per_pixel != LV_COLOR_DEPTH) {
+    log_warn("Display", "%s is %ubpp, LVGL renders %ubpp", dev,
+             vinfo->bits_per_pixel, LV_COLOR_DEPTH);
+    err = ENOTSUP;
+    goto out;
+  }
+
+  if (vinfo->yres_virtual < 2 * vinfo->yres) {
+    vinfo->yres_virtual = 2 * vinfo->yres;
+    vinfo->xoffset = 0;
+    vinfo->yoffset = 0;
+    if (ioctl(fd, FBIOPUT_VSCREENINFO, vinfo) != 0 ||
+        ioctl(fd, FBIOGET_VSCREENINFO, vinfo) != 0) {
+      err = errno;
+      goto out;
+    }
+  }
+
+  if (ioctl(fd, FBIOGET_FSCREENINFO, &finfo) != 0) {
+    err = errno;
+    goto out;
+  }
+
+  size_t page = (size_t)finfo.line_length * vinfo->yres;
+  if (vinfo->yres_virtual < 2 * vinfo->yres || finfo.smem_len < 2 * page) {
+    log_warn("Display", "%s has no room for a second page", dev);
+    err = ENOSPC;
+    goto out;
+  }
+  // Direct mode addresses the page as a packed hor_res x ver_res buffer
+  if (finfo.line_length != vinfo->xres * (LV_COLOR_DEPTH / 8)) {
+    log_warn("Display", "%s stride %u is padded", dev, finfo.line_length);
+    err = ENOTSUP;
+    goto out;
+  }
+
+  void *fbp = mmap(NULL, finfo.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+  if (fbp == MAP_FAILED) {
+    err = errno;
+    goto out;
+  }
+
+  g_fb.fd = fd;
+  g_fb.fbp = fbp;
+  g_fb.fb_size = finfo.smem_len;
+  g_fb.xres = vinfo->xres;
+  g_fb.yres = vinfo->yres;
+  g_fb.line_length = finfo.line_length;
+  g_fb.page_size = page;
+
+  // Both pages start out equal; LVGL's first frame covers the screen
+  memset(fbp, 0, 2 * page);
+  g_fb.back = 0;
+  g_fb.vsync = true;
+  err = show_page(1);
+  if (err) {
+    log_warn("Display", "%s cannot pan: %d", dev, err);
+    munmap(fbp, finfo.smem_len);
+    g_fb.fbp = NULL;
+    g_fb.fd = -1;
+    goto out;
+  }
+  return 0;
+
+out:
+  close(fd);
+  return err;
+}
+#endif
+
+int fb_display_init(lv_disp_drv_t *drv, const char *dev, bool flip,
+                    unsigned w, unsigned h, bool headless) {
+  if (!drv || !dev) return EINVAL;
+  snprintf(g_fb.dev, sizeof(g_fb.dev), "%s", dev);
+
+#ifdef __linux__
+  if (flip && flip_open(dev) == 0) {
+    uint32_t px = g_fb.xres * g_fb.yres;
+
+    lv_disp_draw_buf_init(&g_fb.draw_buf, g_fb.fbp, g_fb.fbp + g_fb.page_size,
+                          px);
+    drv->draw_buf = &g_fb.draw_buf;
+    drv->flush_cb = flip_flush;
+    drv->hor_res = (lv_coord_t)g_fb.xres;
+    drv->ver_res = (lv_coord_t)g_fb.yres;
+    drv->direct_mode = 1;
+
+    g_fb.flipping = true;
+    g_fb.stats.flipping = true;
+    g_fb.stats.vsync = g_fb.vsync;
+    log_info("Display", "%s: %ux%u, page flipping%s", dev, g_fb.xres,
+             g_fb.yres, g_fb.vsync ? " on vsync" : "");
+    return 0;
+  }
+#endif
+
+  uint32_t px = w * FB_PARTIAL_LINES;
+  for (int i = 0; i < 2; i++) {
+    if (!g_fb.partial[i]) g_fb.partial[i] = malloc(px * sizeof(lv_color_t));
+    if (!g_fb.partial[i]) return ENOMEM;
+  }
+
+  lv_disp_draw_buf_init(&g_fb.draw_buf, g_fb.partial[0], g_fb.partial[1], px);
+  drv->draw_buf = &g_fb.draw_buf;
+  drv->hor_res = (lv_coord_t)w;
+  drv->ver_res = (lv_coord_t)h;
+  g_fb.flipping = false;
+
+  if (access(dev, W_OK) != 0) {
+    int err = errno;
+
+    if (!headless) {
+      log_error("Display", "%s unavailable: %d", dev, err);
+      return err;
+    }
+    // A plain box running the latency benchmark: everything is rendered
+    // and copied as usual, only into memory
+    if (!g_fb.mem) g_fb.mem = calloc((size_t)w * h, sizeof(lv_color_t));
+    if (!g_fb.mem) return ENOMEM;
+    g_fb.xres = w;
+    g_fb.yres = h;
+    drv->flush_cb = memory_flush;
+
+    g_fb.stats.headless = true;
+    log_warn("Display", "%s unavailable, rendering %ux%u into memory", dev, w,
+             h);
+    return 0;
+  }
+
+  fbdev_init();
+  drv->flush_cb = partial_flush;
+  log_info("Display", "%s: %ux%u, partial buffers of %u lines%s", dev, w, h,
+           FB_PARTIAL_LINES, flip ? " (page flipping unavailable)" : "");
+  return 0;
+}
+
+unsigned fb_display_pages(void) { return g_fb.flipping ? 2 : 1; }
+
+int fb_display_blank(bool blank) {
+#ifdef __linux__
+  int fd = g_fb.fd >= 0 ? g_fb.fd : open(g_fb.dev, O_RDWR);
+  int err = 0;
+
+  if (fd < 0) return errno;
+  if (ioctl(fd, FBIOBLANK, blank ? FB_BLANK_POWERDOWN : FB_BLANK_UNBLANK) != 0)
+    err = errno;
+
+  // Some drivers reset the pan offset while powered down
+  if (!err && !blank && g_fb.flipping) {
+    g_fb.vinfo.yoffset = (g_fb.back ^ 1) * g_fb.yres;
+    ioctl(fd, FBIOPAN_DISPLAY, &g_fb.vinfo);
+  }
+
+  if (fd != g_fb.fd) close(fd);
+  if (err)
+    log_warn("Display", "%s failed: %d", blank ? "Blank" : "Unblank", err);
+  return err;
+#else
+  (void)blank;
+  return ENOTSUP;
+#endif
+}
+
+void fb_display_get_stats(struct fb_display_stats *stats) {
+  if (!stats) return;
+  *stats = g_fb.stats;
+  stats->vsync = g_fb.vsync;
+}
@@ -0,0 +1,50 @@
+#ifndef FB_DISPLAY_H
+#define FB_DISPLAY_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Flush timing of the framebuffer display
+struct fb_display_stats {
+  bool flipping;         // Page flipping, otherwise partial buffers
+  bool vsync;            // Flips wait for the vertical blank
+  bool headless;         // No framebuffer: frames are copied to memory
+  uint64_t frames;       // Refreshes completed
+  uint64_t flush_us;     // Time spent in flush_cb, all frames
+  uint32_t flush_max_us; // Longest frame flush
+  uint64_t pixels;       // Pixels copied by flush_cb
+};
+
+/**
+ * @brief Set up LVGL on the Linux framebuffer.
+ *        With page flipping, the framebuffer is made two screens tall and
+ *        LVGL renders straight into the hidden page (direct mode). A
+ *        refresh pans to that page (FBIOPAN_DISPLAY), waits for the
+ *        vertical blank (FBIO_WAITFORVSYNC, where supported) and copies the
+ *        areas it redrew to the page that is now hidden. Nothing is copied
+ *        from a render buffer and the panel never shows a half drawn frame.
+ *        If the driver cannot provide a second page, the pixel format does
+ *        not match LV_COLOR_DEPTH or panning fails, it falls back to the
+ *        lv_drivers fbdev driver with two partial buffers.
+ *
+ * @param drv      Driver to fill in (register it afterwards).
+ * @param dev      Framebuffer device, e.g. FBDEV_PATH.
+ * @param flip     Try page flipping.
+ * @param w,h      Resolution for the partial fallback.
+ * @param headless Without a writable dev, copy the partial buffers to
+ *                 memory instead of failing (latency benchmark).
+ * @return 0 on success, otherwise an errno.
+ */
+int fb_display_init(lv_disp_drv_t *drv, const char *dev, bool flip,
+                    unsigned w, unsigned h, bool headless);
+
+// Pages LVGL draws into (2 when flipping, else 1)
+unsigned fb_display_pages(void);
+
+// Power the panel down (FBIOBLANK) or back up; 0 or an errno
+int fb_display_blank(bool blank);
+
+void fb_display_get_stats(struct fb_display_stats *stats);
+
+#endif // FB_DISPLAY_H
@@ -0,0 +1,350 @@
+#include "input_hotplug.h"
+#include "baresip_manager.h"
+#include "logger.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define NLONGS(bits) ((bits) / BITS_PER_LONG + 1)
+
+static const char *const k_type_names[EVDEV_INPUT_TYPES] = {"pointer",
+                                                            "keypad"};
+
+struct input_device {
+  bool used;
+  char node[16]; // Name in the directory, e.g. "event3"
+  struct evdev_input in;
+};
+
+// What one LVGL indev sees of all devices of its type
+struct input_role {
+  struct input_device *current; // Read last; NULL once it is gone
+  unsigned next;                // First device asked next time
+  lv_point_t point;
+  uint32_t key;
+};
+
+static struct {
+  char dir[64];
+  input_hotplug_ready_h ready_h;
+  int inotify_fd;
+  struct input_device dev[INPUT_HOTPLUG_MAX];
+  struct input_role role[EVDEV_INPUT_TYPES];
+} g = {.inotify_fd = -1};
+
+static bool has_bit(const unsigned long *bits, unsigned bit) {
+  return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1;
+}
+
+// False for devices the UI has no use for (power button, lid, sensors)
+static bool classify(int fd, enum evdev_input_type *type) {
+  unsigned long ev[NLONGS(EV_MAX)] = {0};
+  unsigned long key[NLONGS(KEY_MAX)] = {0};
+  unsigned long abs[NLONGS(ABS_MAX)] = {0};
+  unsigned long rel[NLONGS(REL_MAX)] = {0};
+
+  if (ioctl(fd, EVIOCGBIT(0, sizeof(ev)), ev) < 0) return false;
+  if (has_bit(ev, EV_KEY)) ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key)), key);
+  if (has_bit(ev, EV_ABS)) ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs)), abs);
+  if (has_bit(ev, EV_REL)) ioctl(fd, EVIOCGBIT(EV_REL, sizeof(rel)), rel);
+
+  bool button = has_bit(key, BTN_TOUCH) || has_bit(key, BTN_LEFT);
+  bool abs_xy = (has_bit(abs, ABS_X) && has_bit(abs, ABS_Y)) ||
+                (has_bit(abs, ABS_MT_POSITION_X) &&
+                 has_bit(abs, ABS_MT_POSITION_Y));
+  bool rel_xy = has_bit(rel, REL_X) && has_bit(rel, REL_Y);
+
+  // Joysticks have axes too, but neither touch nor mouse buttons
+  if (button && (abs_xy || rel_xy)) {
+    *type = EVDEV_INPUT_POINTER;
+    return true;
+  }
+  if (has_bit(key, KEY_ENTER) &&
+      (has_bit(key, KEY_A) || has_bit(key, KEY_1) || has_bit(key, KEY_KP1))) {
+    *type = EVDEV_INPUT_KEYPAD;
+    return true;
+  }
+  return false;
+}
+
+static struct input_device *find(const char *node) {
+  for (int i = 0; i < INPUT_HOTPLUG_MAX; i++) {
+    if (g.dev[i].used && strcmp(g.dev[i].node, node) == 0) return &g.dev[i];
+  }
+  return NULL;
+}
+
+static void detach(struct input_device *d) {
+  struct input_role *r = &g.role[d->in.type];
+
+  baresip_manager_unwatch_fd(d->in.fd);
+  close(d->in.fd);
+
+  // Whatever was held down on it is released
+  if (r->current == d) r->current = NULL;
+
+  log_info("Input", "Detached %s (%llu events, %llu samples)", d->node,
+           (unsigned long long)d->in.stats.events,
+           (unsigned long long)d->in.stats.samples);
+  memset(d, 0, sizeof(*d));
+}
+
+static bool device_ready(void *arg) {
+  struct input_device *d = arg;
+  enum evdev_input_type type = d->in.type;
+  unsigned samples = evdev_input_ready(&d->in);
+
+  // Unplugged, and the directory may not have said so yet
+  if (d->in.gone) {
+    detach(d);
+    return g.ready_h(type);
+  }
+  return samples && g.ready_h(type);
+}
+
+static struct input_device *slot(void) {
+  for (int i = 0; i < INPUT_HOTPLUG_MAX; i++) {
+    if (!g.dev[i].used) return &g.dev[i];
+  }
+  return NULL;
+}
+
+// Decode and watch an open fd; closes it on failure
+static int attach_fd(struct input_device *d, const char *node, int fd,
+                     enum evdev_input_type type) {
+  evdev_input_init(&d->in, fd, type);
+  // A new mouse starts where the pointer is
+  if (type == EVDEV_INPUT_POINTER && !d->in.hor_max) {
+    d->in.x = d->in.last.x = g.role[type].point.x;
+    d->in.y = d->in.last.y = g.role[type].point.y;
+  }
+
+  int err = baresip_manager_watch_fd(fd, device_ready, d);
+  if (err) {
+    log_warn("Input", "Watching %s failed: %d", node, err);
+    close(fd);
+    memset(d, 0, sizeof(*d));
+    return err;
+  }
+  d->used = true;
+  snprintf(d->node, sizeof(d->node), "%s", node);
+  return 0;
+}
+
+// The new device, or NULL if it is not attached
+static struct input_device *attach(const char *node) {
+  struct input_device *d;
+  enum evdev_input_type type;
+  char path[96];
+  char name[64] = "";
+
+  if (strncmp(node, "event", 5) != 0 || find(node)) return NULL;
+
+  snprintf(path, sizeof(path), "%s/%s", g.dir, node);
+  d = slot();
+  if (!d) {
+    log_warn("Input", "No room for %s", path);
+    return NULL;
+  }
+
+  int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    // udev may not have set the permissions yet; IN_ATTRIB retries
+    if (errno != EACCES && errno != ENOENT)
+      log_warn("Input", "Opening %s failed: %d", path, errno);
+    return NULL;
+  }
+  if (!classify(fd, &type)) {
+    close(fd);
+    return NULL;
+  }
+  ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+
+  if (attach_fd(d, node, fd, type)) return NULL;
+
+  log_info("Input", "Attached %s (%s) as %s", path, name, k_type_names[type]);
+  return d;
+}
+
+static void scan(bool *changed) {
+  DIR *dir = opendir(g.dir);
+  struct dirent *ent;
+
+  if (!dir) {
+    log_warn("Input", "Cannot list %s: %d", g.dir, errno);
+    return;
+  }
+  while ((ent = readdir(dir))) {
+    struct input_device *d = attach(ent->d_name);
+    if (d && changed) changed[d->in.type] = true;
+  }
+  closedir(dir);
+}
+
+static bool inotify_ready(void *arg) {
+  char buf[4096]
+      __attribute__((aligned(__alignof__(struct inotify_event))));
+  bool changed[EVDEV_INPUT_TYPES] = {false};
+  bool run = false;
+  ssize_t n;
+  (void)arg;
+
+  while ((n = read(g.inotify_fd, buf, sizeof(buf))) > 0) {
+    const struct inotify_event *ev;
+
+    for (char *p = buf; p < buf + n; p += sizeof(*ev) + ev->len) {
+      ev = (const struct inotify_event *)p;
+
+      // Events were lost: whatever is there now is attached
+      if (ev->mask & IN_Q_OVERFLOW) {
+        scan(changed);
+        continue;
+      }
+      if (!ev->len) continue;
+
+      if (ev->mask & IN_DELETE) {
+        struct input_device *d = find(ev->name);
+        if (d) {
+          changed[d->in.type] = true;
+          detach(d);
+        }
+      } else if (ev->mask & (IN_CREATE | IN_ATTRIB)) {
+        struct input_device *d = attach(ev->name);
+        if (d) changed[d->in.type] = true;
+      }
+    }
+  }
+
+  for (int t = 0; t < EVDEV_INPUT_TYPES; t++) {
+    if (changed[t] && g.ready_h(t)) run = true;
+  }
+  return run;
+}
+
+int input_hotplug_init(const char *dir, input_hotplug_ready_h ready_h) {
+  int err = 0;
+
+  if (!dir || !ready_h) return EINVAL;
+  snprintf(g.dir, sizeof(g.dir), "%s", dir);
+  g.ready_h = ready_h;
+
+  // Follow the directory before listing it, so nothing plugged in
+  // meanwhile is missed
+  g.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (g.inotify_fd < 0)
+    err = errno;
+  else if (inotify_add_watch(g.inotify_fd, dir,
+                             IN_CREATE | IN_ATTRIB | IN_DELETE) < 0)
+    err = errno;
+  else
+    err = baresip_manager_watch_fd(g.inotify_fd, inotify_ready, NULL);
+
+  if (err) {
+    log_warn("Input", "Not following %s: %d", dir, err);
+    if (g.inotify_fd >= 0) close(g.inotify_fd);
+    g.inotify_fd = -1;
+  }
+
+  scan(NULL);
+  log_info("Input", "%u pointer and %u keypad devices%s",
+           input_hotplug_count(EVDEV_INPUT_POINTER),
+           input_hotplug_count(EVDEV_INPUT_KEYPAD),
+           err ? "" : ", following hotplug");
+  return err;
+}
+
+int input_hotplug_add_fd(int fd, enum evdev_input_type type,
+                         const char *name) {
+  struct input_device *d = slot();
+  int err = 0;
+
+  if (fd < 0) return EINVAL;
+  if (type >= EVDEV_INPUT_TYPES || !name)
+    err = EINVAL;
+  else if (!d)
+    err = ENOSPC;
+  if (err) {
+    close(fd);
+    return err;
+  }
+
+  err = attach_fd(d, name, fd, type);
+  if (err) return err;
+
+  log_info("Input", "Attached %s as %s", name, k_type_names[type]);
+  return 0;
+}
+
+void input_hotplug_read(enum evdev_input_type type, lv_indev_drv_t *drv,
+                        lv_indev_data_t *data) {
+  struct input_role *r = &g.role[type];
+  struct input_device *d = NULL;
+  unsigned start = r->next;
+  bool more = false;
+
+  // Devices with samples take turns, so a busy one cannot starve the rest
+  for (unsigned i = 0; i < INPUT_HOTPLUG_MAX && !more; i++) {
+    unsigned idx = (start + i) % INPUT_HOTPLUG_MAX;
+    struct input_device *c = &g.dev[idx];
+
+    if (!c->used || c->in.type != type || !c->in.count) continue;
+    if (d) {
+      more = true;
+    } else {
+      d = c;
+      r->next = idx + 1;
+    }
+  }
+  if (d)
+    r->current = d;
+  else
+    d = r->current;
+
+  if (!d) {
+    // Nothing attached, or the device in use was unplugged
+    data->point = r->point;
+    data->key = r->key;
+    data->state = LV_INDEV_STATE_REL;
+    data->continue_reading = false;
+    return;
+  }
+
+  evdev_input_read(&d->in, drv, data);
+  if (more) data->continue_reading = true;
+  r->point = data->point;
+  r->key = data->key;
+}
+
+void input_hotplug_flush(enum evdev_input_type type) {
+  for (int i = 0; i < INPUT_HOTPLUG_MAX; i++) {
+    if (g.dev[i].used && g.dev[i].in.type == type)
+      evdev_input_flush(&g.dev[i].in);
+  }
+}
+
+unsigned input_hotplug_count(enum evdev_input_type type) {
+  unsigned n = 0;
+
+  for (int i = 0; i < INPUT_HOTPLUG_MAX; i++) {
+    if (g.dev[i].used && g.dev[i].in.type == type) n++;
+  }
+  return n;
+}
+
+void input_hotplug_close(void) {
+  for (int i = 0; i < INPUT_HOTPLUG_MAX; i++) {
+    if (g.dev[i].used) detach(&g.dev[i]);
+  }
+  if (g.inotify_fd >= 0) {
+    baresip_manager_unwatch_fd(g.inotify_fd);
+    close(g.inotify_fd);
+    g.inotify_fd = -1;
+  }
+}
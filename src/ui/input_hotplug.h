@@ -0,0 +1,61 @@
+#ifndef INPUT_HOTPLUG_H
+#define INPUT_HOTPLUG_H
+
+#include "evdev_input.h"
+#include "lvgl.h"
+#include <stdbool.h>
+
+// Input devices attached at once
+#define INPUT_HOTPLUG_MAX 6
+
+/**
+ * Called on the UI thread when devices of `type` have new samples, or one
+ * was attached or detached. Returns whether the UI loop should run now.
+ */
+typedef bool (*input_hotplug_ready_h)(enum evdev_input_type type);
+
+/**
+ * @brief Attach the input devices in dir and follow it for new ones.
+ *        Every evdev node is classified by what it reports: touchscreens,
+ *        tablets and mice drive the pointer indev, anything with letter or
+ *        digit keys the keypad indev. Devices are watched with
+ *        baresip_manager_watch_fd(), and an inotify watch on dir attaches
+ *        new ones and detaches those that are removed, so none of it blocks
+ *        the loop. Call before baresip_manager_loop().
+ *
+ * @param dir     Usually "/dev/input".
+ * @param ready_h Told about new samples (required).
+ * @return 0 when dir is followed, otherwise an errno (the devices present
+ *         are attached either way).
+ */
+int input_hotplug_init(const char *dir, input_hotplug_ready_h ready_h);
+
+/**
+ * Attach an fd that is not in the directory, e.g. the read end of a pipe
+ * that synthetic events are written to. It is decoded like a device of
+ * `type` (EV_ABS values are taken as screen coordinates) and closed when
+ * detached.
+ * @return 0 or an errno (the fd is closed on failure)
+ */
+int input_hotplug_add_fd(int fd, enum evdev_input_type type,
+                         const char *name);
+
+/**
+ * read_cb body of the indev for `type`: the next sample of any device of
+ * that type, or the last state if none has one. Reports released once the
+ * device that was in use is gone.
+ */
+void input_hotplug_read(enum evdev_input_type type, lv_indev_drv_t *drv,
+                        lv_indev_data_t *data);
+
+// Drop the samples queued on devices of `type` (e.g. the key press that
+// woke the screen)
+void input_hotplug_flush(enum evdev_input_type type);
+
+// Devices of `type` attached right now
+unsigned input_hotplug_count(enum evdev_input_type type);
+
+// Detach everything and stop following dir
+void input_hotplug_close(void);
+
+#endif // INPUT_HOTPLUG_H
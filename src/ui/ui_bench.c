@@ -0,0 +1,507 @@
+#include "ui_bench.h"
+#include "applet_manager.h"
+#include "baresip_manager.h"
+#include "disp_hook.h"
+#include "input_hotplug.h"
+#include "logger.h"
+#include "lvgl.h"
+#include "video_timing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+// A response that has not been flushed by then counts as missing
+#define BENCH_FRAME_TIMEOUT_MS 1000
+// The UI has settled after this long without a frame (a few refresh
+// periods)
+#define BENCH_QUIET_MS 100
+// Settling after a screen change (load animation)
+#define BENCH_SETTLE_MS 500
+// Longest wait for the UI to settle
+#define BENCH_SETTLE_MAX_MS 5000
+// Longest wait for the UI thread to serve a request
+#define BENCH_REQUEST_MS 5000
+// Finger travel per report while dragging a list (px)
+#define BENCH_SCROLL_STEP 12
+
+enum bench_row {
+  BENCH_DIAL_PRESS,
+  BENCH_DIAL_RELEASE,
+  BENCH_SCROLL,
+  BENCH_LAUNCH,
+  BENCH_ROWS,
+  BENCH_NONE = BENCH_ROWS // Setup, not measured
+};
+
+static const char *const k_row_names[BENCH_ROWS] = {
+    "dialer press", "dialer release", "list scroll", "applet launch"};
+
+// Work only the UI thread may do
+enum bench_req {
+  REQ_NONE,
+  REQ_LAUNCH, // Launch applet `arg`
+  REQ_FIND,   // Area of the button labelled `arg`, scrolled into view
+  REQ_LIST,   // Area of the longest scrollable list, scrolled to the top
+  REQ_QUIT,
+};
+
+static struct {
+  int running; // atomic
+  unsigned iterations;
+  pthread_t thread;
+  int fd; // Write end of the synthetic pointer
+
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+
+  // Request to the UI thread (lock)
+  enum bench_req req;
+  char arg[32];
+  bool done;
+  int err;
+  lv_area_t area;
+
+  // Start of the refresh in progress (UI thread)
+  uint64_t refr_start;
+
+  // Frames (lock)
+  uint64_t frame_end;  // End of the last frame's flush
+  uint64_t watch_from; // Report being measured
+  uint64_t response;   // End of the first frame started after it
+
+  // Bench thread only
+  struct video_hist hist[BENCH_ROWS];
+  uint32_t missed[BENCH_ROWS];
+} g = {.fd = -1};
+
+static void bench_refresh(void *arg) {
+  (void)arg;
+  g.refr_start = video_timing_now();
+}
+
+static void bench_flushed(const lv_area_t *area, uint64_t usec, bool last,
+                          void *arg) {
+  (void)area;
+  (void)usec;
+  (void)arg;
+  if (!last) return;
+
+  uint64_t now = video_timing_now();
+  pthread_mutex_lock(&g.lock);
+  g.frame_end = now;
+  if (g.watch_from && !g.response && g.refr_start >= g.watch_from)
+    g.response = now;
+  pthread_cond_broadcast(&g.cond);
+  pthread_mutex_unlock(&g.lock);
+}
+
+static const struct disp_hook k_hook = {
+    .refresh_begin = bench_refresh,
+    .flushed = bench_flushed,
+};
+
+// Wait on the condition until `until` (usec, monotonic); lock held
+static void wait_until(uint64_t until) {
+  struct timespec ts = {.tv_sec = (time_t)(until / 1000000),
+                        .tv_nsec = (long)(until % 1000000) * 1000};
+  pthread_cond_timedwait(&g.cond, &g.lock, &ts);
+}
+
+// --- UI thread --------------------------------------------------------------
+
+static bool visible(lv_obj_t *obj) {
+  for (; obj; obj = lv_obj_get_parent(obj)) {
+    if (lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN)) return false;
+  }
+  return true;
+}
+
+// First button (depth first) with a label reading `text`
+static lv_obj_t *find_button(lv_obj_t *obj, const char *text) {
+  if (lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN)) return NULL;
+
+  if (lv_obj_check_type(obj, &lv_label_class) &&
+      strcmp(lv_label_get_text(obj), text) == 0) {
+    for (lv_obj_t *p = obj; p; p = lv_obj_get_parent(p)) {
+      if (lv_obj_check_type(p, &lv_btn_class)) return p;
+    }
+  }
+
+  uint32_t n = lv_obj_get_child_cnt(obj);
+  for (uint32_t i = 0; i < n; i++) {
+    lv_obj_t *btn = find_button(lv_obj_get_child(obj, i), text);
+    if (btn) return btn;
+  }
+  return NULL;
+}
+
+// The visible object that scrolls furthest vertically
+static void find_list(lv_obj_t *obj, lv_obj_t **best, lv_coord_t *range) {
+  if (lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN)) return;
+
+  if (lv_obj_has_flag(obj, LV_OBJ_FLAG_SCROLLABLE)) {
+    lv_coord_t r = lv_obj_get_scroll_top(obj) + lv_obj_get_scroll_bottom(obj);
+    if (r > *range) {
+      *best = obj;
+      *range = r;
+    }
+  }
+
+  uint32_t n = lv_obj_get_child_cnt(obj);
+  for (uint32_t i = 0; i < n; i++) {
+    find_list(lv_obj_get_child(obj, i), best, range);
+  }
+}
+
+static int serve(enum bench_req req, const char *arg, lv_area_t *area) {
+  lv_obj_t *scr = lv_scr_act();
+  lv_obj_t *obj = NULL;
+  lv_coord_t range = 0;
+
+  switch (req) {
+  case REQ_LAUNCH:
+    return applet_manager_launch(arg) == 0 ? 0 : ENOENT;
+
+  case REQ_FIND:
+    lv_obj_update_layout(scr);
+    obj = find_button(scr, arg);
+    if (!obj || !visible(obj)) return ENOENT;
+    lv_obj_scroll_to_view_recursive(obj, LV_ANIM_OFF);
+    lv_obj_update_layout(scr);
+    lv_obj_get_coords(obj, area);
+    return 0;
+
+  case REQ_LIST:
+    lv_obj_update_layout(scr);
+    find_list(scr, &obj, &range);
+    if (!obj) return ENOENT;
+    lv_obj_scroll_to_y(obj, 0, LV_ANIM_OFF);
+    lv_obj_update_layout(scr);
+    lv_obj_get_coords(obj, area);
+    return 0;
+
+  case REQ_QUIT:
+    disp_hook_remove(&k_hook);
+    baresip_manager_quit();
+    return 0;
+
+  default:
+    return EINVAL;
+  }
+}
+
+void ui_bench_update(void) {
+  enum bench_req req;
+  char arg[sizeof(g.arg)];
+  lv_area_t area = {0};
+
+  if (!ui_bench_running()) return;
+
+  pthread_mutex_lock(&g.lock);
+  req = g.req;
+  memcpy(arg, g.arg, sizeof(arg));
+  g.req = REQ_NONE;
+  pthread_mutex_unlock(&g.lock);
+  if (req == REQ_NONE) return;
+
+  int err = serve(req, arg, &area);
+
+  pthread_mutex_lock(&g.lock);
+  g.err = err;
+  g.area = area;
+  g.done = true;
+  pthread_cond_broadcast(&g.cond);
+  pthread_mutex_unlock(&g.lock);
+}
+
+// --- Benchmark thread -------------------------------------------------------
+
+static int request(enum bench_req req, const char *arg, lv_area_t *area) {
+  int err;
+
+  pthread_mutex_lock(&g.lock);
+  g.req = req;
+  snprintf(g.arg, sizeof(g.arg), "%s", arg ? arg : "");
+  g.done = false;
+  pthread_mutex_unlock(&g.lock);
+
+  baresip_manager_wakeup();
+
+  uint64_t until = video_timing_now() + BENCH_REQUEST_MS * 1000ull;
+  pthread_mutex_lock(&g.lock);
+  while (!g.done && video_timing_now() < until) wait_until(until);
+  if (g.done) {
+    err = g.err;
+    if (area) *area = g.area;
+  } else {
+    g.req = REQ_NONE;
+    err = ETIMEDOUT;
+  }
+  pthread_mutex_unlock(&g.lock);
+  return err;
+}
+
+// Until no frame has been flushed for quiet_ms
+static bool settle(unsigned quiet_ms) {
+  uint64_t start = video_timing_now();
+  uint64_t quiet = quiet_ms * 1000ull;
+  bool settled = false;
+
+  pthread_mutex_lock(&g.lock);
+  for (;;) {
+    uint64_t now = video_timing_now();
+    uint64_t last = g.frame_end > start ? g.frame_end : start;
+
+    if (now - last >= quiet) {
+      settled = true;
+      break;
+    }
+    if (now - start >= BENCH_SETTLE_MAX_MS * 1000ull) break;
+    wait_until(last + quiet);
+  }
+  pthread_mutex_unlock(&g.lock);
+
+  if (!settled) log_warn("Bench", "UI did not settle");
+  return settled;
+}
+
+/**
+ * Write one pointer report (position unless x < 0; touch down or up unless
+ * touch < 0) and wait for the frame that answers it. Measured in `row`.
+ */
+static void report(enum bench_row row, int x, int y, int touch) {
+  struct input_event ev[4];
+  struct timeval tv;
+  size_t n = 0;
+
+  memset(ev, 0, sizeof(ev));
+  if (x >= 0) {
+    ev[n].type = EV_ABS;
+    ev[n].code = ABS_X;
+    ev[n++].value = x;
+    ev[n].type = EV_ABS;
+    ev[n].code = ABS_Y;
+    ev[n++].value = y;
+  }
+  if (touch >= 0) {
+    ev[n].type = EV_KEY;
+    ev[n].code = BTN_TOUCH;
+    ev[n++].value = touch;
+  }
+  ev[n].type = EV_SYN;
+  ev[n++].code = SYN_REPORT;
+
+  gettimeofday(&tv, NULL);
+  for (size_t i = 0; i < n; i++) ev[i].time = tv;
+
+  pthread_mutex_lock(&g.lock);
+  uint64_t start = video_timing_now();
+  g.watch_from = start;
+  g.response = 0;
+  pthread_mutex_unlock(&g.lock);
+
+  if (write(g.fd, ev, n * sizeof(ev[0])) != (ssize_t)(n * sizeof(ev[0]))) {
+    log_warn("Bench", "Writing events failed: %d", errno);
+    return;
+  }
+
+  uint64_t until = start + BENCH_FRAME_TIMEOUT_MS * 1000ull;
+  pthread_mutex_lock(&g.lock);
+  while (!g.response && video_timing_now() < until) wait_until(until);
+  uint64_t response = g.response;
+  g.watch_from = 0;
+  pthread_mutex_unlock(&g.lock);
+
+  if (row == BENCH_NONE) return;
+  if (response)
+    video_hist_add(&g.hist[row], response - start);
+  else
+    g.missed[row]++;
+}
+
+static int center_x(const lv_area_t *a) { return (a->x1 + a->x2) / 2; }
+static int center_y(const lv_area_t *a) { return (a->y1 + a->y2) / 2; }
+
+static void bench_dialer(void) {
+  static const char *const keys[] = {"1", "2", "3", "4", "5",
+                                     "6", "7", "8", "9", "0"};
+  lv_area_t area[10];
+
+  if (request(REQ_LAUNCH, "Call", NULL)) {
+    log_warn("Bench", "No Call applet, skipping the dialer");
+    return;
+  }
+  settle(BENCH_SETTLE_MS);
+
+  for (int k = 0; k < 10; k++) {
+    if (request(REQ_FIND, keys[k], &area[k])) {
+      log_warn("Bench", "Dialer key %s not found, skipping the dialer",
+               keys[k]);
+      return;
+    }
+  }
+
+  for (unsigned i = 0; i < g.iterations; i++) {
+    const lv_area_t *a = &area[i % 10];
+
+    settle(BENCH_QUIET_MS);
+    report(BENCH_DIAL_PRESS, center_x(a), center_y(a), 1);
+    settle(BENCH_QUIET_MS);
+    report(BENCH_DIAL_RELEASE, -1, -1, 0);
+  }
+}
+
+static void bench_scroll(void) {
+  if (request(REQ_LAUNCH, "Settings", NULL)) {
+    log_warn("Bench", "No Settings applet, skipping the list");
+    return;
+  }
+  settle(BENCH_SETTLE_MS);
+
+  for (unsigned i = 0; i < g.iterations; i++) {
+    lv_area_t a;
+
+    // From the top each time, dragging the content up
+    if (request(REQ_LIST, NULL, &a)) {
+      log_warn("Bench", "No scrollable list in Settings");
+      return;
+    }
+    settle(BENCH_QUIET_MS);
+
+    int h = lv_area_get_height(&a);
+    int x = center_x(&a);
+    int y = a.y1 + h * 3 / 4;
+    int end = a.y1 + h / 4;
+
+    report(BENCH_NONE, x, y, 1);
+    for (y -= BENCH_SCROLL_STEP; y > end; y -= BENCH_SCROLL_STEP)
+      report(BENCH_SCROLL, x, y, -1);
+    report(BENCH_NONE, -1, -1, 0);
+    // The throw runs out
+    settle(BENCH_QUIET_MS);
+  }
+}
+
+static void bench_launch(void) {
+  static const char *const targets[] = {"Contacts", "Call Log", "About"};
+  const unsigned n = sizeof(targets) / sizeof(targets[0]);
+
+  for (unsigned i = 0; i < g.iterations; i++) {
+    const char *target = targets[i % n];
+    lv_area_t a;
+
+    if (request(REQ_LAUNCH, "Home", NULL)) {
+      log_warn("Bench", "No Home applet, skipping launches");
+      return;
+    }
+    settle(BENCH_SETTLE_MS);
+    if (request(REQ_FIND, target, &a)) {
+      log_warn("Bench", "No %s tile on Home", target);
+      continue;
+    }
+    settle(BENCH_QUIET_MS);
+
+    report(BENCH_NONE, center_x(&a), center_y(&a), 1);
+    settle(BENCH_QUIET_MS);
+    report(BENCH_LAUNCH, -1, -1, 0);
+    settle(BENCH_SETTLE_MS);
+  }
+}
+
+static void log_results(void) {
+  log_info("Bench", "Touch-to-photon latency (ms):");
+  log_info("Bench", "  %-14s %5s %6s %6s %6s %6s %s", "interaction", "n",
+           "p50", "p95", "p99", "max", "missed");
+
+  for (int r = 0; r < BENCH_ROWS; r++) {
+    struct video_hist_summary s;
+    char p50[16], p95[16], p99[16], max[16];
+
+    video_hist_summarize(&g.hist[r], &s);
+    log_info("Bench", "  %-14s %5llu %6s %6s %6s %6s %u", k_row_names[r],
+             (unsigned long long)s.count,
+             video_hist_fmt_ms(p50, sizeof(p50), s.p50),
+             video_hist_fmt_ms(p95, sizeof(p95), s.p95),
+             video_hist_fmt_ms(p99, sizeof(p99), s.p99),
+             video_hist_fmt_ms(max, sizeof(max), s.max), g.missed[r]);
+  }
+}
+
+static void *bench_main(void *arg) {
+  (void)arg;
+
+  // The home screen is up
+  settle(BENCH_SETTLE_MS);
+  log_info("Bench", "Running, %u iterations per interaction", g.iterations);
+
+  bench_dialer();
+  bench_scroll();
+  bench_launch();
+
+  log_results();
+  request(REQ_QUIT, NULL, NULL);
+
+  close(g.fd);
+  g.fd = -1;
+  __atomic_store_n(&g.running, 0, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+int ui_bench_start(unsigned iterations) {
+  pthread_condattr_t attr;
+  int fds[2];
+  int err;
+
+  if (!iterations) return EINVAL;
+  if (ui_bench_running()) return EALREADY;
+
+  if (pipe(fds) != 0) return errno;
+  for (int i = 0; i < 2; i++) fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+  // Taken over (and closed on failure) by the pointer role
+  err = input_hotplug_add_fd(fds[0], EVDEV_INPUT_POINTER, "bench");
+  if (err) {
+    close(fds[1]);
+    return err;
+  }
+  g.fd = fds[1];
+  g.iterations = iterations;
+  memset(g.hist, 0, sizeof(g.hist));
+  memset(g.missed, 0, sizeof(g.missed));
+
+  // Deadlines come from video_timing_now()
+  pthread_mutex_init(&g.lock, NULL);
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&g.cond, &attr);
+  pthread_condattr_destroy(&attr);
+
+  // Frames are watched from here on
+  err = disp_hook_add(&k_hook);
+  if (err) {
+    close(g.fd);
+    g.fd = -1;
+    return err;
+  }
+
+  __atomic_store_n(&g.running, 1, __ATOMIC_RELEASE);
+  err = pthread_create(&g.thread, NULL, bench_main, NULL);
+  if (err) {
+    __atomic_store_n(&g.running, 0, __ATOMIC_RELEASE);
+    disp_hook_remove(&k_hook);
+    return err;
+  }
+  pthread_detach(g.thread);
+  return 0;
+}
+
+bool ui_bench_running(void) {
+  return __atomic_load_n(&g.running, __ATOMIC_ACQUIRE);
+}
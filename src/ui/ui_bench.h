@@ -0,0 +1,39 @@
+#ifndef UI_BENCH_H
+#define UI_BENCH_H
+
+#include <stdbool.h>
+
+// Default repetitions of each interaction
+#define UI_BENCH_ITERATIONS 20
+
+/**
+ * @brief Touch-to-photon benchmark (UI_LATENCY_BENCH).
+ *        A thread writes timestamped evdev events into a pipe that is
+ *        attached as a pointer device (input_hotplug_add_fd), so they take
+ *        the same path as a touchscreen: poll wakeup, decoding, the indev
+ *        read, LVGL and the flush. A display hook (disp_hook) sees when
+ *        each frame started rendering and when its last area was flushed.
+ *        A sample is the time from writing a report to the end of the first
+ *        frame that started after it; the UI is left to settle first, so
+ *        that frame is the response.
+ *
+ *        Interactions, `iterations` times each:
+ *        - dialer press / release: tapping digits on the Call dialer
+ *        - list scroll: dragging through the Settings list, one step at a
+ *          time as fast as frames come back
+ *        - applet launch: releasing a tile on the Home apps page
+ *
+ *        The distributions are logged (tag "Bench") and the loop is ended.
+ *        Start after the display, indevs and applets exist and before
+ *        baresip_manager_loop().
+ *
+ * @return 0 or an errno
+ */
+int ui_bench_start(unsigned iterations);
+
+// Serve the benchmark thread's requests; UI loop callback, every run
+void ui_bench_update(void);
+
+bool ui_bench_running(void);
+
+#endif // UI_BENCH_H
@@ -0,0 +1,102 @@
+#include "ui_power.h"
+#include "baresip_manager.h"
+#include "logger.h"
+#include "lvgl.h"
+#include "video_timing.h"
+#include <string.h>
+
+static const char *const k_state_names[UI_POWER_STATES] = {"on", "off"};
+
+static struct {
+  int (*blank)(bool blank);
+  bool listening;
+  uint32_t timeout_ms; // 0 = never
+
+  enum ui_power_state state;
+  uint64_t since; // Start of the current state (usec)
+  struct ui_power_stats stats;
+} g;
+
+static void set_state(enum ui_power_state state) {
+  uint64_t now = video_timing_now();
+
+  g.stats.ms[g.state] += (now - g.since) / 1000;
+  g.since = now;
+  g.state = state;
+  g.stats.state = state;
+
+  log_info("Power", "Screen %s (on %llu s, off %llu s so far)",
+           k_state_names[state],
+           (unsigned long long)(g.stats.ms[UI_POWER_ON] / 1000),
+           (unsigned long long)(g.stats.ms[UI_POWER_OFF] / 1000));
+}
+
+static bool screen_on(void) {
+  if (g.state != UI_POWER_OFF) return false;
+
+  if (g.blank) g.blank(false);
+  set_state(UI_POWER_ON);
+  // Idle time counts from now, and the loop has to run right away
+  lv_disp_trig_activity(NULL);
+  baresip_manager_wakeup();
+  return true;
+}
+
+// A ringing or connected call keeps the screen on
+static void call_event(enum call_state state, const char *peer_uri,
+                       void *call_id) {
+  (void)state;
+  (void)peer_uri;
+  (void)call_id;
+
+  if (screen_on()) g.stats.call_wakes++;
+}
+
+void ui_power_init(int (*blank)(bool blank)) {
+  g.blank = blank;
+  g.since = video_timing_now();
+  if (!g.listening) {
+    baresip_manager_add_listener(call_event);
+    g.listening = true;
+  }
+}
+
+void ui_power_set_timeout(unsigned sec) {
+  g.timeout_ms = sec * 1000u;
+  if (!g.timeout_ms) screen_on();
+  // Re-evaluate with the new timeout
+  baresip_manager_wakeup();
+}
+
+uint32_t ui_power_update(void) {
+  if (!g.timeout_ms || g.state != UI_POWER_ON) return UINT32_MAX;
+
+  enum call_state call = baresip_manager_get_state();
+  if (call != CALL_STATE_IDLE && call != CALL_STATE_TERMINATED) {
+    lv_disp_trig_activity(NULL);
+    return g.timeout_ms;
+  }
+
+  uint32_t idle = lv_disp_get_inactive_time(NULL);
+  if (idle < g.timeout_ms) return g.timeout_ms - idle;
+
+  if (g.blank) g.blank(true);
+  g.stats.screen_offs++;
+  set_state(UI_POWER_OFF);
+  return UINT32_MAX;
+}
+
+bool ui_power_parked(void) { return g.state == UI_POWER_OFF; }
+
+bool ui_power_wake(void) {
+  if (!screen_on()) return false;
+  g.stats.input_wakes++;
+  return true;
+}
+
+void ui_power_get_stats(struct ui_power_stats *stats) {
+  if (!stats) return;
+
+  *stats = g.stats;
+  if (g.since) stats->ms[g.state] += (video_timing_now() - g.since) / 1000;
+}
@@ -0,0 +1,55 @@
+#ifndef UI_POWER_H
+#define UI_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum ui_power_state {
+  UI_POWER_ON,  // Screen on, LVGL running
+  UI_POWER_OFF, // Screen blanked, LVGL parked
+  UI_POWER_STATES
+};
+
+struct ui_power_stats {
+  enum ui_power_state state;
+  uint64_t ms[UI_POWER_STATES]; // Time spent in each state, current included
+  uint32_t screen_offs;
+  uint32_t input_wakes;
+  uint32_t call_wakes;
+};
+
+/**
+ * @brief Screen-off power state.
+ *        After the display has seen no input for the timeout, and no call
+ *        is in progress, the screen is blanked and the UI loop parks: it
+ *        neither advances the LVGL tick nor runs lv_timer_handler(), so no
+ *        applet timer fires and nothing is rendered until it wakes. Input
+ *        (ui_power_wake()) or any call event wakes it at once.
+ *        UI thread only.
+ *
+ * @param blank Blanks or unblanks the panel (may be NULL).
+ */
+void ui_power_init(int (*blank)(bool blank));
+
+// Idle time before the screen goes off, 0 = never
+void ui_power_set_timeout(unsigned sec);
+
+/**
+ * @brief Call from the UI loop after LVGL ran; turns the screen off when
+ *        the timeout has passed.
+ * @return ms until it needs to run again (UINT32_MAX if not)
+ */
+uint32_t ui_power_update(void);
+
+// The loop must skip LVGL
+bool ui_power_parked(void);
+
+/**
+ * @brief Turn the screen back on (input arrived).
+ * @return true if it was off
+ */
+bool ui_power_wake(void);
+
+void ui_power_get_stats(struct ui_power_stats *stats);
+
+#endif // UI_POWER_H
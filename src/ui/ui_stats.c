@@ -0,0 +1,212 @@
+#include "ui_stats.h"
+#include "disp_hook.h"
+#include "lvgl.h"
+#include <stdio.h>
+#include <string.h>
+
+// Percentiles are taken over windows of this length
+#define UI_STATS_WINDOW_USEC 1000000
+
+static const char *const k_stage_names[UI_STAGE_COUNT] = {
+    "loop", "video", "timers", "render", "flush",
+};
+
+static struct {
+  bool enabled;
+
+  // Current run; run_start is 0 outside a run
+  uint64_t run_start;
+  uint64_t mark;
+  uint64_t refresh_us; // Display refreshes within the run
+
+  // Refresh in progress
+  uint64_t frame_start;
+  uint64_t frame_flush_us;
+  uint32_t frame_areas;
+  uint64_t frame_pixels;
+
+  // Window in progress
+  uint64_t win_start;
+  struct video_hist hist[UI_STAGE_COUNT];
+  uint32_t win_runs;
+  uint32_t win_frames;
+  uint64_t win_areas;
+  uint64_t win_pixels;
+
+  struct ui_stats stats; // Last window and totals
+  lv_obj_t *label;
+} g;
+
+static void stats_flushed(const lv_area_t *area, uint64_t usec, bool last,
+                          void *arg) {
+  (void)last;
+  (void)arg;
+
+  g.frame_flush_us += usec;
+  g.frame_areas++;
+  g.frame_pixels +=
+      (uint64_t)lv_area_get_width(area) * (uint64_t)lv_area_get_height(area);
+}
+
+static void stats_refresh_begin(void *arg) {
+  (void)arg;
+
+  g.frame_start = video_timing_now();
+  g.frame_flush_us = 0;
+  g.frame_areas = 0;
+  g.frame_pixels = 0;
+}
+
+static void stats_refresh_end(void *arg) {
+  (void)arg;
+
+  uint64_t us = video_timing_now() - g.frame_start;
+  g.refresh_us += us;
+
+  // Nothing was invalid
+  if (!g.frame_areas) return;
+
+  uint64_t flush = g.frame_flush_us < us ? g.frame_flush_us : us;
+  video_hist_add(&g.hist[UI_STAGE_RENDER], us - flush);
+  video_hist_add(&g.hist[UI_STAGE_FLUSH], flush);
+  g.win_frames++;
+  g.win_areas += g.frame_areas;
+  g.win_pixels += g.frame_pixels;
+}
+
+static const struct disp_hook k_hook = {
+    .refresh_begin = stats_refresh_begin,
+    .refresh_end = stats_refresh_end,
+    .flushed = stats_flushed,
+};
+
+static void update_label(uint64_t window_us) {
+  char text[384];
+  size_t len = 0;
+
+  for (int i = 0; i < UI_STAGE_COUNT; i++) {
+    const struct video_hist_summary *s = &g.stats.stage[i];
+    char p50[16], p95[16], p99[16];
+
+    len += snprintf(text + len, sizeof(text) - len, "%s %s / %s / %s ms\n",
+                    k_stage_names[i],
+                    video_hist_fmt_ms(p50, sizeof(p50), s->p50),
+                    video_hist_fmt_ms(p95, sizeof(p95), s->p95),
+                    video_hist_fmt_ms(p99, sizeof(p99), s->p99));
+    if (len >= sizeof(text)) return;
+  }
+
+  snprintf(text + len, sizeof(text) - len,
+           "%u runs, %u fps\n%u areas, %uk px / frame", g.stats.window_runs,
+           (unsigned)(g.stats.window_frames * 1000000ull /
+                      (window_us ? window_us : 1)),
+           g.stats.areas_per_frame, g.stats.pixels_per_frame / 1000);
+  lv_label_set_text(g.label, text);
+}
+
+static void roll_window(uint64_t now) {
+  for (int i = 0; i < UI_STAGE_COUNT; i++) {
+    video_hist_summarize(&g.hist[i], &g.stats.stage[i]);
+  }
+  memset(g.hist, 0, sizeof(g.hist));
+
+  g.stats.window_runs = g.win_runs;
+  g.stats.window_frames = g.win_frames;
+  g.stats.areas_per_frame =
+      g.win_frames ? (uint32_t)(g.win_areas / g.win_frames) : 0;
+  g.stats.pixels_per_frame =
+      g.win_frames ? (uint32_t)(g.win_pixels / g.win_frames) : 0;
+  g.stats.runs += g.win_runs;
+  g.stats.frames += g.win_frames;
+  g.stats.areas += g.win_areas;
+  g.stats.pixels += g.win_pixels;
+
+  if (g.label) update_label(now - g.win_start);
+
+  g.win_start = now;
+  g.win_runs = 0;
+  g.win_frames = 0;
+  g.win_areas = 0;
+  g.win_pixels = 0;
+}
+
+void ui_stats_enable(bool enable) {
+  if (enable == g.enabled) return;
+
+  if (enable) {
+    if (disp_hook_add(&k_hook) != 0) return;
+
+    memset(g.hist, 0, sizeof(g.hist));
+    memset(&g.stats, 0, sizeof(g.stats));
+    g.win_runs = g.win_frames = 0;
+    g.win_areas = g.win_pixels = 0;
+    g.win_start = video_timing_now();
+    g.run_start = 0;
+  } else {
+    disp_hook_remove(&k_hook);
+  }
+
+  g.enabled = enable;
+  g.stats.enabled = enable;
+}
+
+bool ui_stats_enabled(void) { return g.enabled; }
+
+void ui_stats_begin(void) {
+  if (!g.enabled) return;
+
+  g.run_start = video_timing_now();
+  g.mark = g.run_start;
+  g.refresh_us = 0;
+}
+
+void ui_stats_stage(enum ui_stage stage) {
+  if (!g.enabled || !g.run_start) return;
+
+  uint64_t now = video_timing_now();
+  uint64_t us = now - g.mark;
+
+  // The refresh ran inside the timer handler and is timed on its own
+  if (stage == UI_STAGE_TIMERS) us -= g.refresh_us < us ? g.refresh_us : us;
+
+  video_hist_add(&g.hist[stage], us);
+  g.mark = now;
+}
+
+void ui_stats_end(void) {
+  if (!g.enabled || !g.run_start) return;
+
+  uint64_t now = video_timing_now();
+  video_hist_add(&g.hist[UI_STAGE_LOOP], now - g.run_start);
+  g.run_start = 0;
+  g.win_runs++;
+
+  if (now - g.win_start >= UI_STATS_WINDOW_USEC) roll_window(now);
+}
+
+void ui_stats_get(struct ui_stats *stats) {
+  if (!stats) return;
+  *stats = g.stats;
+}
+
+void ui_stats_set_overlay(bool show) {
+  if (!show) {
+    if (g.label) {
+      lv_obj_del(g.label);
+      g.label = NULL;
+      ui_stats_enable(false);
+    }
+    return;
+  }
+
+  ui_stats_enable(true);
+  if (g.label || !g.enabled) return;
+
+  g.label = lv_label_create(lv_layer_sys());
+  lv_obj_set_style_bg_color(g.label, lv_color_black(), 0);
+  lv_obj_set_style_bg_opa(g.label, LV_OPA_60, 0);
+  lv_obj_set_style_text_color(g.label, lv_color_white(), 0);
+  lv_obj_set_style_pad_all(g.label, 4, 0);
+  lv_obj_align(g.label, LV_ALIGN_TOP_RIGHT, 0, 0);
+  lv_label_set_text(g.label, "UI timing...");
+}
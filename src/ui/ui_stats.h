@@ -0,0 +1,62 @@
+#ifndef UI_STATS_H
+#define UI_STATS_H
+
+#include "video_timing.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Stages of one UI loop run
+enum ui_stage {
+  UI_STAGE_LOOP,   // The whole run
+  UI_STAGE_VIDEO,  // baresip_manager_process_video()
+  UI_STAGE_TIMERS, // lv_timer_handler() without the display refresh:
+                   // input, animations, applet timers
+  UI_STAGE_RENDER, // Display refresh without flush_cb
+  UI_STAGE_FLUSH,  // flush_cb calls of a refresh
+  UI_STAGE_COUNT
+};
+
+struct ui_stats {
+  bool enabled;
+  // Last complete window (about a second); RENDER and FLUSH are per
+  // refresh that drew something, the others per loop run
+  struct video_hist_summary stage[UI_STAGE_COUNT];
+  uint32_t window_runs;
+  uint32_t window_frames;
+  uint32_t areas_per_frame;  // Areas flushed, average
+  uint32_t pixels_per_frame; // Pixels flushed, average
+  // Since enabled
+  uint64_t runs;
+  uint64_t frames;
+  uint64_t areas;
+  uint64_t pixels;
+};
+
+/**
+ * @brief Time the UI loop.
+ *        Wraps the default display's refresh timer and flush_cb to time
+ *        rendering and flushing separately and to count flushed areas and
+ *        pixels. The loop marks its own stages with ui_stats_begin() /
+ *        ui_stats_stage() / ui_stats_end(). When disabled nothing is
+ *        wrapped and the marks return at once. UI thread only, after the
+ *        display is registered.
+ */
+void ui_stats_enable(bool enable);
+bool ui_stats_enabled(void);
+
+// Start of a loop run
+void ui_stats_begin(void);
+// End of `stage`, which ran since the previous mark
+void ui_stats_stage(enum ui_stage stage);
+// End of the run
+void ui_stats_end(void);
+
+void ui_stats_get(struct ui_stats *stats);
+
+/**
+ * @brief Show the figures of the last window on top of everything
+ *        (developer overlay). The statistics run while it is shown.
+ */
+void ui_stats_set_overlay(bool show);
+
+#endif // UI_STATS_H
@@ -0,0 +1,274 @@
+#include "video_widget.h"
+#include <string.h>
+
+#define MY_CLASS &video_widget_class
+
+typedef struct {
+  lv_obj_t obj;
+  lv_img_dsc_t dsc; // Copy of the current frame's descriptor
+  bool has_frame;
+  struct video_widget_stats stats;
+} video_widget_t;
+
+static void video_widget_constructor(const lv_obj_class_t *class_p,
+                                     lv_obj_t *obj);
+static void video_widget_event(const lv_obj_class_t *class_p, lv_event_t *e);
+
+const lv_obj_class_t video_widget_class = {
+    .constructor_cb = video_widget_constructor,
+    .event_cb = video_widget_event,
+    .width_def = LV_PCT(100),
+    .height_def = LV_PCT(100),
+    .instance_size = sizeof(video_widget_t),
+    .base_class = &lv_obj_class,
+};
+
+lv_obj_t *video_widget_create(lv_obj_t *parent) {
+  lv_obj_t *obj = lv_obj_class_create_obj(MY_CLASS, parent);
+  lv_obj_class_init_obj(obj);
+  return obj;
+}
+
+bool video_widget_check(const lv_obj_t *obj) {
+  return obj && lv_obj_check_type(obj, MY_CLASS);
+}
+
+static void video_widget_constructor(const lv_obj_class_t *class_p,
+                                     lv_obj_t *obj) {
+  LV_UNUSED(class_p);
+  video_widget_t *vw = (video_widget_t *)obj;
+
+  memset(&vw->dsc, 0, sizeof(vw->dsc));
+  vw->has_frame = false;
+  memset(&vw->stats, 0, sizeof(vw->stats));
+
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+}
+
+// Frame's top-left aligned area in screen coordinates
+static void frame_coords(const video_widget_t *vw, lv_area_t *area) {
+  area->x1 = vw->obj.coords.x1;
+  area->y1 = vw->obj.coords.y1;
+  area->x2 = area->x1 + (lv_coord_t)vw->dsc.header.w - 1;
+  area->y2 = area->y1 + (lv_coord_t)vw->dsc.header.h - 1;
+}
+
+void video_widget_set_frame(lv_obj_t *obj, const lv_img_dsc_t *dsc,
+                            const lv_area_t *damage, unsigned n) {
+  if (!video_widget_check(obj)) return;
+  video_widget_t *vw = (video_widget_t *)obj;
+
+  bool full = !dsc || !damage || !vw->has_frame ||
+              dsc->header.w != vw->dsc.header.w ||
+              dsc->header.h != vw->dsc.header.h ||
+              dsc->header.cf != vw->dsc.header.cf;
+
+  if (dsc) {
+    vw->dsc = *dsc;
+    vw->has_frame = true;
+  } else {
+    memset(&vw->dsc, 0, sizeof(vw->dsc));
+    vw->has_frame = false;
+  }
+
+  // The descriptor keeps its address while its data pointer moves between
+  // frames, so nothing decoded from it may be reused
+  lv_img_cache_invalidate_src(&vw->dsc);
+
+  if (!dsc) {
+    lv_obj_invalidate(obj);
+    return;
+  }
+
+  vw->stats.frames++;
+
+  if (full) {
+    vw->stats.full++;
+    vw->stats.damage_px += lv_area_get_size(&obj->coords);
+    lv_obj_invalidate(obj);
+    return;
+  }
+
+  for (unsigned i = 0; i < n; i++) {
+    lv_area_t area = {
+        .x1 = obj->coords.x1 + damage[i].x1,
+        .y1 = obj->coords.y1 + damage[i].y1,
+        .x2 = obj->coords.x1 + damage[i].x2,
+        .y2 = obj->coords.y1 + damage[i].y2,
+    };
+
+    if (!_lv_area_intersect(&area, &area, &obj->coords)) continue;
+
+    vw->stats.damage_px += lv_area_get_size(&area);
+    lv_obj_invalidate_area(obj, &area);
+  }
+}
+
+// Does the object paint anything of its own?
+static bool obj_draws(const lv_obj_t *o) {
+  // Labels, buttons, images...
+  if (!lv_obj_check_type(o, &lv_obj_class)) return true;
+
+  return lv_obj_get_style_bg_opa(o, LV_PART_MAIN) > LV_OPA_MIN ||
+         lv_obj_get_style_bg_img_src(o, LV_PART_MAIN) != NULL ||
+         (lv_obj_get_style_border_width(o, LV_PART_MAIN) > 0 &&
+          lv_obj_get_style_border_opa(o, LV_PART_MAIN) > LV_OPA_MIN) ||
+         (lv_obj_get_style_outline_width(o, LV_PART_MAIN) > 0 &&
+          lv_obj_get_style_outline_opa(o, LV_PART_MAIN) > LV_OPA_MIN) ||
+         (lv_obj_get_style_shadow_width(o, LV_PART_MAIN) > 0 &&
+          lv_obj_get_style_shadow_opa(o, LV_PART_MAIN) > LV_OPA_MIN);
+}
+
+// Add the parts of o (and its children) that cover region. -1 on overflow.
+static int collect_occluders(const lv_obj_t *o, const lv_area_t *region,
+                             lv_area_t *out, unsigned max, unsigned *n) {
+  if (lv_obj_has_flag(o, LV_OBJ_FLAG_HIDDEN) ||
+      lv_obj_get_style_opa(o, LV_PART_MAIN) <= LV_OPA_MIN) {
+    return 0;
+  }
+
+  lv_area_t area = o->coords;
+  lv_area_t clip;
+  lv_coord_t ext = _lv_obj_get_ext_draw_size(o);
+  lv_area_increase(&area, ext, ext);
+
+  bool hit = _lv_area_intersect(&clip, &area, region);
+  // Children are clipped to their parent unless it lets them overflow
+  if (!hit && !lv_obj_has_flag(o, LV_OBJ_FLAG_OVERFLOW_VISIBLE)) return 0;
+
+  if (hit && obj_draws(o)) {
+    if (*n >= max) return -1;
+    out[(*n)++] = clip;
+    return 0;
+  }
+
+  uint32_t cnt = lv_obj_get_child_cnt(o);
+  for (uint32_t i = 0; i < cnt; i++) {
+    if (collect_occluders(lv_obj_get_child(o, (int32_t)i), region, out, max,
+                          n) < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int video_widget_get_occluders(const lv_obj_t *obj, lv_area_t *out,
+                               unsigned max) {
+  if (!video_widget_check(obj) || !out) return -1;
+
+  lv_obj_t *scr = lv_obj_get_screen(obj);
+  if (scr != lv_scr_act() || !lv_obj_is_visible(obj)) return -1;
+
+  const lv_area_t *region = &obj->coords;
+  unsigned n = 0;
+
+  // Everything drawn after the widget: later siblings of it and of each
+  // ancestor. The widget must not be clipped by any ancestor either.
+  const lv_obj_t *o = obj;
+  while (o != scr) {
+    lv_obj_t *parent = lv_obj_get_parent(o);
+    if (!parent) return -1;
+    if (!lv_obj_has_flag(parent, LV_OBJ_FLAG_OVERFLOW_VISIBLE) &&
+        !_lv_area_is_in(region, &parent->coords, 0)) {
+      return -1;
+    }
+
+    uint32_t cnt = lv_obj_get_child_cnt(parent);
+    for (uint32_t i = lv_obj_get_index(o) + 1; i < cnt; i++) {
+      if (collect_occluders(lv_obj_get_child(parent, (int32_t)i), region, out,
+                            max, &n) < 0) {
+        return -1;
+      }
+    }
+    o = parent;
+  }
+
+  if (collect_occluders(lv_layer_top(), region, out, max, &n) < 0 ||
+      collect_occluders(lv_layer_sys(), region, out, max, &n) < 0) {
+    return -1;
+  }
+
+  return (int)n;
+}
+
+void video_widget_get_stats(const lv_obj_t *obj,
+                            struct video_widget_stats *stats) {
+  if (!stats) return;
+  if (!video_widget_check(obj)) {
+    memset(stats, 0, sizeof(*stats));
+    return;
+  }
+  *stats = ((const video_widget_t *)obj)->stats;
+}
+
+static void draw_main(video_widget_t *vw, lv_event_t *e) {
+  lv_obj_t *obj = &vw->obj;
+  lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+  lv_area_t img_area, vis_area, clip;
+  bool has_img = false;
+
+  if (vw->has_frame && vw->dsc.data) {
+    frame_coords(vw, &img_area);
+    has_img = _lv_area_intersect(&vis_area, &img_area, &obj->coords);
+  }
+
+  // Black only where the frame does not cover this refresh area
+  if (!has_img || !_lv_area_is_in(draw_ctx->clip_area, &vis_area, 0)) {
+    lv_draw_rect_dsc_t bg;
+    lv_draw_rect_dsc_init(&bg);
+    bg.bg_color = lv_color_black();
+    bg.bg_opa = LV_OPA_COVER;
+    lv_draw_rect(draw_ctx, &bg, &obj->coords);
+  }
+
+  if (has_img && _lv_area_intersect(&clip, draw_ctx->clip_area, &vis_area)) {
+    const lv_area_t *clip_ori = draw_ctx->clip_area;
+    lv_draw_img_dsc_t img;
+
+    lv_draw_img_dsc_init(&img);
+    draw_ctx->clip_area = &clip;
+    lv_draw_img(draw_ctx, &img, &img_area, &vw->dsc);
+    draw_ctx->clip_area = clip_ori;
+
+    vw->stats.blit_px += lv_area_get_size(&clip);
+  }
+
+  // Border/outline styles go over the picture
+  lv_draw_rect_dsc_t frame;
+  lv_draw_rect_dsc_init(&frame);
+  frame.bg_opa = LV_OPA_TRANSP;
+  frame.bg_img_opa = LV_OPA_TRANSP;
+  frame.shadow_opa = LV_OPA_TRANSP;
+  lv_obj_init_draw_rect_dsc(obj, LV_PART_MAIN, &frame);
+  if ((frame.border_width && frame.border_opa > LV_OPA_MIN) ||
+      (frame.outline_width && frame.outline_opa > LV_OPA_MIN)) {
+    lv_draw_rect(draw_ctx, &frame, &obj->coords);
+  }
+}
+
+static void video_widget_event(const lv_obj_class_t *class_p, lv_event_t *e) {
+  LV_UNUSED(class_p);
+  lv_event_code_t code = lv_event_get_code(e);
+  lv_obj_t *obj = lv_event_get_target(e);
+
+  if (code == LV_EVENT_COVER_CHECK) {
+    // Always opaque: either video or black
+    lv_cover_check_info_t *info = lv_event_get_param(e);
+    if (info->res == LV_COVER_RES_MASKED) return;
+    if (lv_obj_get_style_opa(obj, LV_PART_MAIN) < LV_OPA_MAX ||
+        lv_obj_get_style_radius(obj, LV_PART_MAIN) != 0 ||
+        !_lv_area_is_in(info->area, &obj->coords, 0)) {
+      info->res = LV_COVER_RES_NOT_COVER;
+      return;
+    }
+    info->res = LV_COVER_RES_COVER;
+    return;
+  }
+
+  if (code == LV_EVENT_DRAW_MAIN) {
+    draw_main((video_widget_t *)obj, e);
+    return;
+  }
+
+  lv_obj_event_base(MY_CLASS, e);
+}
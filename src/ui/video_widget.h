@@ -0,0 +1,66 @@
+#ifndef VIDEO_WIDGET_H
+#define VIDEO_WIDGET_H
+
+#include "lvgl.h"
+
+extern const lv_obj_class_t video_widget_class;
+
+// Redraw counters of one video widget
+struct video_widget_stats {
+  uint32_t frames;     // video_widget_set_frame() calls with a frame
+  uint32_t full;       // Frames that invalidated the whole widget
+  uint64_t damage_px;  // Pixels marked dirty by frames
+  uint64_t blit_px;    // Pixels of video actually drawn
+};
+
+/**
+ * @brief Create a video surface.
+ *        An opaque rectangle that draws a TRUE_COLOR frame at its top-left
+ *        corner, black where the frame does not reach. Unlike lv_img it
+ *        never re-evaluates its source or resizes itself on a new frame and
+ *        only invalidates the area the frame changed, so LVGL neither draws
+ *        what lies beneath it nor redraws the letterbox bars.
+ *        Border/outline styles are drawn on top of the video.
+ *
+ * @param parent The parent object.
+ * @return The video widget.
+ */
+lv_obj_t *video_widget_create(lv_obj_t *parent);
+
+/**
+ * @brief Show a new frame.
+ *        The descriptor is copied, but its pixel data must stay valid until
+ *        the next call (or until the widget is deleted).
+ *
+ * @param obj The video widget.
+ * @param dsc The frame (LV_IMG_CF_TRUE_COLOR), NULL to show black.
+ * @param damage Changed areas relative to the frame's top-left corner, NULL
+ *               if the whole frame changed.
+ * @param n Number of damage areas (0: nothing to redraw, e.g. the frame
+ *          is already on screen through the overlay).
+ */
+void video_widget_set_frame(lv_obj_t *obj, const lv_img_dsc_t *dsc,
+                            const lv_area_t *damage, unsigned n);
+
+/**
+ * @brief Find what LVGL draws on top of the widget.
+ *        Collects the screen areas of visible objects drawn after the widget
+ *        (later siblings of it and its ancestors, the top and system
+ *        layers) that paint something over it. Transparent containers are
+ *        looked through.
+ *
+ * @param obj The video widget.
+ * @param out Covered areas, clipped to the widget.
+ * @param max Size of out.
+ * @return Number of areas, or -1 if there are more than max or the widget
+ *         is not fully visible on the active screen.
+ */
+int video_widget_get_occluders(const lv_obj_t *obj, lv_area_t *out,
+                               unsigned max);
+
+// True if obj was created by video_widget_create()
+bool video_widget_check(const lv_obj_t *obj);
+void video_widget_get_stats(const lv_obj_t *obj,
+                            struct video_widget_stats *stats);
+
+#endif // VIDEO_WIDGET_H
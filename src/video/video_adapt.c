@@ -0,0 +1,336 @@
+#include "video_adapt.h"
+#include "logger.h"
+#include "video_timing.h"
+#include <errno.h>
+#include <re.h>
+#include <rem.h>
+#include <baresip.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Decisions are taken on windows of this length
+#define ADAPT_WINDOW_USEC 1000000
+// Process CPU share of all cores (percent) above which a window is
+// overloaded, and below which it has headroom
+#define ADAPT_CPU_HIGH 85
+#define ADAPT_CPU_LOW 55
+// 95th percentile UI response time (delay before a UI run plus the run)
+// above which the UI counts as stuttering, and below which it is smooth
+#define ADAPT_UI_HIGH_USEC 45000
+#define ADAPT_UI_LOW_USEC 20000
+// Consecutive windows needed to step down or up, and windows to hold still
+// after a change while the encoder and the load settle
+#define ADAPT_DOWN_WINDOWS 2
+#define ADAPT_UP_WINDOWS 5
+#define ADAPT_HOLD_WINDOWS 3
+// Limits of the ladder
+#define ADAPT_MIN_WIDTH 160
+#define ADAPT_MIN_FPS 5
+// Scale is in eighths of the ceiling
+#define ADAPT_SCALE_FULL 8
+#define ADAPT_MAX_STEPS 8
+
+struct adapt_step {
+  unsigned scale; // Eighths of the ceiling size
+  unsigned fps;
+};
+
+// Size first, where the encoder cost is, then rate; every rung roughly
+// halves the pixel rate of the one two steps up
+static const struct {
+  unsigned scale;
+  unsigned fps_num;
+  unsigned fps_den;
+} k_ladder[] = {
+    {8, 1, 1}, {6, 1, 1}, {6, 2, 3}, {4, 2, 3},
+    {4, 1, 2}, {3, 1, 2}, {2, 1, 3},
+};
+
+static struct {
+  struct vidsrc *vidsrc;
+
+  // UI thread
+  bool enabled;
+  unsigned ceil_w;
+  unsigned ceil_h;
+  unsigned ceil_fps;
+  struct adapt_step ladder[ADAPT_MAX_STEPS];
+  unsigned nsteps;
+  unsigned level;
+
+  uint64_t win_start; // 0 while inactive
+  uint64_t cpu_start; // Process CPU time at win_start (usec)
+  struct video_hist ui; // UI response times of the window
+  unsigned over;        // Consecutive overloaded windows
+  unsigned under;       // Consecutive windows with headroom
+  unsigned hold;
+  unsigned cpu_pct;
+  uint32_t ui_p95;
+
+  // Current step, read by capture threads (atomic)
+  uint32_t scale;
+  uint32_t fps;
+  uint32_t src_fps;
+} g = {.scale = ADAPT_SCALE_FULL};
+
+// Wraps the configured camera: frames are scaled and paced to the current
+// step before baresip sees them. The device is "<module>,<device>".
+struct vidsrc_st {
+  struct vidsrc_st *inner;
+  vidsrc_frame_h *frameh;
+  vidsrc_packet_h *packeth;
+  vidsrc_error_h *errorh;
+  void *arg;
+  struct vidframe *frame; // Scaled frame, capture thread only
+  uint64_t next_ts;       // Earliest timestamp of the next frame passed on
+};
+
+static uint64_t cpu_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static unsigned step_dim(unsigned ceil, unsigned scale) {
+  return (ceil * scale / ADAPT_SCALE_FULL) & ~1u;
+}
+
+static void set_level(unsigned level) {
+  g.level = level;
+  __atomic_store_n(&g.scale, g.ladder[level].scale, __ATOMIC_RELAXED);
+  __atomic_store_n(&g.fps, g.ladder[level].fps, __ATOMIC_RELAXED);
+}
+
+void video_adapt_configure(bool enable, unsigned width, unsigned height,
+                           unsigned fps) {
+  g.enabled = enable;
+  g.ceil_w = width;
+  g.ceil_h = height;
+  g.ceil_fps = fps ? fps : 30;
+  __atomic_store_n(&g.src_fps, g.ceil_fps, __ATOMIC_RELAXED);
+
+  g.nsteps = 0;
+  for (size_t i = 0; i < sizeof(k_ladder) / sizeof(k_ladder[0]); i++) {
+    unsigned w = step_dim(width, k_ladder[i].scale);
+    unsigned f = g.ceil_fps * k_ladder[i].fps_num / k_ladder[i].fps_den;
+
+    if (g.nsteps && (w < ADAPT_MIN_WIDTH || f < ADAPT_MIN_FPS)) break;
+    g.ladder[g.nsteps].scale = k_ladder[i].scale;
+    g.ladder[g.nsteps].fps = f;
+    g.nsteps++;
+  }
+
+  set_level(0);
+  g.over = g.under = g.hold = 0;
+  g.win_start = 0;
+  log_info("VideoAdapt", "%s, ceiling %ux%u@%u, %u steps",
+           enable ? "on" : "off", width, height, g.ceil_fps, g.nsteps);
+}
+
+static void evaluate(uint64_t now) {
+  static long ncpu;
+  struct video_hist_summary ui;
+  uint64_t cpu = cpu_now();
+  uint64_t wall = now - g.win_start;
+
+  if (!ncpu) {
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1) ncpu = 1;
+  }
+
+  video_hist_summarize(&g.ui, &ui);
+  g.cpu_pct = (unsigned)((cpu - g.cpu_start) * 100 / (wall * (uint64_t)ncpu));
+  g.ui_p95 = ui.p95;
+
+  // Next window
+  g.win_start = now;
+  g.cpu_start = cpu;
+  memset(&g.ui, 0, sizeof(g.ui));
+
+  if (!g.enabled) return;
+  if (g.hold) {
+    g.hold--;
+    return;
+  }
+
+  bool overloaded =
+      g.cpu_pct > ADAPT_CPU_HIGH || g.ui_p95 > ADAPT_UI_HIGH_USEC;
+  bool headroom = g.cpu_pct < ADAPT_CPU_LOW && g.ui_p95 < ADAPT_UI_LOW_USEC;
+
+  g.over = overloaded ? g.over + 1 : 0;
+  g.under = headroom ? g.under + 1 : 0;
+
+  unsigned level = g.level;
+  if (g.over >= ADAPT_DOWN_WINDOWS && level + 1 < g.nsteps)
+    level++;
+  else if (g.under >= ADAPT_UP_WINDOWS && level > 0)
+    level--;
+  else
+    return;
+
+  log_info("VideoAdapt", "CPU %u%%, UI p95 %u ms: step %s to %ux%u@%u (%u/%u)",
+           g.cpu_pct, g.ui_p95 / 1000, level > g.level ? "down" : "up",
+           step_dim(g.ceil_w, g.ladder[level].scale),
+           step_dim(g.ceil_h, g.ladder[level].scale), g.ladder[level].fps,
+           level + 1, g.nsteps);
+
+  set_level(level);
+  g.over = g.under = 0;
+  g.hold = ADAPT_HOLD_WINDOWS;
+}
+
+void video_adapt_tick(uint64_t now, bool active) {
+  if (!active) {
+    g.win_start = 0;
+    return;
+  }
+
+  if (!g.win_start) {
+    g.win_start = now;
+    g.cpu_start = cpu_now();
+    memset(&g.ui, 0, sizeof(g.ui));
+    return;
+  }
+
+  if (now - g.win_start >= ADAPT_WINDOW_USEC) evaluate(now);
+}
+
+void video_adapt_ui_sample(uint32_t usec) {
+  if (g.win_start) video_hist_add(&g.ui, usec);
+}
+
+void video_adapt_get_state(struct video_adapt_state *s) {
+  const struct adapt_step *step = &g.ladder[g.level];
+
+  memset(s, 0, sizeof(*s));
+  s->enabled = g.enabled;
+  s->level = g.level;
+  s->levels = g.nsteps;
+  if (g.nsteps) {
+    s->width = step_dim(g.ceil_w, step->scale);
+    s->height = step_dim(g.ceil_h, step->scale);
+    s->fps = step->fps;
+  }
+  s->cpu_pct = g.cpu_pct;
+  s->ui_p95_us = g.ui_p95;
+}
+
+// Capture thread: pass on at most `fps` frames a second
+static bool pace(struct vidsrc_st *st, uint64_t ts, unsigned fps) {
+  int64_t interval = VIDEO_TIMEBASE / fps;
+  int64_t early = (int64_t)(st->next_ts - ts);
+
+  if (st->next_ts && early > interval / 4 && early <= interval) return false;
+
+  // Keep the cadence unless the source fell behind or jumped
+  if (st->next_ts && early > -interval && early <= interval)
+    st->next_ts += (uint64_t)interval;
+  else
+    st->next_ts = ts + (uint64_t)interval;
+  return true;
+}
+
+static void frame_handler(struct vidframe *frame, uint64_t timestamp,
+                          void *arg) {
+  struct vidsrc_st *st = arg;
+  unsigned scale = __atomic_load_n(&g.scale, __ATOMIC_RELAXED);
+  unsigned fps = __atomic_load_n(&g.fps, __ATOMIC_RELAXED);
+
+  if (fps && fps < __atomic_load_n(&g.src_fps, __ATOMIC_RELAXED) &&
+      !pace(st, timestamp, fps))
+    return;
+
+  if (scale >= ADAPT_SCALE_FULL) {
+    st->frameh(frame, timestamp, st->arg);
+    return;
+  }
+
+  // Converted to the encoder format here, so baresip does not convert (and
+  // scale back up) again
+  struct vidsz sz = {step_dim(frame->size.w, scale),
+                     step_dim(frame->size.h, scale)};
+  if (!sz.w || !sz.h) {
+    st->frameh(frame, timestamp, st->arg);
+    return;
+  }
+
+  if (!st->frame || !vidsz_cmp(&st->frame->size, &sz)) {
+    st->frame = mem_deref(st->frame);
+    if (vidframe_alloc(&st->frame, VID_FMT_YUV420P, &sz)) {
+      st->frameh(frame, timestamp, st->arg);
+      return;
+    }
+  }
+
+  vidconv(st->frame, frame, NULL);
+  st->frameh(st->frame, timestamp, st->arg);
+}
+
+static void packet_handler(struct vidpacket *packet, void *arg) {
+  struct vidsrc_st *st = arg;
+  st->packeth(packet, st->arg);
+}
+
+static void error_handler(int err, void *arg) {
+  struct vidsrc_st *st = arg;
+  if (st->errorh) st->errorh(err, st->arg);
+}
+
+static void src_destructor(void *arg) {
+  struct vidsrc_st *st = arg;
+
+  // Stops the capture thread before the frame goes
+  st->inner = mem_deref(st->inner);
+  st->frame = mem_deref(st->frame);
+}
+
+static int src_alloc(struct vidsrc_st **stp, const struct vidsrc *vs,
+                     struct vidsrc_prm *prm, const struct vidsz *size,
+                     const char *fmt, const char *dev, vidsrc_frame_h *frameh,
+                     vidsrc_packet_h *packeth, vidsrc_error_h *errorh,
+                     void *arg) {
+  struct vidsrc_st *st;
+  char mod[16];
+  const char *inner_dev = "";
+  int err;
+  (void)vs;
+
+  if (!stp || !dev || !frameh) return EINVAL;
+
+  const char *sep = strchr(dev, ',');
+  size_t len = sep ? (size_t)(sep - dev) : strlen(dev);
+  if (!len || len >= sizeof(mod)) return EINVAL;
+  memcpy(mod, dev, len);
+  mod[len] = '\0';
+  if (sep) inner_dev = sep + 1;
+
+  st = mem_zalloc(sizeof(*st), src_destructor);
+  if (!st) return ENOMEM;
+
+  st->frameh = frameh;
+  st->packeth = packeth;
+  st->errorh = errorh;
+  st->arg = arg;
+
+  // Packet sources (already encoded) are passed through as they are
+  err = vidsrc_alloc(&st->inner, baresip_vidsrcl(), mod, prm, size, fmt,
+                     inner_dev, frame_handler,
+                     packeth ? packet_handler : NULL, error_handler, st);
+  if (err) {
+    log_warn("VideoAdapt", "Source %s,%s failed: %d", mod, inner_dev, err);
+    mem_deref(st);
+    return err;
+  }
+
+  *stp = st;
+  return 0;
+}
+
+int video_adapt_register(void) {
+  if (g.vidsrc) return 0;
+  return vidsrc_register(&g.vidsrc, baresip_vidsrcl(), "adapt", src_alloc,
+                         NULL);
+}
+
+void video_adapt_unregister(void) { g.vidsrc = mem_deref(g.vidsrc); }
@@ -0,0 +1,1936 @@
+#include "video_convert.h"
+#include "logger.h"
+#include "video_workers.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VIDEO_HAVE_X86 1
+#include <immintrin.h>
+#define SSE2_FN __attribute__((target("sse2")))
+#define AVX2_FN __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+#define VIDEO_HAVE_NEON 1
+#include <arm_neon.h>
+#if !defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+// ============================================================================
+// Colour matrices (8.8 fixed point)
+// ============================================================================
+
+// R = (cy*C + crv*E + 128) >> 8
+// G = (cy*C - cgu*D - cgv*E + 128) >> 8
+// B = (cy*C + cbu*D + 128) >> 8
+// with C = Y - y_off, D = U - 128, E = V - 128. The lookup tables hold the
+// same terms (rounding folded into lut_y), so every kernel is bit-exact.
+struct video_csc {
+  int16_t y_off;
+  int16_t cy, crv, cgu, cgv, cbu;
+  int32_t lut_y[256];
+  int32_t lut_rv[256];
+  int32_t lut_gu[256];
+  int32_t lut_gv[256];
+  int32_t lut_bu[256];
+};
+
+static struct video_csc g_csc[VIDEO_CSC_COUNT] = {
+    [VIDEO_CSC_BT601_LIMITED] = {16, 298, 409, 100, 208, 516},
+    [VIDEO_CSC_BT601_FULL] = {0, 256, 359, 88, 183, 454},
+    [VIDEO_CSC_BT709_LIMITED] = {16, 298, 459, 55, 136, 541},
+    [VIDEO_CSC_BT709_FULL] = {0, 256, 403, 48, 120, 475},
+};
+
+static const char *g_csc_names[VIDEO_CSC_COUNT] = {
+    "BT.601 limited", "BT.601 full", "BT.709 limited", "BT.709 full"};
+
+// Clamp table for the LUT kernel: sums span roughly [-250, 550]
+#define CLAMP_LUT_OFF 384
+static uint8_t g_clamp_lut[1024];
+// Dithered 8-bit -> 5/6-bit quantisers, indexed by the Bayer offset
+static uint8_t g_q5_lut[8][256];
+static uint8_t g_q6_lut[4][256];
+
+static pthread_once_t g_csc_once = PTHREAD_ONCE_INIT;
+
+static void csc_build_tables(void) {
+  for (int i = 0; i < (int)(sizeof(g_clamp_lut)); i++) {
+    int v = i - CLAMP_LUT_OFF;
+    g_clamp_lut[i] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+  }
+  for (int v = 0; v < 256; v++) {
+    for (int d = 0; d < 8; d++) {
+      g_q5_lut[d][v] = (uint8_t)((v + d > 255 ? 255 : v + d) >> 3);
+    }
+    for (int d = 0; d < 4; d++) {
+      g_q6_lut[d][v] = (uint8_t)((v + d > 255 ? 255 : v + d) >> 2);
+    }
+  }
+
+  for (int c = 0; c < VIDEO_CSC_COUNT; c++) {
+    struct video_csc *k = &g_csc[c];
+    for (int i = 0; i < 256; i++) {
+      k->lut_y[i] = k->cy * (i - k->y_off) + 128;
+      k->lut_rv[i] = k->crv * (i - 128);
+      k->lut_gu[i] = -k->cgu * (i - 128);
+      k->lut_gv[i] = -k->cgv * (i - 128);
+      k->lut_bu[i] = k->cbu * (i - 128);
+    }
+  }
+}
+
+static const struct video_csc *csc_get(video_csc_t csc) {
+  pthread_once(&g_csc_once, csc_build_tables);
+  if (csc >= VIDEO_CSC_COUNT) csc = VIDEO_CSC_BT601_LIMITED;
+  return &g_csc[csc];
+}
+
+const char *video_csc_name(video_csc_t csc) {
+  if (csc >= VIDEO_CSC_COUNT) return "unknown";
+  return g_csc_names[csc];
+}
+
+video_csc_t video_csc_select(unsigned height, int matrix, bool full_range) {
+  // No colour description reaches the display, so follow the usual
+  // convention: HD is BT.709, SD is BT.601
+  bool bt709 = matrix == 2 || (matrix != 1 && height >= 720);
+
+  if (bt709) return full_range ? VIDEO_CSC_BT709_FULL : VIDEO_CSC_BT709_LIMITED;
+  return full_range ? VIDEO_CSC_BT601_FULL : VIDEO_CSC_BT601_LIMITED;
+}
+
+// ============================================================================
+// Scalar
+// ============================================================================
+
+static inline uint8_t clamp_u8(int v) {
+  if (v < 0) return 0;
+  if (v > 255) return 255;
+  return (uint8_t)v;
+}
+
+static inline uint32_t yuv_to_argb(const struct video_csc *k, int Y, int U,
+                                   int V) {
+  int C = Y - k->y_off;
+  int D = U - 128;
+  int E = V - 128;
+
+  int R = (k->cy * C + k->crv * E + 128) >> 8;
+  int G = (k->cy * C - k->cgu * D - k->cgv * E + 128) >> 8;
+  int B = (k->cy * C + k->cbu * D + 128) >> 8;
+
+  // 0xAARRGGBB, i.e. B, G, R, A in memory on little endian (LVGL 32-bit)
+  return 0xFF000000u | ((uint32_t)clamp_u8(R) << 16) |
+         ((uint32_t)clamp_u8(G) << 8) | clamp_u8(B);
+}
+
+// Tail handler shared by the SIMD kernels (x must be even)
+static void row_scalar_from(uint32_t *dst, const uint8_t *y, const uint8_t *u,
+                            const uint8_t *v, unsigned x, unsigned width,
+                            const struct video_csc *k) {
+  for (; x < width; x++) {
+    dst[x] = yuv_to_argb(k, y[x], u[x / 2], v[x / 2]);
+  }
+}
+
+static void row_scalar(uint32_t *dst, const uint8_t *y, const uint8_t *u,
+                       const uint8_t *v, unsigned width,
+                       const struct video_csc *k) {
+  unsigned x = 0;
+
+  // Two pixels share one chroma sample
+  for (; x + 2 <= width; x += 2) {
+    int U = u[x / 2];
+    int V = v[x / 2];
+    dst[x] = yuv_to_argb(k, y[x], U, V);
+    dst[x + 1] = yuv_to_argb(k, y[x + 1], U, V);
+  }
+  row_scalar_from(dst, y, u, v, x, width, k);
+}
+
+// YUV444P: one chroma sample per pixel (u and v are width samples long)
+static void row444_scalar_from(uint32_t *dst, const uint8_t *y,
+                               const uint8_t *u, const uint8_t *v, unsigned x,
+                               unsigned width, const struct video_csc *k) {
+  for (; x < width; x++) {
+    dst[x] = yuv_to_argb(k, y[x], u[x], v[x]);
+  }
+}
+
+static void row444_scalar(uint32_t *dst, const uint8_t *y, const uint8_t *u,
+                          const uint8_t *v, unsigned width,
+                          const struct video_csc *k) {
+  row444_scalar_from(dst, y, u, v, 0, width, k);
+}
+
+// 4x4 ordered dither (Bayer), 0..15. R/B add >> 1, G adds >> 2, which is
+// just under one LSB of the 5/6-bit result.
+static const uint8_t g_bayer4[4][4] = {
+    {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+static inline uint16_t rgb_to_565(int R, int G, int B, unsigned d, bool swap) {
+  unsigned r = clamp_u8(R) + (d >> 1);
+  unsigned g = clamp_u8(G) + (d >> 2);
+  unsigned b = clamp_u8(B) + (d >> 1);
+  if (r > 255) r = 255;
+  if (g > 255) g = 255;
+  if (b > 255) b = 255;
+
+  uint16_t px = (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+  return swap ? (uint16_t)((px << 8) | (px >> 8)) : px;
+}
+
+static inline uint16_t yuv_to_565(const struct video_csc *k, int Y, int U,
+                                  int V, unsigned d, bool swap) {
+  int C = Y - k->y_off;
+  int D = U - 128;
+  int E = V - 128;
+
+  return rgb_to_565((k->cy * C + k->crv * E + 128) >> 8,
+                    (k->cy * C - k->cgu * D - k->cgv * E + 128) >> 8,
+                    (k->cy * C + k->cbu * D + 128) >> 8, d, swap);
+}
+
+static void row565_scalar_from(uint16_t *dst, const uint8_t *y,
+                               const uint8_t *u, const uint8_t *v, unsigned x,
+                               unsigned width, const uint8_t *bayer, bool swap,
+                               const struct video_csc *k) {
+  for (; x < width; x++) {
+    dst[x] = yuv_to_565(k, y[x], u[x / 2], v[x / 2],
+                        bayer ? bayer[x & 3] : 0, swap);
+  }
+}
+
+static void row565_scalar(uint16_t *dst, const uint8_t *y, const uint8_t *u,
+                          const uint8_t *v, unsigned width,
+                          const uint8_t *bayer, bool swap,
+                          const struct video_csc *k) {
+  row565_scalar_from(dst, y, u, v, 0, width, bayer, swap, k);
+}
+
+static void row565_444_scalar_from(uint16_t *dst, const uint8_t *y,
+                                   const uint8_t *u, const uint8_t *v,
+                                   unsigned x, unsigned width,
+                                   const uint8_t *bayer, bool swap,
+                                   const struct video_csc *k) {
+  for (; x < width; x++) {
+    dst[x] = yuv_to_565(k, y[x], u[x], v[x], bayer ? bayer[x & 3] : 0, swap);
+  }
+}
+
+static void row565_444_scalar(uint16_t *dst, const uint8_t *y,
+                              const uint8_t *u, const uint8_t *v,
+                              unsigned width, const uint8_t *bayer, bool swap,
+                              const struct video_csc *k) {
+  row565_444_scalar_from(dst, y, u, v, 0, width, bayer, swap, k);
+}
+
+// ============================================================================
+// LUT (no multiplies, for cores without SIMD)
+// ============================================================================
+
+static void row_lut(uint32_t *dst, const uint8_t *y, const uint8_t *u,
+                    const uint8_t *v, unsigned width,
+                    const struct video_csc *k) {
+  const uint8_t *clamp = g_clamp_lut + CLAMP_LUT_OFF;
+
+  for (unsigned x = 0; x < width; x++) {
+    // Chroma terms are shared by the pair; the compiler hoists them
+    int U = u[x / 2], V = v[x / 2];
+    int32_t rv = k->lut_rv[V];
+    int32_t guv = k->lut_gu[U] + k->lut_gv[V];
+    int32_t bu = k->lut_bu[U];
+    int32_t yy = k->lut_y[y[x]];
+
+    dst[x] = 0xFF000000u | ((uint32_t)clamp[(yy + rv) >> 8] << 16) |
+             ((uint32_t)clamp[(yy + guv) >> 8] << 8) | clamp[(yy + bu) >> 8];
+  }
+}
+
+static void row565_lut(uint16_t *dst, const uint8_t *y, const uint8_t *u,
+                       const uint8_t *v, unsigned width, const uint8_t *bayer,
+                       bool swap, const struct video_csc *k) {
+  const uint8_t *clamp = g_clamp_lut + CLAMP_LUT_OFF;
+  const uint8_t *q5[4], *q6[4];
+
+  for (int i = 0; i < 4; i++) {
+    unsigned d = bayer ? bayer[i] : 0;
+    q5[i] = g_q5_lut[d >> 1];
+    q6[i] = g_q6_lut[d >> 2];
+  }
+
+  for (unsigned x = 0; x < width; x++) {
+    int U = u[x / 2], V = v[x / 2];
+    int32_t yy = k->lut_y[y[x]];
+    const uint8_t *d5 = q5[x & 3];
+
+    unsigned r = clamp[(yy + k->lut_rv[V]) >> 8];
+    unsigned g = clamp[(yy + k->lut_gu[U] + k->lut_gv[V]) >> 8];
+    unsigned b = clamp[(yy + k->lut_bu[U]) >> 8];
+
+    uint16_t px = (uint16_t)((d5[r] << 11) | (q6[x & 3][g] << 5) | d5[b]);
+    dst[x] = swap ? (uint16_t)((px << 8) | (px >> 8)) : px;
+  }
+}
+
+// ============================================================================
+// Source layout helpers: bring other 4:2:0 / 4:2:2 layouts into planar rows
+// (luma at w, chroma at (w + 1) / 2) for the row kernels
+// ============================================================================
+
+// NV12/NV21 chroma row: n interleaved pairs -> two planar rows
+static void uv_scalar(uint8_t *u, uint8_t *v, const uint8_t *uv, unsigned n) {
+  for (unsigned i = 0; i < n; i++) {
+    u[i] = uv[2 * i];
+    v[i] = uv[2 * i + 1];
+  }
+}
+
+// YUYV422 / UYVY422 row of w pixels -> planar Y, U, V
+static void packed422_scalar(uint8_t *y, uint8_t *u, uint8_t *v,
+                             const uint8_t *src, unsigned w, bool uyvy) {
+  unsigned yo = uyvy ? 1 : 0;
+  unsigned co = uyvy ? 0 : 1;
+
+  for (unsigned i = 0; 2 * i < w; i++) {
+    const uint8_t *p = src + 4 * i;
+    y[2 * i] = p[yo];
+    if (2 * i + 1 < w) y[2 * i + 1] = p[yo + 2];
+    u[i] = p[co];
+    v[i] = p[co + 2];
+  }
+}
+
+typedef void (*video_uv_fn)(uint8_t *u, uint8_t *v, const uint8_t *uv,
+                            unsigned n);
+typedef void (*video_packed422_fn)(uint8_t *y, uint8_t *u, uint8_t *v,
+                                   const uint8_t *src, unsigned w, bool uyvy);
+
+void video_convert_yuv420p_to_argb8888_ref(uint8_t *dst,
+                                           const struct vidframe *vf) {
+  int w = vf->size.w;
+  int h = vf->size.h;
+  const uint8_t *y_plane = vf->data[0];
+  const uint8_t *u_plane = vf->data[1];
+  const uint8_t *v_plane = vf->data[2];
+  int y_stride = vf->linesize[0];
+  int u_stride = vf->linesize[1];
+  int v_stride = vf->linesize[2];
+  uint32_t *d = (uint32_t *)dst;
+
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      int Y = y_plane[y * y_stride + x];
+      int U = u_plane[(y / 2) * u_stride + (x / 2)];
+      int V = v_plane[(y / 2) * v_stride + (x / 2)];
+
+      int C = Y - 16;
+      int D = U - 128;
+      int E = V - 128;
+
+      int R = (298 * C + 409 * E + 128) >> 8;
+      int G = (298 * C - 100 * D - 208 * E + 128) >> 8;
+      int B = (298 * C + 516 * D + 128) >> 8;
+
+      if (R < 0) R = 0; else if (R > 255) R = 255;
+      if (G < 0) G = 0; else if (G > 255) G = 255;
+      if (B < 0) B = 0; else if (B > 255) B = 255;
+
+      *d++ = (0xFF000000) | (R << 16) | (G << 8) | B;
+    }
+  }
+}
+
+// ============================================================================
+// SSE2 (16 pixels per iteration)
+// ============================================================================
+#ifdef VIDEO_HAVE_X86
+
+// Coefficient pairs for madd: (cy, crv), (cy, cbu), (cy, -cgu), (-cgv, 128)
+static inline uint32_t csc_pair(int lo, int hi) {
+  return ((uint32_t)(uint16_t)hi << 16) | (uint16_t)lo;
+}
+
+struct sse2_csc {
+  __m128i k_r, k_b, k_g1, k_g2, off_y;
+};
+
+SSE2_FN static inline void sse2_csc_load(struct sse2_csc *m,
+                                         const struct video_csc *k) {
+  m->k_r = _mm_set1_epi32((int)csc_pair(k->cy, k->crv));
+  m->k_b = _mm_set1_epi32((int)csc_pair(k->cy, k->cbu));
+  m->k_g1 = _mm_set1_epi32((int)csc_pair(k->cy, -k->cgu));
+  m->k_g2 = _mm_set1_epi32((int)csc_pair(-k->cgv, 128));
+  m->off_y = _mm_set1_epi16(k->y_off);
+}
+
+// 8 pixels: C = Y-y_off, D = U-128, E = V-128 as int16 -> R/G/B as int16.
+// madd keeps the exact 32-bit intermediate of the scalar path.
+SSE2_FN static inline void sse2_yuv8(const struct sse2_csc *m, __m128i c,
+                                     __m128i d, __m128i e, __m128i *r,
+                                     __m128i *g, __m128i *b) {
+  const __m128i k_r = m->k_r;
+  const __m128i k_b = m->k_b;
+  const __m128i k_g1 = m->k_g1;
+  const __m128i k_g2 = m->k_g2;
+  const __m128i rnd = _mm_set1_epi32(128);
+  const __m128i one = _mm_set1_epi16(1);
+
+  __m128i ce_lo = _mm_unpacklo_epi16(c, e);
+  __m128i ce_hi = _mm_unpackhi_epi16(c, e);
+  __m128i cd_lo = _mm_unpacklo_epi16(c, d);
+  __m128i cd_hi = _mm_unpackhi_epi16(c, d);
+  __m128i e1_lo = _mm_unpacklo_epi16(e, one);
+  __m128i e1_hi = _mm_unpackhi_epi16(e, one);
+
+  __m128i r_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ce_lo, k_r), rnd), 8);
+  __m128i r_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ce_hi, k_r), rnd), 8);
+  __m128i b_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_lo, k_b), rnd), 8);
+  __m128i b_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_hi, k_b), rnd), 8);
+  // -cgv*E + 1*128 carries the rounding term for G
+  __m128i g_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_lo, k_g1),
+                                              _mm_madd_epi16(e1_lo, k_g2)), 8);
+  __m128i g_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cd_hi, k_g1),
+                                              _mm_madd_epi16(e1_hi, k_g2)), 8);
+
+  *r = _mm_packs_epi32(r_lo, r_hi);
+  *g = _mm_packs_epi32(g_lo, g_hi);
+  *b = _mm_packs_epi32(b_lo, b_hi);
+}
+
+// Chroma of 16 pixels from x: one sample each (4:4:4), or 8 used twice
+SSE2_FN static inline __m128i sse2_chroma16(const uint8_t *c, unsigned x,
+                                            bool c444) {
+  if (c444) return _mm_loadu_si128((const __m128i *)(c + x));
+
+  __m128i c8 = _mm_loadl_epi64((const __m128i *)(c + x / 2));
+  return _mm_unpacklo_epi8(c8, c8);
+}
+
+// 16-pixel blocks of a row; returns where the scalar tail starts
+SSE2_FN static inline unsigned row_sse2_body(uint32_t *dst, const uint8_t *y,
+                                             const uint8_t *u,
+                                             const uint8_t *v, unsigned width,
+                                             const struct video_csc *k,
+                                             bool c444) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha = _mm_set1_epi8((char)0xFF);
+  const __m128i off_c = _mm_set1_epi16(128);
+  struct sse2_csc m;
+  unsigned x = 0;
+
+  sse2_csc_load(&m, k);
+  const __m128i off_y = m.off_y;
+
+  for (; x + 16 <= width; x += 16) {
+    __m128i y8 = _mm_loadu_si128((const __m128i *)(y + x));
+    __m128i u8 = sse2_chroma16(u, x, c444);
+    __m128i v8 = sse2_chroma16(v, x, c444);
+
+    __m128i c0 = _mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), off_y);
+    __m128i c1 = _mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), off_y);
+    __m128i d0 = _mm_sub_epi16(_mm_unpacklo_epi8(u8, zero), off_c);
+    __m128i d1 = _mm_sub_epi16(_mm_unpackhi_epi8(u8, zero), off_c);
+    __m128i e0 = _mm_sub_epi16(_mm_unpacklo_epi8(v8, zero), off_c);
+    __m128i e1 = _mm_sub_epi16(_mm_unpackhi_epi8(v8, zero), off_c);
+
+    __m128i r0, g0, b0, r1, g1, b1;
+    sse2_yuv8(&m, c0, d0, e0, &r0, &g0, &b0);
+    sse2_yuv8(&m, c1, d1, e1, &r1, &g1, &b1);
+
+    // Saturating pack == clamp to [0, 255]
+    __m128i r8 = _mm_packus_epi16(r0, r1);
+    __m128i g8 = _mm_packus_epi16(g0, g1);
+    __m128i b8 = _mm_packus_epi16(b0, b1);
+
+    __m128i bg_lo = _mm_unpacklo_epi8(b8, g8);
+    __m128i bg_hi = _mm_unpackhi_epi8(b8, g8);
+    __m128i ra_lo = _mm_unpacklo_epi8(r8, alpha);
+    __m128i ra_hi = _mm_unpackhi_epi8(r8, alpha);
+
+    __m128i *out = (__m128i *)(dst + x);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bg_lo, ra_lo));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bg_lo, ra_lo));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bg_hi, ra_hi));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bg_hi, ra_hi));
+  }
+  return x;
+}
+
+SSE2_FN static void row_sse2(uint32_t *dst, const uint8_t *y, const uint8_t *u,
+                             const uint8_t *v, unsigned width,
+                             const struct video_csc *k) {
+  unsigned x = row_sse2_body(dst, y, u, v, width, k, false);
+  row_scalar_from(dst, y, u, v, x, width, k);
+}
+
+SSE2_FN static void row444_sse2(uint32_t *dst, const uint8_t *y,
+                                const uint8_t *u, const uint8_t *v,
+                                unsigned width, const struct video_csc *k) {
+  unsigned x = row_sse2_body(dst, y, u, v, width, k, true);
+  row444_scalar_from(dst, y, u, v, x, width, k);
+}
+
+// Clamp, dither and pack 8 pixels to RGB565
+SSE2_FN static inline __m128i sse2_pack565(__m128i r, __m128i g, __m128i b,
+                                          __m128i d_rb, __m128i d_g,
+                                          bool swap) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i max = _mm_set1_epi16(255);
+
+  r = _mm_min_epi16(_mm_add_epi16(_mm_min_epi16(_mm_max_epi16(r, zero), max), d_rb), max);
+  g = _mm_min_epi16(_mm_add_epi16(_mm_min_epi16(_mm_max_epi16(g, zero), max), d_g), max);
+  b = _mm_min_epi16(_mm_add_epi16(_mm_min_epi16(_mm_max_epi16(b, zero), max), d_rb), max);
+
+  __m128i px = _mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(r, 3), 11),
+                            _mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(g, 2), 5),
+                                         _mm_srli_epi16(b, 3)));
+  if (swap) px = _mm_or_si128(_mm_slli_epi16(px, 8), _mm_srli_epi16(px, 8));
+  return px;
+}
+
+SSE2_FN static inline unsigned row565_sse2_body(uint16_t *dst,
+                                                const uint8_t *y,
+                                                const uint8_t *u,
+                                                const uint8_t *v,
+                                                unsigned width,
+                                                const uint8_t *bayer,
+                                                bool swap,
+                                                const struct video_csc *k,
+                                                bool c444) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i off_c = _mm_set1_epi16(128);
+  __m128i d_rb = zero, d_g = zero;
+  struct sse2_csc m;
+  unsigned x = 0;
+
+  sse2_csc_load(&m, k);
+  const __m128i off_y = m.off_y;
+
+  // Blocks start on multiples of 16, so the 4-wide pattern stays aligned
+  if (bayer) {
+    d_rb = _mm_setr_epi16(bayer[0] >> 1, bayer[1] >> 1, bayer[2] >> 1,
+                          bayer[3] >> 1, bayer[0] >> 1, bayer[1] >> 1,
+                          bayer[2] >> 1, bayer[3] >> 1);
+    d_g = _mm_setr_epi16(bayer[0] >> 2, bayer[1] >> 2, bayer[2] >> 2,
+                         bayer[3] >> 2, bayer[0] >> 2, bayer[1] >> 2,
+                         bayer[2] >> 2, bayer[3] >> 2);
+  }
+
+  for (; x + 16 <= width; x += 16) {
+    __m128i y8 = _mm_loadu_si128((const __m128i *)(y + x));
+    __m128i u8 = sse2_chroma16(u, x, c444);
+    __m128i v8 = sse2_chroma16(v, x, c444);
+
+    __m128i c0 = _mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), off_y);
+    __m128i c1 = _mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), off_y);
+    __m128i d0 = _mm_sub_epi16(_mm_unpacklo_epi8(u8, zero), off_c);
+    __m128i d1 = _mm_sub_epi16(_mm_unpackhi_epi8(u8, zero), off_c);
+    __m128i e0 = _mm_sub_epi16(_mm_unpacklo_epi8(v8, zero), off_c);
+    __m128i e1 = _mm_sub_epi16(_mm_unpackhi_epi8(v8, zero), off_c);
+
+    __m128i r0, g0, b0, r1, g1, b1;
+    sse2_yuv8(&m, c0, d0, e0, &r0, &g0, &b0);
+    sse2_yuv8(&m, c1, d1, e1, &r1, &g1, &b1);
+
+    __m128i *out = (__m128i *)(dst + x);
+    _mm_storeu_si128(out + 0, sse2_pack565(r0, g0, b0, d_rb, d_g, swap));
+    _mm_storeu_si128(out + 1, sse2_pack565(r1, g1, b1, d_rb, d_g, swap));
+  }
+  return x;
+}
+
+SSE2_FN static void row565_sse2(uint16_t *dst, const uint8_t *y,
+                                const uint8_t *u, const uint8_t *v,
+                                unsigned width, const uint8_t *bayer,
+                                bool swap, const struct video_csc *k) {
+  unsigned x =
+      row565_sse2_body(dst, y, u, v, width, bayer, swap, k, false);
+  row565_scalar_from(dst, y, u, v, x, width, bayer, swap, k);
+}
+
+SSE2_FN static void row565_444_sse2(uint16_t *dst, const uint8_t *y,
+                                    const uint8_t *u, const uint8_t *v,
+                                    unsigned width, const uint8_t *bayer,
+                                    bool swap, const struct video_csc *k) {
+  unsigned x = row565_sse2_body(dst, y, u, v, width, bayer, swap, k, true);
+  row565_444_scalar_from(dst, y, u, v, x, width, bayer, swap, k);
+}
+
+SSE2_FN static void uv_sse2(uint8_t *u, uint8_t *v, const uint8_t *uv,
+                            unsigned n) {
+  const __m128i mask = _mm_set1_epi16(0x00FF);
+  unsigned i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(uv + 2 * i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(uv + 2 * i + 16));
+
+    _mm_storeu_si128((__m128i *)(u + i),
+                     _mm_packus_epi16(_mm_and_si128(a, mask),
+                                      _mm_and_si128(b, mask)));
+    _mm_storeu_si128((__m128i *)(v + i),
+                     _mm_packus_epi16(_mm_srli_epi16(a, 8),
+                                      _mm_srli_epi16(b, 8)));
+  }
+  uv_scalar(u + i, v + i, uv + 2 * i, n - i);
+}
+
+SSE2_FN static void packed422_sse2(uint8_t *y, uint8_t *u, uint8_t *v,
+                                   const uint8_t *src, unsigned w, bool uyvy) {
+  const __m128i mask = _mm_set1_epi16(0x00FF);
+  const __m128i zero = _mm_setzero_si128();
+  unsigned i = 0;
+
+  for (; i + 16 <= w; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(src + 2 * i + 16));
+    __m128i even = _mm_packus_epi16(_mm_and_si128(a, mask),
+                                    _mm_and_si128(b, mask));
+    __m128i odd = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+    __m128i c = uyvy ? even : odd; // U V U V ...
+
+    _mm_storeu_si128((__m128i *)(y + i), uyvy ? odd : even);
+    _mm_storel_epi64((__m128i *)(u + i / 2),
+                     _mm_packus_epi16(_mm_and_si128(c, mask), zero));
+    _mm_storel_epi64((__m128i *)(v + i / 2),
+                     _mm_packus_epi16(_mm_srli_epi16(c, 8), zero));
+  }
+  packed422_scalar(y + i, u + i / 2, v + i / 2, src + 2 * i, w - i, uyvy);
+}
+
+// ============================================================================
+// AVX2 (32 pixels per iteration)
+// ============================================================================
+
+// 16 pixels in order -> R/G/B as int16 in order. unpack and pack both work
+// per 128-bit lane, so the lane split cancels out.
+struct avx2_csc {
+  __m256i k_r, k_b, k_g1, k_g2, off_y;
+};
+
+AVX2_FN static inline void avx2_csc_load(struct avx2_csc *m,
+                                         const struct video_csc *k) {
+  m->k_r = _mm256_set1_epi32((int)csc_pair(k->cy, k->crv));
+  m->k_b = _mm256_set1_epi32((int)csc_pair(k->cy, k->cbu));
+  m->k_g1 = _mm256_set1_epi32((int)csc_pair(k->cy, -k->cgu));
+  m->k_g2 = _mm256_set1_epi32((int)csc_pair(-k->cgv, 128));
+  m->off_y = _mm256_set1_epi16(k->y_off);
+}
+
+AVX2_FN static inline void avx2_yuv16(const struct avx2_csc *m, __m256i c,
+                                      __m256i d, __m256i e, __m256i *r,
+                                      __m256i *g, __m256i *b) {
+  const __m256i k_r = m->k_r;
+  const __m256i k_b = m->k_b;
+  const __m256i k_g1 = m->k_g1;
+  const __m256i k_g2 = m->k_g2;
+  const __m256i rnd = _mm256_set1_epi32(128);
+  const __m256i one = _mm256_set1_epi16(1);
+
+  __m256i ce_lo = _mm256_unpacklo_epi16(c, e);
+  __m256i ce_hi = _mm256_unpackhi_epi16(c, e);
+  __m256i cd_lo = _mm256_unpacklo_epi16(c, d);
+  __m256i cd_hi = _mm256_unpackhi_epi16(c, d);
+  __m256i e1_lo = _mm256_unpacklo_epi16(e, one);
+  __m256i e1_hi = _mm256_unpackhi_epi16(e, one);
+
+  __m256i r_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ce_lo, k_r), rnd), 8);
+  __m256i r_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ce_hi, k_r), rnd), 8);
+  __m256i b_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cd_lo, k_b), rnd), 8);
+  __m256i b_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cd_hi, k_b), rnd), 8);
+  __m256i g_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cd_lo, k_g1),
+                                                    _mm256_madd_epi16(e1_lo, k_g2)), 8);
+  __m256i g_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cd_hi, k_g1),
+                                                    _mm256_madd_epi16(e1_hi, k_g2)), 8);
+
+  *r = _mm256_packs_epi32(r_lo, r_hi);
+  *g = _mm256_packs_epi32(g_lo, g_hi);
+  *b = _mm256_packs_epi32(b_lo, b_hi);
+}
+
+AVX2_FN static inline void avx2_load16(const struct avx2_csc *m,
+                                       const uint8_t *y, const uint8_t *u,
+                                       const uint8_t *v, __m256i *c,
+                                       __m256i *d, __m256i *e) {
+  __m128i u8 = _mm_loadl_epi64((const __m128i *)u);
+  __m128i v8 = _mm_loadl_epi64((const __m128i *)v);
+
+  *c = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)y)),
+                        m->off_y);
+  *d = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8)),
+                        _mm256_set1_epi16(128));
+  *e = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8)),
+                        _mm256_set1_epi16(128));
+}
+
+AVX2_FN static void row_avx2(uint32_t *dst, const uint8_t *y, const uint8_t *u,
+                             const uint8_t *v, unsigned width,
+                             const struct video_csc *k) {
+  const __m256i alpha = _mm256_set1_epi8((char)0xFF);
+  struct avx2_csc m;
+  unsigned x = 0;
+
+  avx2_csc_load(&m, k);
+
+  for (; x + 32 <= width; x += 32) {
+    __m256i c0, d0, e0, c1, d1, e1;
+    __m256i r0, g0, b0, r1, g1, b1;
+
+    avx2_load16(&m, y + x, u + x / 2, v + x / 2, &c0, &d0, &e0);
+    avx2_load16(&m, y + x + 16, u + x / 2 + 8, v + x / 2 + 8, &c1, &d1, &e1);
+    avx2_yuv16(&m, c0, d0, e0, &r0, &g0, &b0);
+    avx2_yuv16(&m, c1, d1, e1, &r1, &g1, &b1);
+
+    // Bytes per lane: lane0 = [0..7, 16..23], lane1 = [8..15, 24..31]
+    __m256i r8 = _mm256_packus_epi16(r0, r1);
+    __m256i g8 = _mm256_packus_epi16(g0, g1);
+    __m256i b8 = _mm256_packus_epi16(b0, b1);
+
+    // lo: lane0 = px 0..7, lane1 = px 8..15; hi: px 16..23 / 24..31
+    __m256i bg_lo = _mm256_unpacklo_epi8(b8, g8);
+    __m256i bg_hi = _mm256_unpackhi_epi8(b8, g8);
+    __m256i ra_lo = _mm256_unpacklo_epi8(r8, alpha);
+    __m256i ra_hi = _mm256_unpackhi_epi8(r8, alpha);
+
+    // Each: lane0 = 4 px, lane1 = the 4 px eight positions later
+    __m256i p0 = _mm256_unpacklo_epi16(bg_lo, ra_lo); // 0..3   | 8..11
+    __m256i p1 = _mm256_unpackhi_epi16(bg_lo, ra_lo); // 4..7   | 12..15
+    __m256i p2 = _mm256_unpacklo_epi16(bg_hi, ra_hi); // 16..19 | 24..27
+    __m256i p3 = _mm256_unpackhi_epi16(bg_hi, ra_hi); // 20..23 | 28..31
+
+    __m256i *out = (__m256i *)(dst + x);
+    _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+  }
+
+  // Remaining 16..31 pixels via SSE2, then scalar
+  if (x < width) {
+    row_sse2(dst + x, y + x, u + x / 2, v + x / 2, width - x, k);
+  }
+}
+
+#endif // VIDEO_HAVE_X86
+
+// ============================================================================
+// NEON (16 pixels per iteration)
+// ============================================================================
+#ifdef VIDEO_HAVE_NEON
+
+// vrshrn_n_s32(x, 8) == (x + 128) >> 8, narrowed without saturation
+static inline uint8x8_t neon_pack(int32x4_t lo, int32x4_t hi) {
+  return vqmovun_s16(vcombine_s16(vrshrn_n_s32(lo, 8), vrshrn_n_s32(hi, 8)));
+}
+
+static inline void neon_yuv8(const struct video_csc *k, int16x8_t c,
+                             int16x8_t d, int16x8_t e, uint8x8x4_t *px) {
+  int16x4_t c_lo = vget_low_s16(c), c_hi = vget_high_s16(c);
+  int16x4_t d_lo = vget_low_s16(d), d_hi = vget_high_s16(d);
+  int16x4_t e_lo = vget_low_s16(e), e_hi = vget_high_s16(e);
+
+  int32x4_t yl = vmull_n_s16(c_lo, k->cy);
+  int32x4_t yh = vmull_n_s16(c_hi, k->cy);
+
+  int32x4_t r_lo = vmlal_n_s16(yl, e_lo, k->crv);
+  int32x4_t r_hi = vmlal_n_s16(yh, e_hi, k->crv);
+  int32x4_t g_lo = vmlsl_n_s16(vmlsl_n_s16(yl, d_lo, k->cgu), e_lo, k->cgv);
+  int32x4_t g_hi = vmlsl_n_s16(vmlsl_n_s16(yh, d_hi, k->cgu), e_hi, k->cgv);
+  int32x4_t b_lo = vmlal_n_s16(yl, d_lo, k->cbu);
+  int32x4_t b_hi = vmlal_n_s16(yh, d_hi, k->cbu);
+
+  px->val[0] = neon_pack(b_lo, b_hi);
+  px->val[1] = neon_pack(g_lo, g_hi);
+  px->val[2] = neon_pack(r_lo, r_hi);
+  px->val[3] = vdup_n_u8(0xFF);
+}
+
+// Chroma of 16 pixels from x as two halves: one sample each (4:4:4), or 8
+// used twice
+static inline uint8x8x2_t neon_chroma16(const uint8_t *c, unsigned x,
+                                        bool c444) {
+  if (c444) {
+    uint8x16_t q = vld1q_u8(c + x);
+    uint8x8x2_t r = {{vget_low_u8(q), vget_high_u8(q)}};
+    return r;
+  }
+  return vzip_u8(vld1_u8(c + x / 2), vld1_u8(c + x / 2));
+}
+
+// 16-pixel blocks of a row; returns where the scalar tail starts
+static inline unsigned row_neon_body(uint32_t *dst, const uint8_t *y,
+                                     const uint8_t *u, const uint8_t *v,
+                                     unsigned width, const struct video_csc *k,
+                                     bool c444) {
+  const uint8x8_t off_y = vdup_n_u8((uint8_t)k->y_off);
+  const uint8x8_t off_c = vdup_n_u8(128);
+  unsigned x = 0;
+
+  for (; x + 16 <= width; x += 16) {
+    uint8x16_t y16 = vld1q_u8(y + x);
+    uint8x8x2_t uu = neon_chroma16(u, x, c444);
+    uint8x8x2_t vv = neon_chroma16(v, x, c444);
+    uint8x8x4_t px;
+
+    // Widening subtract wraps in uint16; reinterpreting gives the signed value
+    for (int i = 0; i < 2; i++) {
+      uint8x8_t yy = i ? vget_high_u8(y16) : vget_low_u8(y16);
+      int16x8_t c = vreinterpretq_s16_u16(vsubl_u8(yy, off_y));
+      int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(uu.val[i], off_c));
+      int16x8_t e = vreinterpretq_s16_u16(vsubl_u8(vv.val[i], off_c));
+
+      neon_yuv8(k, c, d, e, &px);
+      vst4_u8((uint8_t *)(dst + x + i * 8), px);
+    }
+  }
+  return x;
+}
+
+static void row_neon(uint32_t *dst, const uint8_t *y, const uint8_t *u,
+                     const uint8_t *v, unsigned width,
+                     const struct video_csc *k) {
+  unsigned x = row_neon_body(dst, y, u, v, width, k, false);
+  row_scalar_from(dst, y, u, v, x, width, k);
+}
+
+static void row444_neon(uint32_t *dst, const uint8_t *y, const uint8_t *u,
+                        const uint8_t *v, unsigned width,
+                        const struct video_csc *k) {
+  unsigned x = row_neon_body(dst, y, u, v, width, k, true);
+  row444_scalar_from(dst, y, u, v, x, width, k);
+}
+
+static inline unsigned row565_neon_body(uint16_t *dst, const uint8_t *y,
+                                        const uint8_t *u, const uint8_t *v,
+                                        unsigned width, const uint8_t *bayer,
+                                        bool swap, const struct video_csc *k,
+                                        bool c444) {
+  const uint8x8_t off_y = vdup_n_u8((uint8_t)k->y_off);
+  const uint8x8_t off_c = vdup_n_u8(128);
+  uint8_t rb_pat[8] = {0}, g_pat[8] = {0};
+  unsigned x = 0;
+
+  if (bayer) {
+    for (int i = 0; i < 8; i++) {
+      rb_pat[i] = bayer[i & 3] >> 1;
+      g_pat[i] = bayer[i & 3] >> 2;
+    }
+  }
+  const uint8x8_t d_rb = vld1_u8(rb_pat);
+  const uint8x8_t d_g = vld1_u8(g_pat);
+
+  for (; x + 16 <= width; x += 16) {
+    uint8x16_t y16 = vld1q_u8(y + x);
+    uint8x8x2_t uu = neon_chroma16(u, x, c444);
+    uint8x8x2_t vv = neon_chroma16(v, x, c444);
+    uint8x8x4_t px;
+
+    for (int i = 0; i < 2; i++) {
+      uint8x8_t yy = i ? vget_high_u8(y16) : vget_low_u8(y16);
+      int16x8_t c = vreinterpretq_s16_u16(vsubl_u8(yy, off_y));
+      int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(uu.val[i], off_c));
+      int16x8_t e = vreinterpretq_s16_u16(vsubl_u8(vv.val[i], off_c));
+
+      neon_yuv8(k, c, d, e, &px);
+
+      // Saturating add == min(channel + dither, 255)
+      uint8x8_t b5 = vshr_n_u8(vqadd_u8(px.val[0], d_rb), 3);
+      uint8x8_t g6 = vshr_n_u8(vqadd_u8(px.val[1], d_g), 2);
+      uint8x8_t r5 = vshr_n_u8(vqadd_u8(px.val[2], d_rb), 3);
+      uint16x8_t out = vorrq_u16(vshlq_n_u16(vmovl_u8(r5), 11),
+                                 vorrq_u16(vshlq_n_u16(vmovl_u8(g6), 5),
+                                           vmovl_u8(b5)));
+      if (swap) out = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(out)));
+      vst1q_u16(dst + x + i * 8, out);
+    }
+  }
+  return x;
+}
+
+static void row565_neon(uint16_t *dst, const uint8_t *y, const uint8_t *u,
+                        const uint8_t *v, unsigned width, const uint8_t *bayer,
+                        bool swap, const struct video_csc *k) {
+  unsigned x = row565_neon_body(dst, y, u, v, width, bayer, swap, k, false);
+  row565_scalar_from(dst, y, u, v, x, width, bayer, swap, k);
+}
+
+static void row565_444_neon(uint16_t *dst, const uint8_t *y, const uint8_t *u,
+                            const uint8_t *v, unsigned width,
+                            const uint8_t *bayer, bool swap,
+                            const struct video_csc *k) {
+  unsigned x = row565_neon_body(dst, y, u, v, width, bayer, swap, k, true);
+  row565_444_scalar_from(dst, y, u, v, x, width, bayer, swap, k);
+}
+
+static void uv_neon(uint8_t *u, uint8_t *v, const uint8_t *uv, unsigned n) {
+  unsigned i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    uint8x16x2_t p = vld2q_u8(uv + 2 * i);
+    vst1q_u8(u + i, p.val[0]);
+    vst1q_u8(v + i, p.val[1]);
+  }
+  uv_scalar(u + i, v + i, uv + 2 * i, n - i);
+}
+
+static void packed422_neon(uint8_t *y, uint8_t *u, uint8_t *v,
+                           const uint8_t *src, unsigned w, bool uyvy) {
+  unsigned i = 0;
+
+  for (; i + 16 <= w; i += 16) {
+    uint8x8x4_t p = vld4_u8(src + 2 * i); // 8 macropixels
+    uint8x8x2_t yy;
+
+    if (uyvy) {
+      yy.val[0] = p.val[1];
+      yy.val[1] = p.val[3];
+      vst1_u8(u + i / 2, p.val[0]);
+      vst1_u8(v + i / 2, p.val[2]);
+    } else {
+      yy.val[0] = p.val[0];
+      yy.val[1] = p.val[2];
+      vst1_u8(u + i / 2, p.val[1]);
+      vst1_u8(v + i / 2, p.val[3]);
+    }
+    vst2_u8(y + i, yy);
+  }
+  packed422_scalar(y + i, u + i / 2, v + i / 2, src + 2 * i, w - i, uyvy);
+}
+
+#endif // VIDEO_HAVE_NEON
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+static const char *g_kernel_names[VIDEO_KERNEL_COUNT] = {
+    "scalar", "lut", "sse2", "avx2", "neon"};
+
+static video_row_fn g_kernel_fns[VIDEO_KERNEL_COUNT] = {
+    row_scalar,
+    row_lut,
+#ifdef VIDEO_HAVE_X86
+    row_sse2,
+    row_avx2,
+#else
+    NULL,
+    NULL,
+#endif
+#ifdef VIDEO_HAVE_NEON
+    row_neon,
+#else
+    NULL,
+#endif
+};
+
+// RGB565 rows; AVX2 has no 565 variant and reuses SSE2
+static video_row565_fn g_kernel565_fns[VIDEO_KERNEL_COUNT] = {
+    row565_scalar,
+    row565_lut,
+#ifdef VIDEO_HAVE_X86
+    row565_sse2,
+    row565_sse2,
+#else
+    NULL,
+    NULL,
+#endif
+#ifdef VIDEO_HAVE_NEON
+    row565_neon,
+#else
+    NULL,
+#endif
+};
+
+// Layout helpers; AVX2 reuses SSE2 (they are load/store bound)
+#ifdef VIDEO_HAVE_X86
+#define X86_OR_NULL(fn) fn
+#else
+#define X86_OR_NULL(fn) NULL
+#endif
+#ifdef VIDEO_HAVE_NEON
+#define NEON_OR_NULL(fn) fn
+#else
+#define NEON_OR_NULL(fn) NULL
+#endif
+
+static video_uv_fn g_uv_fns[VIDEO_KERNEL_COUNT] = {
+    uv_scalar, uv_scalar, X86_OR_NULL(uv_sse2), X86_OR_NULL(uv_sse2),
+    NEON_OR_NULL(uv_neon)};
+static video_packed422_fn g_packed422_fns[VIDEO_KERNEL_COUNT] = {
+    packed422_scalar, packed422_scalar, X86_OR_NULL(packed422_sse2),
+    X86_OR_NULL(packed422_sse2), NEON_OR_NULL(packed422_neon)};
+
+// YUV444P rows, chroma at full width; LUT uses the scalar rows and AVX2
+// the SSE2 ones
+static video_row_fn g_row444_fns[VIDEO_KERNEL_COUNT] = {
+    row444_scalar, row444_scalar, X86_OR_NULL(row444_sse2),
+    X86_OR_NULL(row444_sse2), NEON_OR_NULL(row444_neon)};
+static video_row565_fn g_row565_444_fns[VIDEO_KERNEL_COUNT] = {
+    row565_444_scalar, row565_444_scalar, X86_OR_NULL(row565_444_sse2),
+    X86_OR_NULL(row565_444_sse2), NEON_OR_NULL(row565_444_neon)};
+
+static video_kernel_t g_kernel = VIDEO_KERNEL_SCALAR;
+static video_row_fn g_row = row_scalar;
+static video_row565_fn g_row565 = row565_scalar;
+static bool g_dither = true;
+
+bool video_convert_kernel_supported(video_kernel_t kernel) {
+  if (kernel >= VIDEO_KERNEL_COUNT || !g_kernel_fns[kernel]) return false;
+
+  switch (kernel) {
+  case VIDEO_KERNEL_SCALAR:
+  case VIDEO_KERNEL_LUT:
+    return true;
+#ifdef VIDEO_HAVE_X86
+  case VIDEO_KERNEL_SSE2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+  case VIDEO_KERNEL_AVX2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+#ifdef VIDEO_HAVE_NEON
+  case VIDEO_KERNEL_NEON:
+#if defined(__aarch64__)
+    return true; // Mandatory on ARMv8-A
+#elif defined(HWCAP_NEON)
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+    return true;
+#endif
+#endif
+  default:
+    return false;
+  }
+}
+
+const char *video_convert_kernel_name(video_kernel_t kernel) {
+  if (kernel >= VIDEO_KERNEL_COUNT) return "unknown";
+  return g_kernel_names[kernel];
+}
+
+video_kernel_t video_convert_get_kernel(void) { return g_kernel; }
+
+int video_convert_set_kernel(video_kernel_t kernel) {
+  if (!video_convert_kernel_supported(kernel)) return ENOTSUP;
+
+  g_kernel = kernel;
+  g_row = g_kernel_fns[kernel];
+  g_row565 = g_kernel565_fns[kernel];
+  return 0;
+}
+
+void video_convert_set_dither(bool enable) { g_dither = enable; }
+
+size_t video_pix_bytes(video_pix_t pix) {
+  return pix == VIDEO_PIX_ARGB8888 ? 4 : 2;
+}
+
+const char *video_pix_name(video_pix_t pix) {
+  switch (pix) {
+  case VIDEO_PIX_ARGB8888:
+    return "ARGB8888";
+  case VIDEO_PIX_RGB565:
+    return "RGB565";
+  case VIDEO_PIX_RGB565_SWAP:
+    return "RGB565 (swapped)";
+  default:
+    return "unknown";
+  }
+}
+
+// One component of the source frame as an 8-bit sample grid. Interleaved
+// layouts (NV12, YUYV, RGB32) are described with a sample step > 1.
+struct video_plane {
+  const uint8_t *data;
+  unsigned stride; // Bytes per row
+  unsigned step;   // Bytes between samples
+  unsigned w, h;
+};
+
+static void plane_set(struct video_plane *p, const uint8_t *data,
+                      unsigned stride, unsigned step, unsigned w, unsigned h) {
+  p->data = data;
+  p->stride = stride;
+  p->step = step;
+  p->w = w;
+  p->h = h;
+}
+
+// Y, U, V planes (B, G, R for RGB32/ARGB)
+static bool src_setup(struct video_plane p[3], const struct vidframe *vf) {
+  unsigned w = vf->size.w, h = vf->size.h;
+  unsigned cw = (w + 1) / 2, ch = (h + 1) / 2;
+  const uint8_t *d0 = vf->data[0];
+  unsigned ls0 = vf->linesize[0];
+
+  switch (vf->fmt) {
+  case VID_FMT_YUV420P:
+  case VID_FMT_YUV422P:
+  case VID_FMT_YUV444P: {
+    unsigned pw = vf->fmt == VID_FMT_YUV444P ? w : cw;
+    unsigned ph = vf->fmt == VID_FMT_YUV420P ? ch : h;
+    plane_set(&p[0], d0, ls0, 1, w, h);
+    plane_set(&p[1], vf->data[1], vf->linesize[1], 1, pw, ph);
+    plane_set(&p[2], vf->data[2], vf->linesize[2], 1, pw, ph);
+    return true;
+  }
+  case VID_FMT_NV12:
+  case VID_FMT_NV21: {
+    unsigned uo = vf->fmt == VID_FMT_NV12 ? 0 : 1;
+    plane_set(&p[0], d0, ls0, 1, w, h);
+    plane_set(&p[1], vf->data[1] + uo, vf->linesize[1], 2, cw, ch);
+    plane_set(&p[2], vf->data[1] + (1 - uo), vf->linesize[1], 2, cw, ch);
+    return true;
+  }
+  case VID_FMT_YUYV422:
+    plane_set(&p[0], d0, ls0, 2, w, h);
+    plane_set(&p[1], d0 + 1, ls0, 4, cw, h);
+    plane_set(&p[2], d0 + 3, ls0, 4, cw, h);
+    return true;
+  case VID_FMT_UYVY422:
+    plane_set(&p[0], d0 + 1, ls0, 2, w, h);
+    plane_set(&p[1], d0, ls0, 4, cw, h);
+    plane_set(&p[2], d0 + 2, ls0, 4, cw, h);
+    return true;
+  case VID_FMT_RGB32:
+    // 0xXXRRGGBB words: B, G, R in memory on little endian
+    plane_set(&p[0], d0, ls0, 4, w, h);
+    plane_set(&p[1], d0 + 1, ls0, 4, w, h);
+    plane_set(&p[2], d0 + 2, ls0, 4, w, h);
+    return true;
+  case VID_FMT_ARGB:
+    // Big endian: A, R, G, B in memory
+    plane_set(&p[0], d0 + 3, ls0, 4, w, h);
+    plane_set(&p[1], d0 + 2, ls0, 4, w, h);
+    plane_set(&p[2], d0 + 1, ls0, 4, w, h);
+    return true;
+  default:
+    return false;
+  }
+}
+
+static inline bool fmt_is_rgb(enum vidfmt fmt) {
+  return fmt == VID_FMT_RGB32 || fmt == VID_FMT_ARGB;
+}
+
+bool video_convert_format_supported(enum vidfmt fmt) {
+  struct video_plane p[3];
+  struct vidframe vf;
+
+  memset(&vf, 0, sizeof(vf));
+  vf.fmt = fmt;
+  return src_setup(p, &vf);
+}
+
+struct convert_job {
+  uint8_t *dst;
+  size_t dst_stride; // bytes
+  unsigned dst_y0;   // Output row stored at dst (rows are dst_y0-relative)
+  video_pix_t pix;
+  unsigned dw, dh;
+  const struct vidframe *vf;
+  struct video_plane src[3];
+  video_scale_t mode;
+  const struct video_csc *csc;
+  video_row_fn row;
+  video_row565_fn row565;
+  video_uv_fn uv;
+  video_packed422_fn packed422;
+  bool dither;
+};
+
+// Convert one planar row (luma at dw, chroma at dw / 2, or at dw for
+// 4:4:4) into output row y
+static inline void emit_row(const struct convert_job *job, unsigned y,
+                            const uint8_t *yr, const uint8_t *ur,
+                            const uint8_t *vr) {
+  uint8_t *out = job->dst + (size_t)(y - job->dst_y0) * job->dst_stride;
+
+  if (job->pix == VIDEO_PIX_ARGB8888) {
+    job->row((uint32_t *)out, yr, ur, vr, job->dw, job->csc);
+  } else {
+    job->row565((uint16_t *)out, yr, ur, vr, job->dw,
+                job->dither ? g_bayer4[y & 3] : NULL,
+                job->pix == VIDEO_PIX_RGB565_SWAP, job->csc);
+  }
+}
+
+// RGB source row into output row y; samples are `step` bytes apart
+static void emit_rgb_row(const struct convert_job *job, unsigned y,
+                         const uint8_t *b, const uint8_t *g, const uint8_t *r,
+                         unsigned step) {
+  uint8_t *out = job->dst + (size_t)(y - job->dst_y0) * job->dst_stride;
+  unsigned w = job->dw;
+
+  if (job->pix == VIDEO_PIX_ARGB8888) {
+    uint32_t *d = (uint32_t *)out;
+
+    if (step == 4 && g == b + 1 && r == b + 2) {
+      // Pass-through, only the alpha byte is forced opaque
+      const uint32_t *s = (const uint32_t *)b;
+      for (unsigned x = 0; x < w; x++) d[x] = s[x] | 0xFF000000u;
+      return;
+    }
+    for (unsigned x = 0; x < w; x++) {
+      d[x] = 0xFF000000u | ((uint32_t)r[x * step] << 16) |
+             ((uint32_t)g[x * step] << 8) | b[x * step];
+    }
+  } else {
+    uint16_t *d = (uint16_t *)out;
+    const uint8_t *bayer = job->dither ? g_bayer4[y & 3] : NULL;
+    bool swap = job->pix == VIDEO_PIX_RGB565_SWAP;
+
+    for (unsigned x = 0; x < w; x++) {
+      d[x] = rgb_to_565(r[x * step], g[x * step], b[x * step],
+                        bayer ? bayer[x & 3] : 0, swap);
+    }
+  }
+}
+
+static void convert_stripe(void *arg, unsigned y0, unsigned y1) {
+  const struct convert_job *job = arg;
+  const struct vidframe *vf = job->vf;
+  unsigned w = vf->size.w, cw = (w + 1) / 2;
+  uint8_t y_line[VIDEO_SCALE_MAX_W];
+  uint8_t u_line[VIDEO_SCALE_MAX_W / 2];
+  uint8_t v_line[VIDEO_SCALE_MAX_W / 2];
+
+  for (unsigned y = y0; y < y1; y++) {
+    const uint8_t *yr = vf->data[0] + (size_t)y * vf->linesize[0];
+    const uint8_t *ur = u_line;
+    const uint8_t *vr = v_line;
+
+    switch (vf->fmt) {
+    case VID_FMT_YUV420P:
+      ur = vf->data[1] + (size_t)(y / 2) * vf->linesize[1];
+      vr = vf->data[2] + (size_t)(y / 2) * vf->linesize[2];
+      break;
+    case VID_FMT_YUV422P:
+    case VID_FMT_YUV444P:
+      ur = vf->data[1] + (size_t)y * vf->linesize[1];
+      vr = vf->data[2] + (size_t)y * vf->linesize[2];
+      break;
+    case VID_FMT_NV12:
+    case VID_FMT_NV21:
+      // Chroma rows are shared by two output rows
+      if (y == y0 || (y & 1) == 0) {
+        const uint8_t *uv = vf->data[1] + (size_t)(y / 2) * vf->linesize[1];
+        if (vf->fmt == VID_FMT_NV12)
+          job->uv(u_line, v_line, uv, cw);
+        else
+          job->uv(v_line, u_line, uv, cw);
+      }
+      break;
+    case VID_FMT_YUYV422:
+    case VID_FMT_UYVY422:
+      job->packed422(y_line, u_line, v_line, yr, w,
+                     vf->fmt == VID_FMT_UYVY422);
+      yr = y_line;
+      break;
+    default: { // RGB32 / ARGB, byte order from src_setup
+      size_t row = (size_t)y * vf->linesize[0];
+      emit_rgb_row(job, y, job->src[0].data + row, job->src[1].data + row,
+                   job->src[2].data + row, 4);
+      continue;
+    }
+    }
+
+    emit_row(job, y, yr, ur, vr);
+  }
+}
+
+static void job_init(struct convert_job *job, void *dst, size_t dst_stride,
+                     video_pix_t pix, video_csc_t csc,
+                     const struct vidframe *vf) {
+  memset(job, 0, sizeof(*job));
+  job->dst = dst;
+  job->dst_stride = dst_stride;
+  job->pix = pix;
+  job->dw = vf->size.w;
+  job->dh = vf->size.h;
+  job->vf = vf;
+  job->mode = VIDEO_SCALE_NONE;
+  job->csc = csc_get(csc);
+  job->row = g_row;
+  job->row565 = g_row565;
+  job->uv = g_uv_fns[g_kernel];
+  job->packed422 = g_packed422_fns[g_kernel];
+  // 4:4:4 keeps one chroma sample per pixel
+  if (vf->fmt == VID_FMT_YUV444P) {
+    job->row = g_row444_fns[g_kernel];
+    job->row565 = g_row565_444_fns[g_kernel];
+  }
+  job->dither = g_dither;
+}
+
+void video_convert_yuv420p_to_argb8888_rows(uint8_t *dst,
+                                            const struct vidframe *vf,
+                                            unsigned y0, unsigned y1) {
+  struct convert_job job;
+
+  job_init(&job, dst, (size_t)vf->size.w * 4, VIDEO_PIX_ARGB8888,
+           VIDEO_CSC_BT601_LIMITED, vf);
+  if (y1 > vf->size.h) y1 = vf->size.h;
+  convert_stripe(&job, y0, y1);
+}
+
+void video_convert_yuv420p_to_argb8888(uint8_t *dst,
+                                       const struct vidframe *vf) {
+  video_convert_yuv420p(dst, (size_t)vf->size.w * 4, VIDEO_PIX_ARGB8888, vf);
+}
+
+int video_convert_frame(void *dst, size_t dst_stride, video_pix_t pix,
+                        video_csc_t csc, const struct vidframe *vf) {
+  struct convert_job job;
+
+  if (!dst || !vf) return EINVAL;
+
+  job_init(&job, dst, dst_stride, pix, csc, vf);
+  if (!src_setup(job.src, vf)) return ENOTSUP;
+
+  // Only YUV420P is converted straight from the frame without line buffers
+  if (vf->fmt != VID_FMT_YUV420P && vf->size.w > VIDEO_SCALE_MAX_W)
+    return EINVAL;
+
+  video_workers_run(convert_stripe, &job, vf->size.h,
+                    vf->size.w * vf->size.h);
+  return 0;
+}
+
+int video_convert_yuv420p(void *dst, size_t dst_stride, video_pix_t pix,
+                          const struct vidframe *vf) {
+  if (!vf || vf->fmt != VID_FMT_YUV420P) return EINVAL;
+  return video_convert_frame(dst, dst_stride, pix, VIDEO_CSC_BT601_LIMITED, vf);
+}
+
+// ============================================================================
+// Fused scale + convert
+// ============================================================================
+
+// Source position of destination sample 0 and per-sample step, 16.16 fixed
+// point, mapping pixel centres (x + 0.5) * src / dst - 0.5
+static void scale_setup(unsigned src, unsigned dst, int32_t *start,
+                        int32_t *step) {
+  *step = (int32_t)(((uint64_t)src << 16) / dst);
+  *start = *step / 2 - 0x8000;
+}
+
+// sstep: bytes between source samples
+static void scale_row_nearest(uint8_t *out, unsigned dw, const uint8_t *src,
+                              unsigned sstep, unsigned sw, int32_t start,
+                              int32_t step) {
+  int32_t pos = start + 0x8000; // Round to nearest
+  for (unsigned x = 0; x < dw; x++, pos += step) {
+    int32_t ix = pos >> 16;
+    if (ix < 0) ix = 0;
+    if (ix >= (int32_t)sw) ix = sw - 1;
+    out[x] = src[(size_t)ix * sstep];
+  }
+}
+
+// fy: vertical weight of r1 in 1/256
+static void scale_row_bilinear(uint8_t *out, unsigned dw, const uint8_t *r0,
+                               const uint8_t *r1, unsigned sstep, unsigned fy,
+                               unsigned sw, int32_t start, int32_t step) {
+  int32_t pos = start;
+  for (unsigned x = 0; x < dw; x++, pos += step) {
+    int32_t ix = pos >> 16;
+    unsigned fx = (pos >> 8) & 0xFF;
+    int32_t ix1;
+
+    if (ix < 0) {
+      ix = 0;
+      fx = 0;
+    }
+    if (ix >= (int32_t)sw - 1) {
+      ix = sw - 1;
+      fx = 0;
+    }
+    ix1 = fx ? ix + 1 : ix;
+
+    size_t o0 = (size_t)ix * sstep, o1 = (size_t)ix1 * sstep;
+    unsigned top = r0[o0] * (256 - fx) + r0[o1] * fx;
+    unsigned bot = r1[o0] * (256 - fx) + r1[o1] * fx;
+    out[x] = (uint8_t)((top * (256 - fy) + bot * fy + 32768) >> 16);
+  }
+}
+
+static void scale_plane_row(uint8_t *out, unsigned dw,
+                            const struct video_plane *p, unsigned dy,
+                            unsigned dh, video_scale_t mode) {
+  int32_t xstart, xstep, ystart, ystep;
+  unsigned sw = p->w, sh = p->h;
+
+  scale_setup(sw, dw, &xstart, &xstep);
+  scale_setup(sh, dh, &ystart, &ystep);
+
+  int32_t ypos = ystart + (int32_t)dy * ystep;
+
+  if (mode == VIDEO_SCALE_NEAREST) {
+    int32_t iy = (ypos + 0x8000) >> 16;
+    if (iy < 0) iy = 0;
+    if (iy >= (int32_t)sh) iy = sh - 1;
+    scale_row_nearest(out, dw, p->data + (size_t)iy * p->stride, p->step, sw,
+                      xstart, xstep);
+    return;
+  }
+
+  int32_t iy = ypos >> 16;
+  unsigned fy = (ypos >> 8) & 0xFF;
+  if (iy < 0) {
+    iy = 0;
+    fy = 0;
+  }
+  if (iy >= (int32_t)sh - 1) {
+    iy = sh - 1;
+    fy = 0;
+  }
+  const uint8_t *r0 = p->data + (size_t)iy * p->stride;
+  const uint8_t *r1 = fy ? r0 + p->stride : r0;
+
+  scale_row_bilinear(out, dw, r0, r1, p->step, fy, sw, xstart, xstep);
+}
+
+// Each output row is resampled into small line buffers (luma at dw, chroma
+// at dw / 2, or dw for 4:4:4) and handed to the row kernel, so no scaled
+// frame is ever materialised. RGB sources resample all three channels at dw.
+static void scale_stripe(void *arg, unsigned y0, unsigned y1) {
+  const struct convert_job *job = arg;
+  const struct video_plane *py = &job->src[0];
+  const struct video_plane *pu = &job->src[1];
+  const struct video_plane *pv = &job->src[2];
+  unsigned cdw = pu->w == py->w ? job->dw : (job->dw + 1) / 2;
+  unsigned cdh = (job->dh + 1) / 2;
+  // 4:2:2 / 4:4:4 / packed sources have a chroma row per luma row
+  bool chroma_per_row = pu->h == py->h;
+  uint8_t y_line[VIDEO_SCALE_MAX_W];
+  uint8_t u_line[VIDEO_SCALE_MAX_W];
+  uint8_t v_line[VIDEO_SCALE_MAX_W];
+
+  if (fmt_is_rgb(job->vf->fmt)) {
+    for (unsigned y = y0; y < y1; y++) {
+      scale_plane_row(y_line, job->dw, py, y, job->dh, job->mode);
+      scale_plane_row(u_line, job->dw, pu, y, job->dh, job->mode);
+      scale_plane_row(v_line, job->dw, pv, y, job->dh, job->mode);
+      emit_rgb_row(job, y, y_line, u_line, v_line, 1);
+    }
+    return;
+  }
+
+  for (unsigned y = y0; y < y1; y++) {
+    scale_plane_row(y_line, job->dw, py, y, job->dh, job->mode);
+
+    if (chroma_per_row) {
+      scale_plane_row(u_line, cdw, pu, y, job->dh, job->mode);
+      scale_plane_row(v_line, cdw, pv, y, job->dh, job->mode);
+    } else if (y == y0 || (y & 1) == 0) {
+      // Chroma rows are shared by two output rows
+      scale_plane_row(u_line, cdw, pu, y / 2, cdh, job->mode);
+      scale_plane_row(v_line, cdw, pv, y / 2, cdh, job->mode);
+    }
+
+    emit_row(job, y, y_line, u_line, v_line);
+  }
+}
+
+int video_convert_frame_scale(void *dst, size_t dst_stride, video_pix_t pix,
+                              video_csc_t csc, unsigned dw, unsigned dh,
+                              const struct vidframe *vf, video_scale_t mode) {
+  struct convert_job job;
+
+  if (!dst || !vf) return EINVAL;
+  if (dw == 0 || dh == 0 || dw > VIDEO_SCALE_MAX_W ||
+      dst_stride < dw * video_pix_bytes(pix))
+    return EINVAL;
+
+  // Same size: plain conversion, no resampling
+  if (mode == VIDEO_SCALE_NONE || (dw == vf->size.w && dh == vf->size.h)) {
+    if (dw != vf->size.w || dh != vf->size.h) return EINVAL;
+    return video_convert_frame(dst, dst_stride, pix, csc, vf);
+  }
+
+  job_init(&job, dst, dst_stride, pix, csc, vf);
+  if (!src_setup(job.src, vf)) return ENOTSUP;
+  job.dw = dw;
+  job.dh = dh;
+  job.mode = mode;
+
+  video_workers_run(scale_stripe, &job, dh, dw * dh);
+  return 0;
+}
+
+int video_convert_yuv420p_scale(void *dst, size_t dst_stride, video_pix_t pix,
+                                unsigned dw, unsigned dh,
+                                const struct vidframe *vf,
+                                video_scale_t mode) {
+  if (!vf || vf->fmt != VID_FMT_YUV420P) return EINVAL;
+  return video_convert_frame_scale(dst, dst_stride, pix,
+                                   VIDEO_CSC_BT601_LIMITED, dw, dh, vf, mode);
+}
+
+int video_convert_yuv420p_scale_argb8888(uint32_t *dst, unsigned dst_stride,
+                                         unsigned dw, unsigned dh,
+                                         const struct vidframe *vf,
+                                         video_scale_t mode) {
+  return video_convert_yuv420p_scale(dst, (size_t)dst_stride * 4,
+                                     VIDEO_PIX_ARGB8888, dw, dh, vf, mode);
+}
+
+// ============================================================================
+// Rotation / mirroring
+// ============================================================================
+
+// Upright rows converted per band; a band is then written out rotated
+#define ROTATE_BAND 16
+// Columns per tile when a band is transposed
+#define ROTATE_TILE 32
+
+struct rotate_job {
+  struct convert_job inner; // Produces upright rows (pw x ph) into a band
+  video_stripe_fn produce;
+  uint8_t *dst;
+  size_t dst_stride;
+  video_rotate_t rotate;
+  bool mirror;
+  // One band per stripe running at once, claimed in turn (atomic)
+  uint8_t *bands;
+  size_t band_size;
+  unsigned band_count;
+  unsigned band_next;
+  int err; // Set when a stripe found no band (atomic)
+};
+
+static inline void copy_px(uint8_t *d, const uint8_t *s, size_t bpp) {
+  if (bpp == 4)
+    *(uint32_t *)d = *(const uint32_t *)s;
+  else
+    *(uint16_t *)d = *(const uint16_t *)s;
+}
+
+// Write n upright rows starting at row sy0 (band, pw pixels each) to dst
+static void rotate_band(const struct rotate_job *rj, const uint8_t *band,
+                        unsigned sy0, unsigned n) {
+  unsigned pw = rj->inner.dw, ph = rj->inner.dh;
+  size_t bpp = video_pix_bytes(rj->inner.pix);
+  size_t band_stride = (size_t)pw * bpp;
+
+  if (rj->rotate == VIDEO_ROTATE_0 || rj->rotate == VIDEO_ROTATE_180) {
+    bool flip = rj->rotate == VIDEO_ROTATE_180;
+    bool reverse = flip != rj->mirror;
+
+    for (unsigned i = 0; i < n; i++) {
+      unsigned sy = sy0 + i;
+      const uint8_t *s = band + i * band_stride;
+      uint8_t *d = rj->dst + (size_t)(flip ? ph - 1 - sy : sy) * rj->dst_stride;
+
+      if (!reverse) {
+        memcpy(d, s, band_stride);
+      } else if (bpp == 4) {
+        const uint32_t *s32 = (const uint32_t *)s;
+        uint32_t *d32 = (uint32_t *)d;
+        for (unsigned x = 0; x < pw; x++) d32[x] = s32[pw - 1 - x];
+      } else {
+        const uint16_t *s16 = (const uint16_t *)s;
+        uint16_t *d16 = (uint16_t *)d;
+        for (unsigned x = 0; x < pw; x++) d16[x] = s16[pw - 1 - x];
+      }
+    }
+    return;
+  }
+
+  // 90/270: upright column sx becomes output row dy, upright row sy becomes
+  // output column dx. The band is walked in narrow tiles so its rows stay
+  // in cache while each output row gets n contiguous pixels.
+  bool cw = rj->rotate == VIDEO_ROTATE_90;
+  bool dx_down = cw != rj->mirror; // dx = ph - 1 - sy
+  unsigned dx0 = dx_down ? ph - sy0 - n : sy0;
+
+  for (unsigned tx = 0; tx < pw; tx += ROTATE_TILE) {
+    unsigned tx1 = tx + ROTATE_TILE < pw ? tx + ROTATE_TILE : pw;
+
+    for (unsigned sx = tx; sx < tx1; sx++) {
+      unsigned dy = cw ? sx : pw - 1 - sx;
+      uint8_t *d = rj->dst + (size_t)dy * rj->dst_stride + (size_t)dx0 * bpp;
+      const uint8_t *s = band + (size_t)sx * bpp;
+
+      if (dx_down) {
+        for (unsigned i = 0; i < n; i++)
+          copy_px(d + (size_t)(n - 1 - i) * bpp, s + i * band_stride, bpp);
+      } else {
+        for (unsigned i = 0; i < n; i++)
+          copy_px(d + (size_t)i * bpp, s + i * band_stride, bpp);
+      }
+    }
+  }
+}
+
+static void rotate_stripe(void *arg, unsigned y0, unsigned y1) {
+  struct rotate_job *rj = arg;
+  size_t band_stride = (size_t)rj->inner.dw * video_pix_bytes(rj->inner.pix);
+  unsigned slot = __atomic_fetch_add(&rj->band_next, 1, __ATOMIC_RELAXED);
+
+  if (slot >= rj->band_count) {
+    __atomic_store_n(&rj->err, EAGAIN, __ATOMIC_RELAXED);
+    return;
+  }
+  uint8_t *band = rj->bands + slot * rj->band_size;
+
+  for (unsigned y = y0; y < y1; y += ROTATE_BAND) {
+    unsigned n = y1 - y < ROTATE_BAND ? y1 - y : ROTATE_BAND;
+    struct convert_job job = rj->inner;
+
+    job.dst = band;
+    job.dst_stride = band_stride;
+    job.dst_y0 = y;
+    rj->produce(&job, y, y + n);
+    rotate_band(rj, band, y, n);
+  }
+}
+
+int video_convert_frame_transform(void *dst, size_t dst_stride,
+                                  video_pix_t pix, video_csc_t csc,
+                                  unsigned dw, unsigned dh,
+                                  const struct vidframe *vf,
+                                  video_scale_t mode, video_rotate_t rotate,
+                                  bool mirror) {
+  struct rotate_job rj;
+
+  if (rotate == VIDEO_ROTATE_0 && !mirror) {
+    if (mode != VIDEO_SCALE_NONE)
+      return video_convert_frame_scale(dst, dst_stride, pix, csc, dw, dh, vf,
+                                       mode);
+    if (!vf || dw != vf->size.w || dh != vf->size.h) return EINVAL;
+    return video_convert_frame(dst, dst_stride, pix, csc, vf);
+  }
+
+  if (!dst || !vf || (unsigned)rotate > VIDEO_ROTATE_270) return EINVAL;
+  if (dw == 0 || dh == 0 || dst_stride < dw * video_pix_bytes(pix))
+    return EINVAL;
+
+  // Upright size, before rotating
+  bool swap = rotate == VIDEO_ROTATE_90 || rotate == VIDEO_ROTATE_270;
+  unsigned pw = swap ? dh : dw, ph = swap ? dw : dh;
+  if (pw > VIDEO_SCALE_MAX_W) return EINVAL;
+
+  memset(&rj, 0, sizeof(rj));
+  job_init(&rj.inner, NULL, 0, pix, csc, vf);
+  if (!src_setup(rj.inner.src, vf)) return ENOTSUP;
+
+  if (mode == VIDEO_SCALE_NONE || (pw == vf->size.w && ph == vf->size.h)) {
+    if (pw != vf->size.w || ph != vf->size.h) return EINVAL;
+    rj.produce = convert_stripe;
+  } else {
+    rj.inner.dw = pw;
+    rj.inner.dh = ph;
+    rj.inner.mode = mode;
+    rj.produce = scale_stripe;
+  }
+  rj.dst = dst;
+  rj.dst_stride = dst_stride;
+  rj.rotate = rotate;
+  rj.mirror = mirror;
+
+  // Allocated up front, so a failure is reported instead of leaving
+  // stripes unwritten
+  rj.band_size = (size_t)pw * video_pix_bytes(pix) * ROTATE_BAND;
+  rj.band_count = (unsigned)video_workers_get_threads();
+  rj.bands = malloc(rj.band_size * rj.band_count);
+  if (!rj.bands) return ENOMEM;
+
+  video_workers_run(rotate_stripe, &rj, ph, pw * ph);
+  free(rj.bands);
+  return rj.err;
+}
+
+void video_convert_fit_rect(unsigned src_w, unsigned src_h, unsigned box_w,
+                            unsigned box_h, struct vidrect *out) {
+  unsigned w = box_w, h = box_h;
+
+  if (src_w && src_h) {
+    // Compare aspect ratios without floating point
+    if ((uint64_t)box_w * src_h > (uint64_t)box_h * src_w) {
+      w = (unsigned)((uint64_t)box_h * src_w / src_h);
+    } else {
+      h = (unsigned)((uint64_t)box_w * src_h / src_w);
+    }
+  }
+  if (w == 0) w = 1;
+  if (h == 0) h = 1;
+
+  // Even origin keeps chroma pairs aligned with the buffer
+  out->w = w;
+  out->h = h;
+  out->x = ((box_w - w) / 2) & ~1u;
+  out->y = ((box_h - h) / 2) & ~1u;
+}
+
+int video_convert_selftest(video_kernel_t kernel) {
+  // 3 * 32 + 16 + 13: the AVX2 body, the SSE2 block it hands its remainder
+  // to and the scalar tail all run (NEON: 7 * 16 + 13)
+  enum { W = 125, H = 6, CW = (W + 1) / 2, CH = (H + 1) / 2 };
+  static uint8_t y_buf[W * H], u_buf[CW * CH], v_buf[CW * CH];
+  static uint32_t ref[W * H], out[W * H];
+  struct vidframe vf;
+  uint32_t seed = 0x12345678;
+
+  if (!video_convert_kernel_supported(kernel)) return ENOTSUP;
+
+  // Random samples, plus the extremes that drive clamping in every channel
+  for (size_t i = 0; i < sizeof(y_buf); i++) {
+    seed = seed * 1664525u + 1013904223u;
+    y_buf[i] = (i % 11 == 0) ? 0 : (i % 13 == 0) ? 255 : (uint8_t)(seed >> 24);
+  }
+  for (size_t i = 0; i < sizeof(u_buf); i++) {
+    seed = seed * 1664525u + 1013904223u;
+    u_buf[i] = (i % 7 == 0) ? 0 : (i % 5 == 0) ? 255 : (uint8_t)(seed >> 24);
+    seed = seed * 1664525u + 1013904223u;
+    v_buf[i] = (i % 3 == 0) ? 255 : (i % 4 == 0) ? 0 : (uint8_t)(seed >> 24);
+  }
+
+  memset(&vf, 0, sizeof(vf));
+  vf.fmt = VID_FMT_YUV420P;
+  vf.size.w = W;
+  vf.size.h = H;
+  vf.data[0] = y_buf;
+  vf.data[1] = u_buf;
+  vf.data[2] = v_buf;
+  vf.linesize[0] = W;
+  vf.linesize[1] = CW;
+  vf.linesize[2] = CW;
+
+  // BT.601 limited against the original per-pixel loop
+  video_convert_yuv420p_to_argb8888_ref((uint8_t *)ref, &vf);
+
+  for (unsigned y = 0; y < H; y++) {
+    g_kernel_fns[kernel](out + y * W, y_buf + y * W, u_buf + (y / 2) * CW,
+                         v_buf + (y / 2) * CW, W,
+                         csc_get(VIDEO_CSC_BT601_LIMITED));
+  }
+
+  if (memcmp(ref, out, sizeof(ref)) != 0) return EINVAL;
+
+  // Every matrix, ARGB8888 and RGB565 (dithered and byte-swapped), against
+  // the scalar multiply rows
+  for (int c = 0; c < VIDEO_CSC_COUNT; c++) {
+    const struct video_csc *k = csc_get(c);
+
+    for (unsigned y = 0; y < H; y++) {
+      const uint8_t *yr = y_buf + y * W;
+      const uint8_t *ur = u_buf + (y / 2) * CW;
+      const uint8_t *vr = v_buf + (y / 2) * CW;
+
+      row_scalar(ref + y * W, yr, ur, vr, W, k);
+      g_kernel_fns[kernel](out + y * W, yr, ur, vr, W, k);
+    }
+    if (memcmp(ref, out, sizeof(ref)) != 0) return EINVAL;
+
+    uint16_t *ref565 = (uint16_t *)ref, *out565 = (uint16_t *)out;
+    for (unsigned y = 0; y < H; y++) {
+      const uint8_t *bayer = (y & 1) ? g_bayer4[y & 3] : NULL;
+      bool swap = (y % 3) == 0;
+      const uint8_t *yr = y_buf + y * W;
+      const uint8_t *ur = u_buf + (y / 2) * CW;
+      const uint8_t *vr = v_buf + (y / 2) * CW;
+
+      row565_scalar(ref565 + y * W, yr, ur, vr, W, bayer, swap, k);
+      g_kernel565_fns[kernel](out565 + y * W, yr, ur, vr, W, bayer, swap, k);
+    }
+    if (memcmp(ref565, out565, W * H * 2) != 0) return EINVAL;
+
+    // 4:4:4 rows, fed with other luma rows as full-width chroma
+    for (unsigned y = 0; y < H; y++) {
+      const uint8_t *yr = y_buf + y * W;
+      const uint8_t *ur = y_buf + ((y + 1) % H) * W;
+      const uint8_t *vr = y_buf + ((y + 3) % H) * W;
+
+      row444_scalar(ref + y * W, yr, ur, vr, W, k);
+      g_row444_fns[kernel](out + y * W, yr, ur, vr, W, k);
+    }
+    if (memcmp(ref, out, sizeof(ref)) != 0) return EINVAL;
+
+    for (unsigned y = 0; y < H; y++) {
+      const uint8_t *bayer = (y & 1) ? g_bayer4[y & 3] : NULL;
+      bool swap = (y % 3) == 0;
+      const uint8_t *yr = y_buf + y * W;
+      const uint8_t *ur = y_buf + ((y + 1) % H) * W;
+      const uint8_t *vr = y_buf + ((y + 3) % H) * W;
+
+      row565_444_scalar(ref565 + y * W, yr, ur, vr, W, bayer, swap, k);
+      g_row565_444_fns[kernel](out565 + y * W, yr, ur, vr, W, bayer, swap,
+                               k);
+    }
+    if (memcmp(ref565, out565, W * H * 2) != 0) return EINVAL;
+  }
+
+  // Layout helpers (NV12, YUYV/UYVY) against their scalar versions,
+  // fed with the luma buffer as raw bytes
+  uint8_t *rb = (uint8_t *)ref, *ob = (uint8_t *)out;
+  const unsigned n = sizeof(y_buf) / 2;   // 375 pairs / outputs
+  const unsigned pw = sizeof(y_buf) / 2 - 2; // 373 packed pixels
+  for (int pass = 0; pass < 3; pass++) {
+    uint8_t *bufs[2] = {rb, ob};
+    memset(rb, 0, sizeof(ref));
+    memset(ob, 0, sizeof(out));
+
+    for (int i = 0; i < 2; i++) {
+      video_kernel_t k = i ? kernel : VIDEO_KERNEL_SCALAR;
+      uint8_t *b = bufs[i];
+      if (pass == 0) g_uv_fns[k](b, b + 512, y_buf, n);
+      if (pass == 1) g_packed422_fns[k](b, b + 512, b + 768, y_buf, pw, false);
+      if (pass == 2) g_packed422_fns[k](b, b + 512, b + 768, y_buf, pw, true);
+    }
+    if (memcmp(rb, ob, 1024) != 0) return EINVAL;
+  }
+
+  return 0;
+}
+
+static double bench_now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+void video_convert_benchmark(unsigned w, unsigned h, unsigned frames) {
+  unsigned cw = (w + 1) / 2, ch = (h + 1) / 2;
+  uint8_t *yuv = malloc((size_t)w * h + 2 * (size_t)cw * ch);
+  uint32_t *dst = malloc((size_t)w * h * 4);
+  const struct video_csc *k = csc_get(VIDEO_CSC_BT709_LIMITED);
+
+  if (!yuv || !dst || w == 0 || h == 0 || frames == 0) {
+    free(yuv);
+    free(dst);
+    return;
+  }
+
+  uint8_t *u = yuv + (size_t)w * h;
+  uint8_t *v = u + (size_t)cw * ch;
+  uint32_t seed = 0x9E3779B9;
+  for (size_t i = 0; i < (size_t)w * h + 2 * (size_t)cw * ch; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    yuv[i] = (uint8_t)(seed >> 24);
+  }
+
+  log_info("VideoConvert", "Benchmark %ux%u, %u frames, single thread (%s):",
+           w, h, frames, g_csc_names[VIDEO_CSC_BT709_LIMITED]);
+
+  for (int kern = 0; kern < VIDEO_KERNEL_COUNT; kern++) {
+    if (!video_convert_kernel_supported(kern)) continue;
+
+    for (int pix = 0; pix < 2; pix++) {
+      double t0 = bench_now_ms();
+
+      for (unsigned f = 0; f < frames; f++) {
+        for (unsigned y = 0; y < h; y++) {
+          const uint8_t *yr = yuv + (size_t)y * w;
+          const uint8_t *ur = u + (size_t)(y / 2) * cw;
+          const uint8_t *vr = v + (size_t)(y / 2) * cw;
+
+          if (pix == 0) {
+            g_kernel_fns[kern](dst + (size_t)y * w, yr, ur, vr, w, k);
+          } else {
+            g_kernel565_fns[kern]((uint16_t *)dst + (size_t)y * w, yr, ur, vr,
+                                  w, g_bayer4[y & 3], false, k);
+          }
+        }
+      }
+
+      log_info("VideoConvert", "  %-6s %-8s %7.3f ms/frame", g_kernel_names[kern],
+               pix ? "RGB565" : "ARGB8888",
+               (bench_now_ms() - t0) / frames);
+    }
+  }
+
+  // Whole-frame conversion through the worker pool with the active kernel,
+  // rotated and mirrored, relative to the plain conversion
+  struct vidframe vf;
+  memset(&vf, 0, sizeof(vf));
+  vf.fmt = VID_FMT_YUV420P;
+  vf.size.w = w;
+  vf.size.h = h;
+  vf.data[0] = yuv;
+  vf.data[1] = u;
+  vf.data[2] = v;
+  vf.linesize[0] = (uint16_t)w;
+  vf.linesize[1] = (uint16_t)cw;
+  vf.linesize[2] = (uint16_t)cw;
+
+  static const struct {
+    const char *name;
+    video_rotate_t rotate;
+    bool mirror;
+  } transforms[] = {
+      {"plain", VIDEO_ROTATE_0, false},  {"rot90", VIDEO_ROTATE_90, false},
+      {"rot180", VIDEO_ROTATE_180, false}, {"rot270", VIDEO_ROTATE_270, false},
+      {"mirror", VIDEO_ROTATE_0, true},
+  };
+  double plain_ms = 0;
+
+  log_info("VideoConvert", "Transforms, ARGB8888, %s kernel:",
+           g_kernel_names[g_kernel]);
+
+  for (size_t i = 0; i < sizeof(transforms) / sizeof(transforms[0]); i++) {
+    bool swap = transforms[i].rotate == VIDEO_ROTATE_90 ||
+                transforms[i].rotate == VIDEO_ROTATE_270;
+    unsigned dw = swap ? h : w, dh = swap ? w : h;
+    double t0 = bench_now_ms();
+    int err = 0;
+
+    for (unsigned f = 0; f < frames && !err; f++) {
+      err = video_convert_frame_transform(
+          dst, (size_t)dw * 4, VIDEO_PIX_ARGB8888, VIDEO_CSC_BT709_LIMITED, dw,
+          dh, &vf, VIDEO_SCALE_NONE, transforms[i].rotate, transforms[i].mirror);
+    }
+    if (err) {
+      log_warn("VideoConvert", "  %-6s failed (%d)", transforms[i].name, err);
+      continue;
+    }
+
+    double ms = (bench_now_ms() - t0) / frames;
+    if (i == 0) plain_ms = ms;
+    log_info("VideoConvert", "  %-6s %7.3f ms/frame (%+.0f%%)",
+             transforms[i].name, ms,
+             plain_ms > 0 ? (ms / plain_ms - 1.0) * 100.0 : 0.0);
+  }
+
+  free(yuv);
+  free(dst);
+}
+
+void video_convert_init(void) {
+  static bool initialized = false;
+  if (initialized) return;
+  initialized = true;
+
+  video_kernel_t best = VIDEO_KERNEL_SCALAR;
+
+  for (int k = VIDEO_KERNEL_SCALAR; k < VIDEO_KERNEL_COUNT; k++) {
+    if (!video_convert_kernel_supported(k)) continue;
+
+    if (video_convert_selftest(k) != 0) {
+      log_error("VideoConvert", "Kernel '%s' failed self-test, disabled",
+                g_kernel_names[k]);
+      continue;
+    }
+    best = k;
+  }
+
+  video_convert_set_kernel(best);
+  log_info("VideoConvert", "Video conversion kernel: %s",
+           g_kernel_names[best]);
+
+  if (getenv("VIDEO_CONVERT_BENCH")) {
+    video_convert_benchmark(640, 480, 50);
+  }
+}
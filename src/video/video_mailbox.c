@@ -0,0 +1,157 @@
+#include "video_mailbox.h"
+#include <string.h>
+
+// Slot states. The producer moves FREE -> WRITING and QUEUED -> WRITING
+// (queue full), the consumer QUEUED -> SHOWN, QUEUED -> FREE (skipped),
+// SHOWN -> QUEUED (took a frame that is not due yet) and SHOWN -> FREE.
+// Transitions out of QUEUED are compare-and-swaps, since
+// both sides may try at once.
+enum {
+  SLOT_FREE = 0,
+  SLOT_WRITING,
+  SLOT_QUEUED,
+  SLOT_SHOWN,
+};
+
+static uint32_t slot_state(const struct video_mailbox *mb, unsigned i) {
+  return __atomic_load_n(&mb->state[i], __ATOMIC_ACQUIRE);
+}
+
+static bool slot_cas(struct video_mailbox *mb, unsigned i, uint32_t from,
+                     uint32_t to) {
+  return __atomic_compare_exchange_n(&mb->state[i], &from, to, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+void video_mailbox_init(struct video_mailbox *mb) {
+  if (!mb) return;
+
+  memset(mb, 0, sizeof(*mb));
+  mb->back = 0;
+  mb->front = 1;
+  mb->state[0] = SLOT_WRITING;
+  mb->state[1] = SLOT_SHOWN;
+}
+
+unsigned video_mailbox_back(const struct video_mailbox *mb) {
+  return mb->back;
+}
+
+unsigned video_mailbox_publish(struct video_mailbox *mb, uint64_t due) {
+  unsigned b = mb->back;
+
+  __atomic_store_n(&mb->due[b], due, __ATOMIC_RELAXED);
+  __atomic_store_n(&mb->seq[b], ++mb->next_seq, __ATOMIC_RELAXED);
+  // Release: the slot contents must be visible before it is queued
+  __atomic_store_n(&mb->state[b], SLOT_QUEUED, __ATOMIC_RELEASE);
+  __atomic_fetch_add(&mb->produced, 1, __ATOMIC_RELAXED);
+
+  // Next back slot: a free one, otherwise the oldest queued frame. The
+  // consumer holds at most one slot, so one of the two always exists.
+  for (;;) {
+    int oldest = -1;
+    uint64_t oldest_seq = UINT64_MAX;
+
+    for (unsigned i = 0; i < VIDEO_MAILBOX_SLOTS; i++) {
+      uint32_t s = slot_state(mb, i);
+      if (s == SLOT_FREE && slot_cas(mb, i, SLOT_FREE, SLOT_WRITING)) {
+        mb->back = i;
+        return i;
+      }
+      if (s == SLOT_QUEUED && i != b) {
+        uint64_t seq = __atomic_load_n(&mb->seq[i], __ATOMIC_RELAXED);
+        if (seq < oldest_seq) {
+          oldest_seq = seq;
+          oldest = (int)i;
+        }
+      }
+    }
+
+    if (oldest >= 0 &&
+        slot_cas(mb, (unsigned)oldest, SLOT_QUEUED, SLOT_WRITING)) {
+      __atomic_fetch_add(&mb->overwritten, 1, __ATOMIC_RELAXED);
+      mb->back = (unsigned)oldest;
+      return mb->back;
+    }
+    // The consumer took or dropped it meanwhile: look again
+  }
+}
+
+void video_mailbox_drop_late(struct video_mailbox *mb) {
+  __atomic_fetch_add(&mb->late, 1, __ATOMIC_RELAXED);
+}
+
+bool video_mailbox_acquire(struct video_mailbox *mb, uint64_t now,
+                           unsigned *front) {
+  for (;;) {
+    int best = -1;
+    uint64_t best_seq = 0;
+
+    for (unsigned i = 0; i < VIDEO_MAILBOX_SLOTS; i++) {
+      if (slot_state(mb, i) != SLOT_QUEUED) continue;
+
+      uint64_t seq = __atomic_load_n(&mb->seq[i], __ATOMIC_RELAXED);
+      uint64_t due = __atomic_load_n(&mb->due[i], __ATOMIC_RELAXED);
+      if (due <= now && seq > best_seq) {
+        best_seq = seq;
+        best = (int)i;
+      }
+    }
+
+    if (best < 0) {
+      if (front) *front = mb->front;
+      return false;
+    }
+
+    if (!slot_cas(mb, (unsigned)best, SLOT_QUEUED, SLOT_SHOWN)) continue;
+
+    // Between the scan and the swap the producer may have reused the slot
+    // and queued a newer frame in it. Held as SHOWN, its due time can no
+    // longer change: show it if it is due as well, otherwise queue it again.
+    if (__atomic_load_n(&mb->seq[best], __ATOMIC_RELAXED) != best_seq &&
+        __atomic_load_n(&mb->due[best], __ATOMIC_RELAXED) > now) {
+      __atomic_store_n(&mb->state[best], SLOT_QUEUED, __ATOMIC_RELEASE);
+      continue;
+    }
+
+    __atomic_store_n(&mb->state[mb->front], SLOT_FREE, __ATOMIC_RELEASE);
+    mb->front = (unsigned)best;
+    __atomic_fetch_add(&mb->presented, 1, __ATOMIC_RELAXED);
+    break;
+  }
+
+  // Queued frames older than the one shown would only go backwards
+  uint64_t shown_seq = __atomic_load_n(&mb->seq[mb->front], __ATOMIC_RELAXED);
+  for (unsigned i = 0; i < VIDEO_MAILBOX_SLOTS; i++) {
+    if (slot_state(mb, i) == SLOT_QUEUED &&
+        __atomic_load_n(&mb->seq[i], __ATOMIC_RELAXED) < shown_seq &&
+        slot_cas(mb, i, SLOT_QUEUED, SLOT_FREE)) {
+      __atomic_fetch_add(&mb->late, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  if (front) *front = mb->front;
+  return true;
+}
+
+uint64_t video_mailbox_next_due(const struct video_mailbox *mb) {
+  uint64_t next = 0;
+
+  for (unsigned i = 0; i < VIDEO_MAILBOX_SLOTS; i++) {
+    if (slot_state(mb, i) != SLOT_QUEUED) continue;
+
+    uint64_t due = __atomic_load_n(&mb->due[i], __ATOMIC_RELAXED);
+    if (!next || due < next) next = due ? due : 1;
+  }
+  return next;
+}
+
+void video_mailbox_get_stats(const struct video_mailbox *mb,
+                             struct video_mailbox_stats *stats) {
+  if (!mb || !stats) return;
+
+  stats->produced = __atomic_load_n(&mb->produced, __ATOMIC_RELAXED);
+  stats->presented = __atomic_load_n(&mb->presented, __ATOMIC_RELAXED);
+  stats->overwritten = __atomic_load_n(&mb->overwritten, __ATOMIC_RELAXED);
+  stats->late = __atomic_load_n(&mb->late, __ATOMIC_RELAXED);
+}
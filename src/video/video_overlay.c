@@ -0,0 +1,313 @@
+#include "video_overlay.h"
+#include "logger.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#endif
+
+static struct {
+  // Held for a whole blit and while the region changes
+  pthread_mutex_t lock;
+
+  char dev[64];
+  int fd;
+  uint8_t *fbp;
+  size_t fb_size;
+  unsigned xres;
+  unsigned yres;
+  unsigned xoffset;
+  unsigned yoffset;
+  size_t line_length;
+  size_t bpp; // Bytes per pixel
+  unsigned pages; // Screen pages written (page flipping), 0/1: yoffset only
+
+  // Region (UI thread writes under lock; the UI thread may read unlocked)
+  bool active;
+  struct vidrect rect;
+  struct vidrect holes[VIDEO_OVERLAY_MAX_HOLES];
+  unsigned n_holes;
+  unsigned gen;      // Bumped on every region change
+  unsigned full_gen; // Region generation the framebuffer was fully painted for
+
+  struct video_overlay_stats stats;
+} g_ovl = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .fd = -1,
+};
+
+void video_overlay_set_device(const char *dev) {
+  snprintf(g_ovl.dev, sizeof(g_ovl.dev), "%s", dev ? dev : "");
+}
+
+void video_overlay_set_pages(unsigned pages) {
+  pthread_mutex_lock(&g_ovl.lock);
+  g_ovl.pages = pages;
+  g_ovl.gen++;
+  pthread_mutex_unlock(&g_ovl.lock);
+}
+
+bool video_overlay_is_open(void) { return g_ovl.fbp != NULL; }
+
+bool video_overlay_active(void) { return g_ovl.active; }
+
+int video_overlay_open(video_pix_t pix) {
+#ifdef __linux__
+  struct fb_var_screeninfo vinfo;
+  struct fb_fix_screeninfo finfo;
+  int err = 0;
+
+  if (g_ovl.fbp) return 0;
+  if (!g_ovl.dev[0]) return ENODEV;
+
+  int fd = open(g_ovl.dev, O_RDWR);
+  if (fd < 0) return errno;
+
+  if (ioctl(fd, FBIOGET_FSCREENINFO, &finfo) != 0 ||
+      ioctl(fd, FBIOGET_VSCREENINFO, &vinfo) != 0) {
+    err = errno;
+    goto out;
+  }
+
+  // Frames are copied as-is, so the framebuffer must use their layout
+  bool match;
+  switch (pix) {
+  case VIDEO_PIX_ARGB8888:
+    match = vinfo.bits_per_pixel == 32 && vinfo.red.offset == 16 &&
+            vinfo.green.offset == 8 && vinfo.blue.offset == 0;
+    break;
+  case VIDEO_PIX_RGB565:
+    match = vinfo.bits_per_pixel == 16 && vinfo.red.offset == 11 &&
+            vinfo.green.offset == 5 && vinfo.blue.offset == 0;
+    break;
+  default:
+    match = false;
+    break;
+  }
+  if (!match) {
+    log_warn("VideoOverlay", "%s is %ubpp, video is %s: overlay disabled",
+             g_ovl.dev, vinfo.bits_per_pixel, video_pix_name(pix));
+    err = ENOTSUP;
+    goto out;
+  }
+
+  void *fbp = mmap(NULL, finfo.smem_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+  if (fbp == MAP_FAILED) {
+    err = errno;
+    goto out;
+  }
+
+  pthread_mutex_lock(&g_ovl.lock);
+  g_ovl.fd = fd;
+  g_ovl.fbp = fbp;
+  g_ovl.fb_size = finfo.smem_len;
+  g_ovl.xres = vinfo.xres;
+  g_ovl.yres = vinfo.yres;
+  g_ovl.xoffset = vinfo.xoffset;
+  g_ovl.yoffset = vinfo.yoffset;
+  g_ovl.line_length = finfo.line_length;
+  g_ovl.bpp = vinfo.bits_per_pixel / 8;
+  g_ovl.active = false;
+  pthread_mutex_unlock(&g_ovl.lock);
+
+  log_info("VideoOverlay", "Mapped %s: %ux%u %ubpp, stride %u",
+           g_ovl.dev, vinfo.xres, vinfo.yres, vinfo.bits_per_pixel,
+           finfo.line_length);
+  return 0;
+
+out:
+  close(fd);
+  return err;
+#else
+  (void)pix;
+  return ENOTSUP;
+#endif
+}
+
+void video_overlay_close(void) {
+#ifdef __linux__
+  pthread_mutex_lock(&g_ovl.lock);
+  if (g_ovl.fbp) {
+    munmap(g_ovl.fbp, g_ovl.fb_size);
+    close(g_ovl.fd);
+  }
+  g_ovl.fbp = NULL;
+  g_ovl.fd = -1;
+  g_ovl.active = false;
+  g_ovl.n_holes = 0;
+  pthread_mutex_unlock(&g_ovl.lock);
+#endif
+}
+
+static bool rect_equal(const struct vidrect *a, const struct vidrect *b) {
+  return a->x == b->x && a->y == b->y && a->w == b->w && a->h == b->h;
+}
+
+// Clip r to the region; false if nothing is left
+static bool rect_clip(struct vidrect *r, const struct vidrect *region) {
+  unsigned x0 = r->x > region->x ? r->x : region->x;
+  unsigned y0 = r->y > region->y ? r->y : region->y;
+  unsigned x1 = r->x + r->w < region->x + region->w ? r->x + r->w
+                                                    : region->x + region->w;
+  unsigned y1 = r->y + r->h < region->y + region->h ? r->y + r->h
+                                                    : region->y + region->h;
+  if (x1 <= x0 || y1 <= y0) return false;
+
+  r->x = x0;
+  r->y = y0;
+  r->w = x1 - x0;
+  r->h = y1 - y0;
+  return true;
+}
+
+int video_overlay_set_region(const struct vidrect *rect,
+                             const struct vidrect *holes, unsigned n) {
+  struct vidrect clipped[VIDEO_OVERLAY_MAX_HOLES];
+  unsigned count = 0;
+
+  if (!rect) {
+    if (!g_ovl.active) return 0;
+
+    pthread_mutex_lock(&g_ovl.lock);
+    g_ovl.active = false;
+    g_ovl.n_holes = 0;
+    g_ovl.gen++;
+    g_ovl.stats.fallbacks++;
+    pthread_mutex_unlock(&g_ovl.lock);
+    return 0;
+  }
+
+  if (!g_ovl.fbp || n > VIDEO_OVERLAY_MAX_HOLES || (n && !holes) ||
+      rect->w == 0 || rect->h == 0 ||
+      (unsigned)rect->x + rect->w > g_ovl.xres ||
+      (unsigned)rect->y + rect->h > g_ovl.yres) {
+    return EINVAL;
+  }
+
+  for (unsigned i = 0; i < n; i++) {
+    clipped[count] = holes[i];
+    if (rect_clip(&clipped[count], rect)) count++;
+  }
+
+  // Unchanged: leave the decoder alone
+  if (g_ovl.active && rect_equal(&g_ovl.rect, rect) &&
+      g_ovl.n_holes == count) {
+    bool same = true;
+    for (unsigned i = 0; i < count && same; i++) {
+      same = rect_equal(&g_ovl.holes[i], &clipped[i]);
+    }
+    if (same) return 0;
+  }
+
+  pthread_mutex_lock(&g_ovl.lock);
+  g_ovl.rect = *rect;
+  memcpy(g_ovl.holes, clipped, count * sizeof(clipped[0]));
+  g_ovl.n_holes = count;
+  g_ovl.active = true;
+  g_ovl.gen++;
+  pthread_mutex_unlock(&g_ovl.lock);
+
+  return 0;
+}
+
+// Copy columns [x0, x1) of one frame row, skipping the holes on that row
+static size_t blit_row(const uint8_t *src, uint8_t *dst, unsigned sy,
+                       unsigned x0, unsigned x1) {
+  unsigned starts[VIDEO_OVERLAY_MAX_HOLES];
+  unsigned ends[VIDEO_OVERLAY_MAX_HOLES];
+  unsigned n = 0;
+  size_t bytes = 0;
+
+  // Holes crossing this row, in frame columns, sorted by start
+  for (unsigned i = 0; i < g_ovl.n_holes; i++) {
+    const struct vidrect *h = &g_ovl.holes[i];
+    if (sy < h->y || sy >= (unsigned)h->y + h->h) continue;
+
+    unsigned s = h->x - g_ovl.rect.x;
+    unsigned e = s + h->w;
+    unsigned j = n++;
+    while (j > 0 && starts[j - 1] > s) {
+      starts[j] = starts[j - 1];
+      ends[j] = ends[j - 1];
+      j--;
+    }
+    starts[j] = s;
+    ends[j] = e;
+  }
+
+  unsigned x = x0;
+  for (unsigned i = 0; i <= n && x < x1; i++) {
+    unsigned stop = i < n ? starts[i] : x1;
+    if (stop > x1) stop = x1;
+    if (stop > x) {
+      size_t len = (size_t)(stop - x) * g_ovl.bpp;
+      memcpy(dst + x * g_ovl.bpp, src + x * g_ovl.bpp, len);
+      bytes += len;
+    }
+    if (i < n && ends[i] > x) x = ends[i];
+  }
+
+  return bytes;
+}
+
+int video_overlay_blit(const uint8_t *src, size_t stride, unsigned w,
+                       unsigned h, const struct vidrect *damage) {
+  if (!src) return EINVAL;
+
+  pthread_mutex_lock(&g_ovl.lock);
+
+  if (!g_ovl.active || !g_ovl.fbp || w != g_ovl.rect.w || h != g_ovl.rect.h) {
+    pthread_mutex_unlock(&g_ovl.lock);
+    return ENOENT;
+  }
+
+  // After a region change the letterbox bars have to be painted too
+  unsigned x0 = 0, y0 = 0, x1 = w, y1 = h;
+  if (damage && g_ovl.full_gen == g_ovl.gen) {
+    x0 = damage->x;
+    y0 = damage->y;
+    x1 = damage->x + damage->w < w ? damage->x + damage->w : w;
+    y1 = damage->y + damage->h < h ? damage->y + damage->h : h;
+  }
+  g_ovl.full_gen = g_ovl.gen;
+
+  // With page flipping the panel alternates between pages, and LVGL only
+  // syncs what it redrew, so every page gets the frame
+  unsigned pages = g_ovl.pages > 1 ? g_ovl.pages : 1;
+  size_t bytes = 0;
+
+  for (unsigned p = 0; p < pages; p++) {
+    unsigned yoff = g_ovl.pages > 1 ? p * g_ovl.yres : g_ovl.yoffset;
+    size_t page_end = (size_t)(yoff + g_ovl.yres) * g_ovl.line_length;
+    if (page_end > g_ovl.fb_size) break;
+
+    uint8_t *fb = g_ovl.fbp + (yoff + g_ovl.rect.y) * g_ovl.line_length +
+                  (g_ovl.xoffset + g_ovl.rect.x) * g_ovl.bpp;
+
+    for (unsigned y = y0; y < y1; y++) {
+      bytes += blit_row(src + y * stride, fb + y * g_ovl.line_length,
+                        g_ovl.rect.y + y, x0, x1);
+    }
+  }
+
+  g_ovl.stats.frames++;
+  g_ovl.stats.bytes += bytes;
+  pthread_mutex_unlock(&g_ovl.lock);
+
+  return 0;
+}
+
+void video_overlay_get_stats(struct video_overlay_stats *stats) {
+  if (!stats) return;
+
+  pthread_mutex_lock(&g_ovl.lock);
+  *stats = g_ovl.stats;
+  pthread_mutex_unlock(&g_ovl.lock);
+}
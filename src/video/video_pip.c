@@ -0,0 +1,220 @@
+#include "video_pip.h"
+#include "video_preview.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Compositing stops when the remote stream has not asked for this long
+#define PIP_REMOTE_TIMEOUT_USEC 500000
+// A selfview older than this is no longer drawn
+#define PIP_LOCAL_TIMEOUT_USEC 1000000
+// Distance from the corner, percent of the remote width
+#define PIP_MARGIN_PCT 2
+
+struct pip_buf {
+  uint8_t *data;
+  size_t size;
+  unsigned w;
+  unsigned h;
+  video_pix_t pix;
+};
+
+static struct {
+  // Guards `front`, the remote geometry and the timestamps. The local thread
+  // converts into the other buffer without holding it.
+  pthread_mutex_t lock;
+
+  // Settings (UI thread)
+  bool enable;
+  video_pip_corner_t corner;
+  unsigned size_pct;
+
+  struct pip_buf bufs[2];
+  struct video_preview preview; // Local thread only, kept like bufs
+  int front; // -1 if there is no selfview
+  uint64_t updated_usec;
+
+  unsigned remote_w;
+  unsigned remote_h;
+  uint64_t composed_usec;
+
+  struct video_pip_stats stats;
+} g_pip = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .enable = true,
+    .corner = VIDEO_PIP_TOP_RIGHT,
+    .size_pct = 25,
+    .front = -1,
+};
+
+static uint64_t pip_now_usec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+void video_pip_configure(bool enable, video_pip_corner_t corner,
+                         unsigned size_pct) {
+  if (size_pct < 10) size_pct = 10;
+  if (size_pct > 50) size_pct = 50;
+  if ((unsigned)corner > VIDEO_PIP_BOTTOM_RIGHT) corner = VIDEO_PIP_TOP_RIGHT;
+
+  pthread_mutex_lock(&g_pip.lock);
+  g_pip.enable = enable;
+  g_pip.corner = corner;
+  g_pip.size_pct = size_pct;
+  pthread_mutex_unlock(&g_pip.lock);
+}
+
+static bool remote_alive_locked(uint64_t now) {
+  return g_pip.enable && g_pip.composed_usec &&
+         now - g_pip.composed_usec < PIP_REMOTE_TIMEOUT_USEC;
+}
+
+bool video_pip_active(void) {
+  pthread_mutex_lock(&g_pip.lock);
+  bool active = remote_alive_locked(pip_now_usec());
+  pthread_mutex_unlock(&g_pip.lock);
+  return active;
+}
+
+int video_pip_update(const struct vidframe *vf, video_pix_t pix,
+                     video_csc_t csc, video_scale_t mode,
+                     video_rotate_t rotate, bool mirror) {
+  unsigned box_w, box_h;
+  int back;
+
+  if (!vf) return EINVAL;
+
+  pthread_mutex_lock(&g_pip.lock);
+  if (!remote_alive_locked(pip_now_usec())) {
+    pthread_mutex_unlock(&g_pip.lock);
+    return ENOENT;
+  }
+  // 4:3 box, the selfview keeps its own aspect inside it
+  box_w = g_pip.remote_w * g_pip.size_pct / 100;
+  box_h = box_w * 3 / 4;
+  back = g_pip.front == 0 ? 1 : 0;
+  pthread_mutex_unlock(&g_pip.lock);
+
+  if (box_w < 2 || box_h < 2) return ENOENT;
+
+  bool swap = rotate == VIDEO_ROTATE_90 || rotate == VIDEO_ROTATE_270;
+  struct vidrect fit;
+
+  // Averaged down close to the box first; the conversion reads only that
+  vf = video_preview_tap(&g_pip.preview, vf, box_w, box_h, swap);
+  video_convert_fit_rect(swap ? vf->size.h : vf->size.w,
+                         swap ? vf->size.w : vf->size.h, box_w, box_h, &fit);
+
+  struct pip_buf *b = &g_pip.bufs[back];
+  size_t size = (size_t)fit.w * fit.h * video_pix_bytes(pix);
+  if (size > b->size) {
+    uint8_t *data = realloc(b->data, size);
+    if (!data) return ENOMEM;
+    b->data = data;
+    b->size = size;
+  }
+
+  // Rotated and mirrored while converting, so composing is a plain copy
+  if (mode == VIDEO_SCALE_NONE) mode = VIDEO_SCALE_BILINEAR;
+  int err = video_convert_frame_transform(b->data,
+                                          fit.w * video_pix_bytes(pix), pix,
+                                          csc, fit.w, fit.h, vf, mode, rotate,
+                                          mirror);
+  if (err) return err;
+
+  b->w = fit.w;
+  b->h = fit.h;
+  b->pix = pix;
+
+  pthread_mutex_lock(&g_pip.lock);
+  g_pip.front = back;
+  g_pip.updated_usec = pip_now_usec();
+  g_pip.stats.updates++;
+  if (g_pip.preview.factor > 1) g_pip.stats.decimated++;
+  pthread_mutex_unlock(&g_pip.lock);
+
+  return 0;
+}
+
+int video_pip_compose(uint8_t *dst, size_t stride, video_pix_t pix,
+                      unsigned w, unsigned h, struct vidrect *rect) {
+  if (!dst || !rect) return EINVAL;
+
+  uint64_t now = pip_now_usec();
+  int err = ENOENT;
+
+  pthread_mutex_lock(&g_pip.lock);
+  if (!g_pip.enable) goto out;
+
+  g_pip.remote_w = w;
+  g_pip.remote_h = h;
+  g_pip.composed_usec = now;
+
+  if (g_pip.front < 0 || now - g_pip.updated_usec > PIP_LOCAL_TIMEOUT_USEC)
+    goto out;
+
+  const struct pip_buf *b = &g_pip.bufs[g_pip.front];
+  unsigned margin = w * PIP_MARGIN_PCT / 100;
+  if (b->pix != pix || b->w + margin > w || b->h + margin > h) goto out;
+
+  rect->w = b->w;
+  rect->h = b->h;
+  rect->x = (g_pip.corner == VIDEO_PIP_TOP_LEFT ||
+             g_pip.corner == VIDEO_PIP_BOTTOM_LEFT)
+                ? margin
+                : w - margin - b->w;
+  rect->y = (g_pip.corner == VIDEO_PIP_TOP_LEFT ||
+             g_pip.corner == VIDEO_PIP_TOP_RIGHT)
+                ? margin
+                : h - margin - b->h;
+
+  size_t bpp = video_pix_bytes(pix);
+  size_t src_stride = b->w * bpp;
+  uint8_t *out = dst + rect->y * stride + rect->x * bpp;
+  for (unsigned y = 0; y < b->h; y++) {
+    memcpy(out + y * stride, b->data + y * src_stride, src_stride);
+  }
+
+  g_pip.stats.composed++;
+  err = 0;
+
+out:
+  pthread_mutex_unlock(&g_pip.lock);
+  return err;
+}
+
+// The buffers and the tap are kept for the next stream: a late local frame
+// may still be decimating and converting into the back one
+void video_pip_clear(void) {
+  pthread_mutex_lock(&g_pip.lock);
+  g_pip.front = -1;
+  pthread_mutex_unlock(&g_pip.lock);
+}
+
+void video_pip_fill_black(uint8_t *dst, size_t stride, video_pix_t pix,
+                          const struct vidrect *rect) {
+  if (!dst || !rect) return;
+
+  size_t bpp = video_pix_bytes(pix);
+  for (unsigned y = 0; y < rect->h; y++) {
+    uint8_t *row = dst + (rect->y + y) * stride + rect->x * bpp;
+    if (pix == VIDEO_PIX_ARGB8888) {
+      uint32_t *px = (uint32_t *)row;
+      for (unsigned x = 0; x < rect->w; x++) px[x] = 0xFF000000;
+    } else {
+      memset(row, 0, rect->w * bpp);
+    }
+  }
+}
+
+void video_pip_get_stats(struct video_pip_stats *stats) {
+  if (!stats) return;
+
+  pthread_mutex_lock(&g_pip.lock);
+  *stats = g_pip.stats;
+  pthread_mutex_unlock(&g_pip.lock);
+}
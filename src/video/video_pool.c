@@ -0,0 +1,184 @@
+#include "video_pool.h"
+#include <pthread.h>
+#include <re.h>
+#include <string.h>
+
+// Buffers the pool keeps track of, handed out or parked. A few slots per
+// stream and the ones on screen; anything beyond is allocated untracked.
+#define POOL_ENTRIES 32
+// Smallest size class
+#define POOL_MIN_CLASS 4096
+
+struct pool_entry {
+  void *buf;     // NULL if unused
+  size_t size;   // Class size
+  bool parked;   // Free for reuse
+  uint64_t seq;  // Release order of parked buffers
+};
+
+static struct {
+  pthread_mutex_t lock;
+  struct pool_entry entries[POOL_ENTRIES];
+  uint64_t seq;
+  struct video_pool_stats stats;
+} g_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .stats.cap = 16u * 1024 * 1024,
+};
+
+// Round up to 1, 1.25, 1.5 or 1.75 times a power of two
+static size_t size_class(size_t size) {
+  size_t pow2 = POOL_MIN_CLASS;
+
+  if (size <= POOL_MIN_CLASS) return POOL_MIN_CLASS;
+  while (pow2 * 2 < size) pow2 *= 2;
+
+  for (size_t step = 1; step <= 4; step++) {
+    size_t cls = pow2 + pow2 / 4 * step;
+    if (cls >= size) return cls;
+  }
+  return pow2 * 2;
+}
+
+static struct pool_entry *find_locked(const void *buf) {
+  for (int i = 0; i < POOL_ENTRIES; i++) {
+    if (g_pool.entries[i].buf == buf) return &g_pool.entries[i];
+  }
+  return NULL;
+}
+
+// Free parked buffers, oldest first, until `bytes` fit under the cap.
+// The caller frees the returned buffers after unlocking.
+static unsigned evict_locked(size_t bytes, void **freed, unsigned max) {
+  unsigned n = 0;
+
+  while (g_pool.stats.held + bytes > g_pool.stats.cap && n < max) {
+    struct pool_entry *oldest = NULL;
+
+    for (int i = 0; i < POOL_ENTRIES; i++) {
+      struct pool_entry *e = &g_pool.entries[i];
+      if (e->buf && e->parked && (!oldest || e->seq < oldest->seq))
+        oldest = e;
+    }
+    if (!oldest) break;
+
+    g_pool.stats.held -= oldest->size;
+    g_pool.stats.evictions++;
+    freed[n++] = oldest->buf;
+    memset(oldest, 0, sizeof(*oldest));
+  }
+
+  return n;
+}
+
+static void free_all(void **bufs, unsigned n) {
+  for (unsigned i = 0; i < n; i++) mem_deref(bufs[i]);
+}
+
+void video_pool_set_cap(size_t bytes) {
+  void *freed[POOL_ENTRIES];
+  unsigned n;
+
+  pthread_mutex_lock(&g_pool.lock);
+  g_pool.stats.cap = bytes;
+  n = evict_locked(0, freed, POOL_ENTRIES);
+  pthread_mutex_unlock(&g_pool.lock);
+
+  free_all(freed, n);
+}
+
+void *video_pool_get(size_t size) {
+  size_t cls = size_class(size);
+  struct pool_entry *slot = NULL;
+  void *buf;
+
+  pthread_mutex_lock(&g_pool.lock);
+  for (int i = 0; i < POOL_ENTRIES; i++) {
+    struct pool_entry *e = &g_pool.entries[i];
+    if (e->buf && e->parked && e->size == cls) {
+      e->parked = false;
+      g_pool.stats.held -= cls;
+      g_pool.stats.hits++;
+      pthread_mutex_unlock(&g_pool.lock);
+      return e->buf;
+    }
+    if (!e->buf && !slot) slot = e;
+  }
+  g_pool.stats.misses++;
+  pthread_mutex_unlock(&g_pool.lock);
+
+  // Allocate outside the lock; the entry is claimed afterwards
+  buf = mem_alloc(cls, NULL);
+  if (!buf) return NULL;
+
+  pthread_mutex_lock(&g_pool.lock);
+  if (!slot || slot->buf) slot = find_locked(NULL);
+  if (slot) {
+    slot->buf = buf;
+    slot->size = cls;
+    slot->parked = false;
+  }
+  pthread_mutex_unlock(&g_pool.lock);
+
+  return buf;
+}
+
+void *video_pool_put(void *buf) {
+  void *freed[POOL_ENTRIES];
+  unsigned n = 0;
+
+  if (!buf) return NULL;
+
+  pthread_mutex_lock(&g_pool.lock);
+  struct pool_entry *e = find_locked(buf);
+
+  // Someone else still holds it: the last holder decides. Dropping the
+  // reference under the lock keeps two holders from both seeing the other.
+  if (e && mem_nrefs(buf) > 1) {
+    mem_deref(buf);
+    pthread_mutex_unlock(&g_pool.lock);
+    return NULL;
+  }
+
+  if (!e || e->size > g_pool.stats.cap) {
+    if (e) memset(e, 0, sizeof(*e));
+    pthread_mutex_unlock(&g_pool.lock);
+    mem_deref(buf);
+    return NULL;
+  }
+
+  n = evict_locked(e->size, freed, POOL_ENTRIES);
+  e->parked = true;
+  e->seq = ++g_pool.seq;
+  g_pool.stats.held += e->size;
+  pthread_mutex_unlock(&g_pool.lock);
+
+  free_all(freed, n);
+  return NULL;
+}
+
+void video_pool_flush(void) {
+  void *freed[POOL_ENTRIES];
+  unsigned n = 0;
+
+  pthread_mutex_lock(&g_pool.lock);
+  for (int i = 0; i < POOL_ENTRIES; i++) {
+    struct pool_entry *e = &g_pool.entries[i];
+    if (!e->buf || !e->parked) continue;
+
+    g_pool.stats.held -= e->size;
+    freed[n++] = e->buf;
+    memset(e, 0, sizeof(*e));
+  }
+  pthread_mutex_unlock(&g_pool.lock);
+
+  free_all(freed, n);
+}
+
+void video_pool_get_stats(struct video_pool_stats *stats) {
+  if (!stats) return;
+
+  pthread_mutex_lock(&g_pool.lock);
+  *stats = g_pool.stats;
+  pthread_mutex_unlock(&g_pool.lock);
+}
@@ -0,0 +1,307 @@
+#include "video_preview.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VIDEO_HAVE_X86 1
+#include <immintrin.h>
+#define SSE2_FN __attribute__((target("sse2")))
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+#define VIDEO_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Widen one row into acc (first) or add it, 16 bytes at a time; returns
+// how many bytes were done
+#if VIDEO_HAVE_X86
+SSE2_FN static size_t acc_row_simd(uint16_t *acc, const uint8_t *row,
+                                   size_t span, bool first) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 16 <= span; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(row + i));
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+    if (!first) {
+      lo = _mm_add_epi16(lo, _mm_loadu_si128((const __m128i *)(acc + i)));
+      hi = _mm_add_epi16(hi, _mm_loadu_si128((const __m128i *)(acc + i + 8)));
+    }
+    _mm_storeu_si128((__m128i *)(acc + i), lo);
+    _mm_storeu_si128((__m128i *)(acc + i + 8), hi);
+  }
+  return i;
+}
+
+SSE2_FN static size_t add_sums_simd(uint16_t *acc, const uint16_t *more,
+                                    size_t span) {
+  size_t i = 0;
+
+  for (; i + 8 <= span; i += 8) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(acc + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(more + i));
+    _mm_storeu_si128((__m128i *)(acc + i), _mm_add_epi16(a, b));
+  }
+  return i;
+}
+#elif VIDEO_HAVE_NEON
+static size_t acc_row_simd(uint16_t *acc, const uint8_t *row, size_t span,
+                           bool first) {
+  size_t i = 0;
+
+  for (; i + 16 <= span; i += 16) {
+    uint8x16_t v = vld1q_u8(row + i);
+    uint16x8_t lo, hi;
+    if (first) {
+      lo = vmovl_u8(vget_low_u8(v));
+      hi = vmovl_u8(vget_high_u8(v));
+    } else {
+      lo = vaddw_u8(vld1q_u16(acc + i), vget_low_u8(v));
+      hi = vaddw_u8(vld1q_u16(acc + i + 8), vget_high_u8(v));
+    }
+    vst1q_u16(acc + i, lo);
+    vst1q_u16(acc + i + 8, hi);
+  }
+  return i;
+}
+
+static size_t add_sums_simd(uint16_t *acc, const uint16_t *more,
+                            size_t span) {
+  size_t i = 0;
+
+  for (; i + 8 <= span; i += 8)
+    vst1q_u16(acc + i, vaddq_u16(vld1q_u16(acc + i), vld1q_u16(more + i)));
+  return i;
+}
+#else
+static size_t acc_row_simd(uint16_t *acc, const uint8_t *row, size_t span,
+                           bool first) {
+  (void)acc;
+  (void)row;
+  (void)span;
+  (void)first;
+  return 0;
+}
+
+static size_t add_sums_simd(uint16_t *acc, const uint16_t *more,
+                            size_t span) {
+  (void)acc;
+  (void)more;
+  (void)span;
+  return 0;
+}
+#endif
+
+// acc[i] = sum of the first `span` bytes of n rows
+static void sum_rows(uint16_t *acc, const uint8_t *row, size_t stride,
+                     unsigned n, size_t span) {
+  for (unsigned j = 0; j < n; j++) {
+    const uint8_t *r = row + j * stride;
+    size_t i = acc_row_simd(acc, r, span, j == 0);
+
+    if (j == 0) {
+      for (; i < span; i++) acc[i] = r[i];
+    } else {
+      for (; i < span; i++) acc[i] += r[i];
+    }
+  }
+}
+
+static void add_sums(uint16_t *acc, const uint16_t *more, size_t span) {
+  for (size_t i = add_sums_simd(acc, more, span); i < span; i++)
+    acc[i] += more[i];
+}
+
+// out[x] = average of bw column sums `step` apart from acc[x * bw * step];
+// each sum covers 2^shift / bw rows
+static void emit_row(uint8_t *out, unsigned w, const uint16_t *acc,
+                     size_t step, unsigned bw, unsigned shift) {
+  unsigned round = (1u << shift) >> 1;
+  size_t adv = bw * step;
+
+  switch (bw) {
+  case 2:
+    for (unsigned x = 0; x < w; x++, acc += adv)
+      out[x] = (uint8_t)((acc[0] + acc[step] + round) >> shift);
+    break;
+  case 4:
+    for (unsigned x = 0; x < w; x++, acc += adv)
+      out[x] = (uint8_t)((acc[0] + acc[step] + acc[2 * step] + acc[3 * step] +
+                          round) >>
+                         shift);
+    break;
+  default:
+    for (unsigned x = 0; x < w; x++, acc += adv) {
+      unsigned sum = 0;
+      for (unsigned i = 0; i < bw; i++) sum += acc[i * step];
+      out[x] = (uint8_t)((sum + round) >> shift);
+    }
+    break;
+  }
+}
+
+static unsigned log2u(unsigned v) { return (unsigned)__builtin_ctz(v); }
+
+// One plane of single samples, averaged in bw x bh blocks
+static void box_plane(uint8_t *dst, unsigned w, unsigned h, const uint8_t *src,
+                      size_t stride, unsigned bw, unsigned bh, uint16_t *acc) {
+  for (unsigned y = 0; y < h; y++) {
+    sum_rows(acc, src + (size_t)y * bh * stride, stride, bh, (size_t)w * bw);
+    emit_row(dst + (size_t)y * w, w, acc, 1, bw, log2u(bw * bh));
+  }
+}
+
+// Interleaved U/V plane (NV12/NV21), one pass for both
+static void box_uv(uint8_t *u, uint8_t *v, unsigned w, unsigned h,
+                   const uint8_t *src, size_t stride, unsigned f, bool vu,
+                   uint16_t *acc) {
+  for (unsigned y = 0; y < h; y++) {
+    sum_rows(acc, src + (size_t)y * f * stride, stride, f, (size_t)w * f * 2);
+    emit_row(u + (size_t)y * w, w, acc + vu, 2, f, log2u(f * f));
+    emit_row(v + (size_t)y * w, w, acc + !vu, 2, f, log2u(f * f));
+  }
+}
+
+// Packed 4:2:2 in one pass: two luma rows from f source rows each, then
+// chroma (full height in the source) from all 2f rows
+static void box_packed(struct vidframe *dst, const struct vidframe *src,
+                       unsigned f, unsigned yoff, unsigned uoff,
+                       unsigned voff, uint16_t *acc) {
+  unsigned w = dst->size.w;
+  unsigned cw = w / 2;
+  size_t ls = src->linesize[0];
+  size_t span = (size_t)w * f * 2;
+  uint16_t *acc1 = acc + span;
+
+  for (unsigned cy = 0; cy < dst->size.h / 2; cy++) {
+    const uint8_t *row = src->data[0] + (size_t)cy * 2 * f * ls;
+    uint8_t *y0 = dst->data[0] + (size_t)cy * 2 * w;
+
+    sum_rows(acc, row, ls, f, span);
+    sum_rows(acc1, row + f * ls, ls, f, span);
+    emit_row(y0, w, acc + yoff, 2, f, log2u(f * f));
+    emit_row(y0 + w, w, acc1 + yoff, 2, f, log2u(f * f));
+
+    add_sums(acc, acc1, span);
+    emit_row(dst->data[1] + (size_t)cy * cw, cw, acc + uoff, 4, f,
+             log2u(2 * f * f));
+    emit_row(dst->data[2] + (size_t)cy * cw, cw, acc + voff, 4, f,
+             log2u(2 * f * f));
+  }
+}
+
+static bool format_supported(enum vidfmt fmt) {
+  switch (fmt) {
+  case VID_FMT_YUV420P:
+  case VID_FMT_NV12:
+  case VID_FMT_NV21:
+  case VID_FMT_YUYV422:
+  case VID_FMT_UYVY422:
+  case VID_FMT_YUV422P:
+  case VID_FMT_YUV444P:
+    return true;
+  default:
+    return false;
+  }
+}
+
+unsigned video_preview_factor(const struct vidsz *size, unsigned w, unsigned h,
+                              bool swap) {
+  if (!size || !w || !h) return 1;
+
+  unsigned sw = swap ? size->h : size->w;
+  unsigned sh = swap ? size->w : size->h;
+
+  // The picture is fitted into the target keeping its aspect, so it only
+  // has to stay at least as big along the dimension that limits the fit.
+  // Far below the source, 4 is still taken and the converter scales the
+  // rest.
+  for (unsigned f = 4; f > 1; f /= 2) {
+    if (sw >= f * w || sh >= f * h) return f;
+  }
+  return 1;
+}
+
+const struct vidframe *video_preview_tap(struct video_preview *p,
+                                         const struct vidframe *src,
+                                         unsigned w, unsigned h, bool swap) {
+  unsigned f = video_preview_factor(&src->size, w, h, swap);
+
+  p->factor = 1;
+  if (f == 1 || !format_supported(src->fmt)) return src;
+
+  unsigned dw = (src->size.w / f) & ~1u;
+  unsigned dh = (src->size.h / f) & ~1u;
+  unsigned cw = dw / 2;
+  unsigned ch = dh / 2;
+  if (!cw || !ch) return src;
+
+  size_t size = (size_t)dw * dh + 2 * (size_t)cw * ch;
+  if (size > p->size) {
+    uint8_t *buf = realloc(p->buf, size);
+    if (!buf) return src;
+    p->buf = buf;
+    p->size = size;
+  }
+  // Two rows of column sums; a source row is never longer than its stride
+  size_t acc_len = 2 * (size_t)MAX(src->linesize[0], src->linesize[1]);
+  if (acc_len > p->acc_len) {
+    uint16_t *acc = realloc(p->acc, acc_len * sizeof(*acc));
+    if (!acc) return src;
+    p->acc = acc;
+    p->acc_len = acc_len;
+  }
+
+  struct vidframe *vf = &p->frame;
+  memset(vf, 0, sizeof(*vf));
+  vf->fmt = VID_FMT_YUV420P;
+  vf->size.w = dw;
+  vf->size.h = dh;
+  vf->data[0] = p->buf;
+  vf->data[1] = p->buf + (size_t)dw * dh;
+  vf->data[2] = vf->data[1] + (size_t)cw * ch;
+  vf->linesize[0] = (uint16_t)dw;
+  vf->linesize[1] = (uint16_t)cw;
+  vf->linesize[2] = (uint16_t)cw;
+
+  switch (src->fmt) {
+  case VID_FMT_YUYV422:
+    box_packed(vf, src, f, 0, 1, 3, p->acc);
+    break;
+  case VID_FMT_UYVY422:
+    box_packed(vf, src, f, 1, 0, 2, p->acc);
+    break;
+  case VID_FMT_NV12:
+  case VID_FMT_NV21:
+    box_plane(vf->data[0], dw, dh, src->data[0], src->linesize[0], f, f,
+              p->acc);
+    box_uv(vf->data[1], vf->data[2], cw, ch, src->data[1], src->linesize[1],
+           f, src->fmt == VID_FMT_NV21, p->acc);
+    break;
+  default: {
+    // Planar: chroma blocks follow the source subsampling
+    unsigned cbw = src->fmt == VID_FMT_YUV444P ? 2 * f : f;
+    unsigned cbh = src->fmt == VID_FMT_YUV420P ? f : 2 * f;
+
+    box_plane(vf->data[0], dw, dh, src->data[0], src->linesize[0], f, f,
+              p->acc);
+    for (int i = 1; i <= 2; i++) {
+      box_plane(vf->data[i], cw, ch, src->data[i], src->linesize[i], cbw, cbh,
+                p->acc);
+    }
+    break;
+  }
+  }
+
+  p->factor = f;
+  p->frames++;
+  return vf;
+}
+
+void video_preview_close(struct video_preview *p) {
+  free(p->buf);
+  free(p->acc);
+  memset(p, 0, sizeof(*p));
+}
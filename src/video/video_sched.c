@@ -0,0 +1,70 @@
+#include "video_sched.h"
+#include <string.h>
+
+// The transit offset is re-measured over windows of this length, so it
+// follows clock drift and lasting route changes upwards
+#define SCHED_WINDOW_USEC 2000000
+// A timestamp jump larger than this starts a new mapping
+#define SCHED_TS_JUMP_USEC 3000000
+// A frame is late once it is past due by this many times the jitter, and
+// at least a frame interval
+#define SCHED_LATE_JITTERS 4
+// Late frames are still shown if nothing was queued for this long
+#define SCHED_MAX_FREEZE_USEC 200000
+// Frame interval assumed until one is measured (30 fps)
+#define SCHED_DEFAULT_INTERVAL 33333
+
+void video_sched_init(struct video_sched *s) {
+  memset(s, 0, sizeof(*s));
+  s->interval = SCHED_DEFAULT_INTERVAL;
+}
+
+uint64_t video_sched_due(struct video_sched *s, uint64_t now, uint64_t ts,
+                         uint64_t delay, unsigned depth) {
+  int64_t transit = (int64_t)(now - ts);
+  int64_t step = (int64_t)(ts - s->last_ts);
+
+  if (!s->valid || step < -SCHED_TS_JUMP_USEC || step > SCHED_TS_JUMP_USEC) {
+    s->valid = true;
+    s->offset = transit;
+    s->window_min = transit;
+    s->window_start = now;
+  } else {
+    if (step > 0 && step < 1000000) {
+      s->interval += (int32_t)(step - (int64_t)s->interval) / 8;
+    }
+    int64_t d = transit - s->last_transit;
+    if (d < 0) d = -d;
+    if (d < SCHED_TS_JUMP_USEC)
+      s->jitter += (int32_t)(d - (int64_t)s->jitter) / 16;
+    // A faster path takes effect at once; a slower one after a window
+    if (transit < s->offset) s->offset = transit;
+    if (transit < s->window_min) s->window_min = transit;
+    if (now - s->window_start >= SCHED_WINDOW_USEC) {
+      s->offset = s->window_min;
+      s->window_min = transit;
+      s->window_start = now;
+    }
+  }
+  s->last_ts = ts;
+  s->last_transit = transit;
+
+  // Waiting longer than the queue covers would only make it overflow
+  uint64_t max_delay = (uint64_t)s->interval * depth;
+  if (delay > max_delay) delay = max_delay;
+
+  return (uint64_t)((int64_t)ts + s->offset) + delay;
+}
+
+bool video_sched_late(const struct video_sched *s, uint64_t now,
+                      uint64_t due) {
+  uint64_t margin = (uint64_t)s->jitter * SCHED_LATE_JITTERS;
+
+  if (margin < s->interval) margin = s->interval;
+  if (now <= due + margin) return false;
+  return s->last_shown && now - s->last_shown < SCHED_MAX_FREEZE_USEC;
+}
+
+void video_sched_queued(struct video_sched *s, uint64_t now) {
+  s->last_shown = now;
+}
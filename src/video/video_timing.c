@@ -0,0 +1,137 @@
+#include "video_timing.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Bin b covers [lo(b), lo(b + 1)); 0..3 are 0..3 us, then four per octave
+static unsigned hist_bin(uint64_t usec) {
+  if (usec < 4) return (unsigned)usec;
+
+  unsigned msb = 63 - (unsigned)__builtin_clzll(usec);
+  unsigned sub = (unsigned)(usec >> (msb - 2)) & 3;
+  unsigned b = (msb - 1) * 4 + sub;
+  return b < VIDEO_HIST_BINS ? b : VIDEO_HIST_BINS - 1;
+}
+
+// Middle of bin b, the value reported for samples in it
+static uint32_t bin_mid(unsigned b) {
+  if (b < 4) return b;
+
+  unsigned shift = b / 4 - 1; // Bin width is 1 << shift
+  uint64_t lo = ((uint64_t)(4 + b % 4)) << shift;
+  uint64_t mid = lo + ((1ull << shift) >> 1);
+  return mid > UINT32_MAX ? UINT32_MAX : (uint32_t)mid;
+}
+
+void video_hist_add(struct video_hist *h, uint64_t usec) {
+  h->bins[hist_bin(usec)]++;
+  h->count++;
+  h->sum += usec;
+  if (usec > h->max) h->max = usec > UINT32_MAX ? UINT32_MAX : (uint32_t)usec;
+}
+
+static uint32_t hist_percentile(const struct video_hist *h, uint64_t total,
+                                unsigned pct) {
+  uint64_t want = (total * pct + 99) / 100;
+  uint64_t seen = 0;
+
+  if (!want) want = 1;
+  for (unsigned b = 0; b < VIDEO_HIST_BINS; b++) {
+    seen += h->bins[b];
+    if (seen >= want) {
+      uint32_t up = bin_mid(b);
+      return up < h->max ? up : h->max;
+    }
+  }
+  return h->max;
+}
+
+void video_hist_summarize(const struct video_hist *h,
+                          struct video_hist_summary *out) {
+  uint64_t total = 0;
+
+  memset(out, 0, sizeof(*out));
+  // The bins are the truth; count may be ahead of them mid-update
+  for (unsigned b = 0; b < VIDEO_HIST_BINS; b++) total += h->bins[b];
+  if (!total) return;
+
+  out->count = total;
+  out->mean = (uint32_t)(h->sum / (h->count ? h->count : 1));
+  out->p50 = hist_percentile(h, total, 50);
+  out->p95 = hist_percentile(h, total, 95);
+  out->p99 = hist_percentile(h, total, 99);
+  out->max = h->max;
+}
+
+const char *video_hist_fmt_ms(char *buf, size_t size, uint32_t usec) {
+  snprintf(buf, size, "%u.%u", usec / 1000, (usec % 1000) / 100);
+  return buf;
+}
+
+void video_rate_tick(struct video_rate *r, uint64_t now_usec) {
+  if (!r->start_usec) {
+    r->start_usec = now_usec;
+    r->count = 0;
+    return;
+  }
+
+  r->count++;
+  uint64_t elapsed = now_usec - r->start_usec;
+  if (elapsed >= 1000000) {
+    r->fps = (float)r->count * 1e6f / (float)elapsed;
+    r->start_usec = now_usec;
+    r->count = 0;
+  }
+}
+
+void video_timing_init(struct video_timing *t) { memset(t, 0, sizeof(*t)); }
+
+void video_timing_frame(struct video_timing *t, uint64_t now_usec,
+                        uint64_t ts_usec) {
+  if (t->last_arrival) {
+    uint64_t arrival_d = now_usec - t->last_arrival;
+    int64_t ts_d = (int64_t)(ts_usec - t->last_ts);
+    int64_t d = (int64_t)arrival_d - ts_d;
+    uint64_t abs_d = d < 0 ? (uint64_t)-d : (uint64_t)d;
+
+    video_hist_add(&t->interval, arrival_d);
+    // A timestamp jump (new stream, wrap) is not jitter
+    if (ts_d > 0 && ts_d < 5000000) {
+      video_hist_add(&t->jitter, abs_d);
+      t->jitter_avg += (int32_t)((int64_t)abs_d - t->jitter_avg) / 16;
+    }
+  }
+
+  t->last_arrival = now_usec;
+  t->last_ts = ts_usec;
+  video_rate_tick(&t->decoded, now_usec);
+}
+
+void video_timing_converted(struct video_timing *t, uint64_t usec) {
+  video_hist_add(&t->convert, usec);
+}
+
+void video_timing_presented(struct video_timing *t, uint64_t now_usec,
+                            uint64_t arrival_usec) {
+  if (arrival_usec && now_usec >= arrival_usec)
+    video_hist_add(&t->delay, now_usec - arrival_usec);
+  video_rate_tick(&t->presented, now_usec);
+}
+
+void video_timing_report(const struct video_timing *t,
+                         struct video_timing_report *r) {
+  memset(r, 0, sizeof(*r));
+  video_hist_summarize(&t->convert, &r->convert);
+  video_hist_summarize(&t->delay, &r->delay);
+  video_hist_summarize(&t->interval, &r->interval);
+  video_hist_summarize(&t->jitter, &r->jitter);
+  r->jitter_avg = t->jitter_avg;
+  r->fps_decoded = t->decoded.fps;
+  r->fps_presented = t->presented.fps;
+}
+
+uint64_t video_timing_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
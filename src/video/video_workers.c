@@ -0,0 +1,157 @@
+#include "video_workers.h"
+#include "logger.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+static struct {
+  pthread_t threads[VIDEO_WORKERS_MAX];
+  int count; // Worker threads (caller not included)
+  bool running;
+  bool quit;
+
+  pthread_mutex_t lock;
+  pthread_cond_t work_cond;
+  pthread_cond_t done_cond;
+  // Serialises callers; a second stream converts inline instead of waiting
+  pthread_mutex_t run_lock;
+
+  // Current job (protected by lock)
+  video_stripe_fn fn;
+  void *arg;
+  unsigned rows;
+  unsigned stripes;
+  unsigned next;
+  unsigned done;
+
+  unsigned min_pixels;
+} g_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work_cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+    .run_lock = PTHREAD_MUTEX_INITIALIZER,
+    .min_pixels = VIDEO_WORKERS_DEFAULT_MIN_PIXELS,
+};
+
+// Stripe i of n, kept on even rows so each stripe owns whole chroma rows
+static void stripe_bounds(unsigned i, unsigned n, unsigned rows, unsigned *y0,
+                          unsigned *y1) {
+  unsigned pairs = (rows + 1) / 2;
+  *y0 = (unsigned)(((unsigned long)pairs * i / n) * 2);
+  *y1 = (unsigned)(((unsigned long)pairs * (i + 1) / n) * 2);
+  if (*y1 > rows) *y1 = rows;
+}
+
+// Claim and run stripes until the job is exhausted. Called with lock held.
+static void run_stripes_locked(void) {
+  while (g_pool.next < g_pool.stripes) {
+    unsigned i = g_pool.next++;
+    video_stripe_fn fn = g_pool.fn;
+    void *arg = g_pool.arg;
+    unsigned y0, y1;
+
+    stripe_bounds(i, g_pool.stripes, g_pool.rows, &y0, &y1);
+
+    pthread_mutex_unlock(&g_pool.lock);
+    if (y1 > y0) fn(arg, y0, y1);
+    pthread_mutex_lock(&g_pool.lock);
+
+    if (++g_pool.done == g_pool.stripes) {
+      pthread_cond_signal(&g_pool.done_cond);
+    }
+  }
+}
+
+static void *worker_main(void *arg) {
+  (void)arg;
+
+  pthread_mutex_lock(&g_pool.lock);
+  while (!g_pool.quit) {
+    if (g_pool.next < g_pool.stripes) {
+      run_stripes_locked();
+      continue;
+    }
+    pthread_cond_wait(&g_pool.work_cond, &g_pool.lock);
+  }
+  pthread_mutex_unlock(&g_pool.lock);
+
+  return NULL;
+}
+
+int video_workers_init(int threads) {
+  if (g_pool.running) return 0;
+
+  if (threads <= 0) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = ncpu > 0 ? (int)ncpu : 1;
+  }
+  if (threads > VIDEO_WORKERS_MAX) threads = VIDEO_WORKERS_MAX;
+
+  g_pool.quit = false;
+  g_pool.count = 0;
+
+  // The caller always converts one stripe itself
+  for (int i = 0; i < threads - 1; i++) {
+    int err = pthread_create(&g_pool.threads[i], NULL, worker_main, NULL);
+    if (err) {
+      log_warn("VideoWorkers", "Failed to start worker %d: %d", i, err);
+      break;
+    }
+    g_pool.count++;
+  }
+  g_pool.running = true;
+
+  log_info("VideoWorkers", "Video conversion threads: %d (min %u px)",
+           g_pool.count + 1, g_pool.min_pixels);
+  return (g_pool.count + 1 < threads) ? EAGAIN : 0;
+}
+
+void video_workers_close(void) {
+  if (!g_pool.running) return;
+
+  pthread_mutex_lock(&g_pool.lock);
+  g_pool.quit = true;
+  pthread_cond_broadcast(&g_pool.work_cond);
+  pthread_mutex_unlock(&g_pool.lock);
+
+  for (int i = 0; i < g_pool.count; i++) {
+    pthread_join(g_pool.threads[i], NULL);
+  }
+  g_pool.count = 0;
+  g_pool.running = false;
+}
+
+void video_workers_set_min_pixels(unsigned pixels) {
+  g_pool.min_pixels = pixels;
+}
+
+int video_workers_get_threads(void) { return g_pool.count + 1; }
+
+void video_workers_run(video_stripe_fn fn, void *arg, unsigned rows,
+                       unsigned pixels) {
+  if (!fn || rows == 0) return;
+
+  if (g_pool.count == 0 || pixels < g_pool.min_pixels || rows < 4 ||
+      pthread_mutex_trylock(&g_pool.run_lock) != 0) {
+    fn(arg, 0, rows);
+    return;
+  }
+
+  pthread_mutex_lock(&g_pool.lock);
+  g_pool.fn = fn;
+  g_pool.arg = arg;
+  g_pool.rows = rows;
+  g_pool.stripes = (unsigned)g_pool.count + 1;
+  g_pool.next = 0;
+  g_pool.done = 0;
+  pthread_cond_broadcast(&g_pool.work_cond);
+
+  run_stripes_locked();
+  while (g_pool.done < g_pool.stripes) {
+    pthread_cond_wait(&g_pool.done_cond, &g_pool.lock);
+  }
+  pthread_mutex_unlock(&g_pool.lock);
+
+  pthread_mutex_unlock(&g_pool.run_lock);
+}
@@ -0,0 +1,247 @@
+#include "video_convert.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Widths around the SIMD bodies: 32-pixel (AVX2), 16-pixel (SSE2, NEON)
+// and the scalar tail. 61 and 125 run all three in one row.
+static const unsigned k_widths[] = {1, 2, 15, 16, 17, 31, 32, 33, 61, 125, 640};
+#define H 6
+
+// Ordered dither rows as applied to 16-bit output (row y uses y & 3)
+static const uint8_t k_bayer4[4][4] = {
+    {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+static int failures;
+
+static void check(bool ok, const char *what) {
+  if (!ok) {
+    fprintf(stderr, "FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// Random samples, plus the extremes that drive clamping in every channel
+static void fill(uint8_t *buf, size_t size, uint32_t *seed, unsigned lo,
+                 unsigned hi) {
+  for (size_t i = 0; i < size; i++) {
+    *seed = *seed * 1664525u + 1013904223u;
+    buf[i] = (i % lo == 0) ? 0 : (i % hi == 0) ? 255 : (uint8_t)(*seed >> 24);
+  }
+}
+
+// The reference ARGB8888 pixel as 16-bit output
+static uint16_t to_565(uint32_t argb, unsigned d, bool swap) {
+  unsigned r = ((argb >> 16) & 0xFF) + (d >> 1);
+  unsigned g = ((argb >> 8) & 0xFF) + (d >> 2);
+  unsigned b = (argb & 0xFF) + (d >> 1);
+  if (r > 255) r = 255;
+  if (g > 255) g = 255;
+  if (b > 255) b = 255;
+
+  uint16_t px = (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+  return swap ? (uint16_t)((px << 8) | (px >> 8)) : px;
+}
+
+static void test_kernel(video_kernel_t kernel, unsigned w) {
+  unsigned cw = (w + 1) / 2, ch = (H + 1) / 2;
+  uint8_t *y = malloc((size_t)w * H);
+  uint8_t *u = malloc((size_t)cw * ch);
+  uint8_t *v = malloc((size_t)cw * ch);
+  uint32_t *ref = malloc((size_t)w * H * 4);
+  uint32_t *out = malloc((size_t)w * H * 4);
+  uint16_t *out565 = malloc((size_t)w * H * 2);
+  uint32_t seed = 0x12345678 + w;
+  struct vidframe vf;
+  char what[96];
+
+  if (!y || !u || !v || !ref || !out || !out565) {
+    check(false, "out of memory");
+    goto out;
+  }
+
+  fill(y, (size_t)w * H, &seed, 11, 13);
+  fill(u, (size_t)cw * ch, &seed, 7, 5);
+  fill(v, (size_t)cw * ch, &seed, 4, 3);
+
+  memset(&vf, 0, sizeof(vf));
+  vf.fmt = VID_FMT_YUV420P;
+  vf.size.w = w;
+  vf.size.h = H;
+  vf.data[0] = y;
+  vf.data[1] = u;
+  vf.data[2] = v;
+  vf.linesize[0] = w;
+  vf.linesize[1] = cw;
+  vf.linesize[2] = cw;
+
+  video_convert_yuv420p_to_argb8888_ref((uint8_t *)ref, &vf);
+
+  video_convert_set_kernel(kernel);
+
+  memset(out, 0, (size_t)w * H * 4);
+  check(video_convert_yuv420p(out, (size_t)w * 4, VIDEO_PIX_ARGB8888, &vf) ==
+            0,
+        "ARGB8888 conversion");
+  snprintf(what, sizeof(what), "%s ARGB8888 width %u",
+           video_convert_kernel_name(kernel), w);
+  check(memcmp(ref, out, (size_t)w * H * 4) == 0, what);
+
+  for (int dither = 0; dither < 2; dither++) {
+    video_convert_set_dither(dither);
+
+    for (int swap = 0; swap < 2; swap++) {
+      video_pix_t pix = swap ? VIDEO_PIX_RGB565_SWAP : VIDEO_PIX_RGB565;
+      bool same = true;
+
+      memset(out565, 0, (size_t)w * H * 2);
+      check(video_convert_yuv420p(out565, (size_t)w * 2, pix, &vf) == 0,
+            "RGB565 conversion");
+      for (unsigned r = 0; r < H; r++) {
+        for (unsigned x = 0; x < w; x++) {
+          unsigned d = dither ? k_bayer4[r & 3][x & 3] : 0;
+          if (out565[r * w + x] != to_565(ref[r * w + x], d, swap))
+            same = false;
+        }
+      }
+
+      snprintf(what, sizeof(what), "%s %s%s width %u",
+               video_convert_kernel_name(kernel), video_pix_name(pix),
+               dither ? " dithered" : "", w);
+      check(same, what);
+    }
+  }
+
+out:
+  free(y);
+  free(u);
+  free(v);
+  free(ref);
+  free(out);
+  free(out565);
+}
+
+// YUV444P with each chroma sample repeated over its 2x2 block must give
+// the 4:2:0 reference; random 4:4:4 chroma must match the scalar kernel
+static void test_yuv444(video_kernel_t kernel, unsigned w) {
+  unsigned cw = (w + 1) / 2, ch = (H + 1) / 2;
+  size_t n = (size_t)w * H;
+  uint8_t *y = malloc(n), *u = malloc(n), *v = malloc(n);
+  uint8_t *u420 = malloc((size_t)cw * ch), *v420 = malloc((size_t)cw * ch);
+  uint32_t *ref = malloc(n * 4), *out = malloc(n * 4);
+  uint16_t *out565 = malloc(n * 2);
+  uint32_t seed = 0x9E3779B9u + w;
+  struct vidframe vf;
+  char what[96];
+  bool same = true;
+
+  if (!y || !u || !v || !u420 || !v420 || !ref || !out || !out565) {
+    check(false, "out of memory");
+    goto out;
+  }
+
+  fill(y, n, &seed, 11, 13);
+  fill(u420, (size_t)cw * ch, &seed, 7, 5);
+  fill(v420, (size_t)cw * ch, &seed, 4, 3);
+
+  memset(&vf, 0, sizeof(vf));
+  vf.fmt = VID_FMT_YUV420P;
+  vf.size.w = w;
+  vf.size.h = H;
+  vf.data[0] = y;
+  vf.data[1] = u420;
+  vf.data[2] = v420;
+  vf.linesize[0] = w;
+  vf.linesize[1] = cw;
+  vf.linesize[2] = cw;
+  video_convert_yuv420p_to_argb8888_ref((uint8_t *)ref, &vf);
+
+  for (unsigned r = 0; r < H; r++) {
+    for (unsigned x = 0; x < w; x++) {
+      u[r * w + x] = u420[(r / 2) * cw + x / 2];
+      v[r * w + x] = v420[(r / 2) * cw + x / 2];
+    }
+  }
+  vf.fmt = VID_FMT_YUV444P;
+  vf.data[1] = u;
+  vf.data[2] = v;
+  vf.linesize[1] = w;
+  vf.linesize[2] = w;
+
+  video_convert_set_kernel(kernel);
+  video_convert_set_dither(false);
+
+  check(video_convert_frame(out, (size_t)w * 4, VIDEO_PIX_ARGB8888,
+                            VIDEO_CSC_BT601_LIMITED, &vf) == 0,
+        "YUV444P conversion");
+  snprintf(what, sizeof(what), "%s YUV444P ARGB8888 width %u",
+           video_convert_kernel_name(kernel), w);
+  check(memcmp(ref, out, n * 4) == 0, what);
+
+  check(video_convert_frame(out565, (size_t)w * 2, VIDEO_PIX_RGB565,
+                            VIDEO_CSC_BT601_LIMITED, &vf) == 0,
+        "YUV444P conversion");
+  for (size_t i = 0; i < n; i++) {
+    if (out565[i] != to_565(ref[i], 0, false)) same = false;
+  }
+  snprintf(what, sizeof(what), "%s YUV444P RGB565 width %u",
+           video_convert_kernel_name(kernel), w);
+  check(same, what);
+
+  // Full-resolution chroma, against the scalar rows
+  fill(u, n, &seed, 7, 5);
+  fill(v, n, &seed, 4, 3);
+  video_convert_set_kernel(VIDEO_KERNEL_SCALAR);
+  video_convert_frame(ref, (size_t)w * 4, VIDEO_PIX_ARGB8888,
+                      VIDEO_CSC_BT709_FULL, &vf);
+  video_convert_set_kernel(kernel);
+  video_convert_frame(out, (size_t)w * 4, VIDEO_PIX_ARGB8888,
+                      VIDEO_CSC_BT709_FULL, &vf);
+  snprintf(what, sizeof(what), "%s YUV444P full chroma width %u",
+           video_convert_kernel_name(kernel), w);
+  check(memcmp(ref, out, n * 4) == 0, what);
+
+  // Neighbouring pixels keep their own chroma
+  if (w >= 2) {
+    memset(y, 128, n);
+    memset(v, 128, n);
+    for (size_t i = 0; i < n; i++) u[i] = (i & 1) ? 255 : 0;
+    video_convert_frame(out, (size_t)w * 4, VIDEO_PIX_ARGB8888,
+                        VIDEO_CSC_BT601_LIMITED, &vf);
+    snprintf(what, sizeof(what), "%s YUV444P chroma not averaged width %u",
+             video_convert_kernel_name(kernel), w);
+    check(out[0] != out[1], what);
+  }
+
+out:
+  free(y);
+  free(u);
+  free(v);
+  free(u420);
+  free(v420);
+  free(ref);
+  free(out);
+  free(out565);
+}
+
+int main(void) {
+  unsigned tested = 0;
+
+  for (int k = 0; k < VIDEO_KERNEL_COUNT; k++) {
+    char what[64];
+
+    if (!video_convert_kernel_supported(k)) continue;
+
+    for (size_t i = 0; i < sizeof(k_widths) / sizeof(k_widths[0]); i++) {
+      test_kernel(k, k_widths[i]);
+      test_yuv444(k, k_widths[i]);
+    }
+    snprintf(what, sizeof(what), "%s self-test", video_convert_kernel_name(k));
+    check(video_convert_selftest(k) == 0, what);
+    tested++;
+  }
+
+  if (failures) return 1;
+  printf("video_convert: %u kernels ok\n", tested);
+  return 0;
+}
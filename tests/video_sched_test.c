@@ -0,0 +1,92 @@
+#include "video_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FRAME_USEC 33333
+#define BASE_TRANSIT 50000
+#define DEPTH 3
+
+static int failures;
+
+static void check(bool ok, const char *what) {
+  if (!ok) {
+    fprintf(stderr, "FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// Frames at 30 fps arriving after BASE_TRANSIT plus up to `jitter` usec;
+// returns how many were dropped as late
+static unsigned feed(struct video_sched *s, unsigned frames, unsigned jitter,
+                     uint64_t delay, uint64_t *ts) {
+  unsigned late = 0;
+
+  for (unsigned i = 0; i < frames; i++) {
+    uint64_t now = *ts + BASE_TRANSIT + (jitter ? rand() % jitter : 0);
+    uint64_t due = video_sched_due(s, now, *ts, delay, DEPTH);
+
+    if (video_sched_late(s, now, due))
+      late++;
+    else
+      video_sched_queued(s, now);
+    *ts += FRAME_USEC;
+  }
+  return late;
+}
+
+// Network jitter with no audio delay to hide it in is not lateness
+static void test_jitter_absorbed(void) {
+  static const unsigned jitters[] = {5000, 20000, 40000, 80000};
+
+  for (size_t j = 0; j < sizeof(jitters) / sizeof(jitters[0]); j++) {
+    struct video_sched s;
+    uint64_t ts = 1000000;
+
+    srand(1);
+    video_sched_init(&s);
+    feed(&s, 60, jitters[j], 0, &ts); // Estimate settles
+    unsigned late = feed(&s, 600, jitters[j], 0, &ts);
+
+    char what[64];
+    snprintf(what, sizeof(what), "%u usec jitter: %u of 600 late",
+             jitters[j], late);
+    check(late <= 6, what);
+  }
+}
+
+// A frame far behind a steady stream is still dropped
+static void test_late_dropped(void) {
+  struct video_sched s;
+  uint64_t ts = 1000000;
+
+  video_sched_init(&s);
+  feed(&s, 60, 0, 0, &ts);
+
+  uint64_t now = ts + BASE_TRANSIT + 150000;
+  uint64_t due = video_sched_due(&s, now, ts, 0, DEPTH);
+  check(video_sched_late(&s, now, due), "150 ms late frame dropped");
+}
+
+// Dropping never freezes the picture for long
+static void test_freeze_guard(void) {
+  struct video_sched s;
+  uint64_t ts = 1000000;
+
+  video_sched_init(&s);
+  feed(&s, 60, 0, 0, &ts);
+
+  uint64_t shown = ts + BASE_TRANSIT - FRAME_USEC;
+  uint64_t now = shown + 250000;
+  uint64_t due = video_sched_due(&s, now, ts, 0, DEPTH);
+  check(!video_sched_late(&s, now, due), "shown after 250 ms without frames");
+}
+
+int main(void) {
+  test_jitter_absorbed();
+  test_late_dropped();
+  test_freeze_guard();
+
+  if (failures) return 1;
+  printf("video_sched: ok\n");
+  return 0;
+}